@@ -0,0 +1,93 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/core/Order.h"
+
+// Synthetic order flow for macro benchmarks. Arrivals follow a Poisson
+// process, limit prices sit a power-law distributed number of ticks from
+// mid, and a configurable fraction of events cancel a live resting order.
+// Everything is driven from a single seeded engine so runs are reproducible.
+class OrderFlowGenerator {
+public:
+    struct Config {
+        std::string symbol = "BTC-USDT";
+        uint64_t seed = 42;
+        double arrival_rate = 100000.0; // events per second of simulated time
+        double mid_price = 50000.0;
+        double tick_size = 0.5;
+        double power_law_alpha = 1.5;   // tail exponent of distance from mid
+        int max_ticks = 500;
+        double cancel_ratio = 0.3;      // fraction of events that are cancels
+        double market_ratio = 0.05;     // fraction of new orders that are market
+        double ioc_ratio = 0.05;        // fraction of new orders that are IOC
+        double min_quantity = 0.01;
+        double max_quantity = 2.0;
+    };
+
+    struct Event {
+        enum class Kind { NEW, CANCEL };
+        Kind kind;
+        double time;        // seconds since start of the simulated session
+        Order order;        // NEW: order to submit, CANCEL: order to remove
+    };
+
+    explicit OrderFlowGenerator(const Config& config)
+        : config_(config), rng_(config.seed),
+          arrival_(config.arrival_rate), uniform_(0.0, 1.0),
+          quantity_(config.min_quantity, config.max_quantity) {}
+
+    Event next() {
+        time_ += arrival_(rng_);
+        if (!live_.empty() && uniform_(rng_) < config_.cancel_ratio) {
+            std::size_t idx = static_cast<std::size_t>(uniform_(rng_) * live_.size()) % live_.size();
+            Order victim = live_[idx];
+            live_[idx] = live_.back();
+            live_.pop_back();
+            return {Event::Kind::CANCEL, time_, victim};
+        }
+
+        Order::Side side = uniform_(rng_) < 0.5 ? Order::Side::BUY : Order::Side::SELL;
+        double roll = uniform_(rng_);
+        Order::Type type = Order::Type::LIMIT;
+        if (roll < config_.market_ratio) {
+            type = Order::Type::MARKET;
+        } else if (roll < config_.market_ratio + config_.ioc_ratio) {
+            type = Order::Type::IOC;
+        }
+
+        // Pareto-distributed distance from mid; a small share of orders cross
+        double ticks = std::min<double>(config_.max_ticks,
+            std::floor(std::pow(1.0 - uniform_(rng_), -1.0 / config_.power_law_alpha)) - 1.0);
+        bool aggressive = uniform_(rng_) < 0.1;
+        double offset = (aggressive ? -ticks : ticks) * config_.tick_size;
+        double price = side == Order::Side::BUY ? config_.mid_price - offset : config_.mid_price + offset;
+        if (type == Order::Type::MARKET) price = 0.0;
+
+        double qty = std::round(quantity_(rng_) * 100.0) / 100.0;
+        Order order(std::to_string(next_id_++), config_.symbol, type, side, qty, price, "");
+        if (type == Order::Type::LIMIT) {
+            live_.push_back(order);
+        }
+        return {Event::Kind::NEW, time_, order};
+    }
+
+    std::vector<Event> generate(std::size_t count) {
+        std::vector<Event> events;
+        events.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) events.push_back(next());
+        return events;
+    }
+
+private:
+    Config config_;
+    std::mt19937_64 rng_;
+    std::exponential_distribution<double> arrival_;
+    std::uniform_real_distribution<double> uniform_;
+    std::uniform_real_distribution<double> quantity_;
+    std::vector<Order> live_;
+    uint64_t next_id_ = 1;
+    double time_ = 0.0;
+};
@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+#include "../src/core/MatchingEngine.h"
+#include "../src/api/Replication.h"
+#include "OrderFlowGenerator.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::string kSymbol = "BTC-USDT";
+    const std::string kTimestamp = "2025-06-14T10:00:00.000000Z";
+
+    Order makeOrder(uint64_t id, Order::Type type, Order::Side side, double qty, double price) {
+        return Order(std::to_string(id), kSymbol, type, side, qty, price, kTimestamp);
+    }
+
+    // Background liquidity away from the touch so the matched level is never the only one
+    void seedBook(MatchingEngine& engine, int levels) {
+        uint64_t id = 1000000;
+        for (int l = 1; l <= levels; ++l) {
+            engine.processOrder(makeOrder(id++, Order::Type::LIMIT, Order::Side::BUY, 1.0, 49000.0 - l));
+            engine.processOrder(makeOrder(id++, Order::Type::LIMIT, Order::Side::SELL, 1.0, 51000.0 + l));
+        }
+    }
+
+    // Each iteration rests one maker and takes it with `type`, so the book
+    // returns to its seeded state and iterations are independent.
+    void runMakerTaker(benchmark::State& state, Order::Type type) {
+        MatchingEngine engine;
+        seedBook(engine, 50);
+        uint64_t id = 0;
+        for (auto _ : state) {
+            engine.processOrder(makeOrder(id++, Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0));
+            double price = type == Order::Type::MARKET ? 0.0 : 50000.0;
+            benchmark::DoNotOptimize(engine.processOrder(makeOrder(id++, type, Order::Side::BUY, 1.0, price)));
+        }
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+}
+
+static void BM_Match_LimitNoCross(benchmark::State& state) {
+    MatchingEngine engine;
+    seedBook(engine, 50);
+    uint64_t id = 0;
+    for (auto _ : state) {
+        // Rests inside the spread, then cancels, so every iteration starts
+        // from the seeded book
+        const uint64_t order_id = id++;
+        benchmark::DoNotOptimize(engine.processOrder(makeOrder(order_id, Order::Type::LIMIT, Order::Side::BUY, 1.0, 49500.0)));
+        engine.cancelOrder(kSymbol, std::to_string(order_id), Order::Side::BUY, 49500.0);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_Match_LimitNoCross);
+
+static void BM_Match_LimitCross(benchmark::State& state) { runMakerTaker(state, Order::Type::LIMIT); }
+BENCHMARK(BM_Match_LimitCross);
+
+// LimitCross with the journal streaming to a hot standby over loopback: the
+// difference is what replication adds to each order on the matching path
+static void BM_Match_LimitCrossReplicated(benchmark::State& state) {
+    auto engine = std::make_shared<MatchingEngine>();
+    ReplicationPrimary journal(engine, 0);
+    journal.start();
+    auto standby = std::make_shared<MatchingEngine>();
+    ReplicationBackup backup(standby, "127.0.0.1", journal.port());
+    backup.start();
+    seedBook(*engine, 50);
+    uint64_t id = 0;
+    for (auto _ : state) {
+        engine->processOrder(makeOrder(id++, Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0));
+        benchmark::DoNotOptimize(engine->processOrder(makeOrder(id++, Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0)));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    backup.stop();
+    journal.stop();
+}
+BENCHMARK(BM_Match_LimitCrossReplicated);
+
+static void BM_Match_Market(benchmark::State& state) { runMakerTaker(state, Order::Type::MARKET); }
+BENCHMARK(BM_Match_Market);
+
+static void BM_Match_IOC(benchmark::State& state) { runMakerTaker(state, Order::Type::IOC); }
+BENCHMARK(BM_Match_IOC);
+
+static void BM_Match_FOK(benchmark::State& state) { runMakerTaker(state, Order::Type::FOK); }
+BENCHMARK(BM_Match_FOK);
+
+// Args: levels swept, orders per level. The book is built, and the previous
+// one torn down, outside the timed region.
+static void BM_Match_DeepSweep(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    const int per_level = static_cast<int>(state.range(1));
+    uint64_t id = 0;
+    std::unique_ptr<MatchingEngine> engine;
+    for (auto _ : state) {
+        state.PauseTiming();
+        engine = std::make_unique<MatchingEngine>();
+        for (int l = 0; l < levels; ++l) {
+            for (int i = 0; i < per_level; ++i) {
+                engine->processOrder(makeOrder(id++, Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0 + l));
+            }
+        }
+        Order taker = makeOrder(id++, Order::Type::MARKET, Order::Side::BUY,
+                                static_cast<double>(levels * per_level), 0.0);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(engine->processOrder(taker));
+    }
+    state.SetItemsProcessed(state.iterations() * levels * per_level);
+}
+BENCHMARK(BM_Match_DeepSweep)->Args({10, 1})->Args({100, 1})->Args({100, 10});
+
+// Macro benchmark over synthetic flow. Arg: cancel ratio in percent. The
+// engine writes fills back into the orders it is given, so every iteration
+// replays a fresh copy of the flow; copies, setup and teardown are untimed.
+static void BM_SyntheticFlow(benchmark::State& state) {
+    OrderFlowGenerator::Config config;
+    config.cancel_ratio = static_cast<double>(state.range(0)) / 100.0;
+    const std::size_t kEvents = 20000;
+    auto events = OrderFlowGenerator(config).generate(kEvents);
+
+    uint64_t trades = 0;
+    std::unique_ptr<MatchingEngine> engine;
+    std::vector<OrderFlowGenerator::Event> run;
+    for (auto _ : state) {
+        state.PauseTiming();
+        engine = std::make_unique<MatchingEngine>();
+        run = events;
+        state.ResumeTiming();
+        for (const auto& ev : run) {
+            if (ev.kind == OrderFlowGenerator::Event::Kind::NEW) {
+                trades += engine->processOrder(ev.order).size();
+            } else {
+                auto it = engine->order_books_.find(ev.order.getSymbol());
+                if (it != engine->order_books_.end()) {
+                    it->second->removeOrder(ev.order.getOrderId(), ev.order.getSide(), ev.order.getPrice());
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kEvents);
+    state.counters["trades_per_run"] = static_cast<double>(trades) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_SyntheticFlow)->Arg(10)->Arg(30)->Arg(60)->Unit(benchmark::kMillisecond);
+
+// Pre-trade check and reservation alone; arg is the number of accounts in play
+static void BM_Risk_ReserveAndSettle(benchmark::State& state) {
+    RiskManager risk;
+    RiskLimits limits;
+    limits.max_order_quantity = 1000.0;
+    limits.max_order_notional = 1e9;
+    limits.max_open_orders = 1u << 30;
+    limits.max_position = 1e12;
+    limits.price_band = 0.5;
+    risk.setDefaultLimits(limits);
+    TopOfBook top;
+    top.bid_price = 49999.0;
+    top.ask_price = 50001.0;
+    top.last_price = 50000.0;
+
+    std::vector<Order> orders;
+    for (int64_t i = 0; i < 1024; ++i) {
+        Order o(std::to_string(i), "BTC-USDT", Order::Type::IOC, i % 2 ? Order::Side::SELL : Order::Side::BUY,
+                1.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+        o.setAccount("acct" + std::to_string(i % state.range(0)));
+        orders.push_back(o);
+    }
+    std::vector<Trade> no_trades;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const Order& o = orders[i++ & 1023];
+        benchmark::DoNotOptimize(risk.reserve(o, top));
+        risk.settle(o, no_trades);
+    }
+}
+BENCHMARK(BM_Risk_ReserveAndSettle)->Arg(1)->Arg(1000);
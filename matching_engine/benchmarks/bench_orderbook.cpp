@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+#include "../src/core/OrderBook.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::string kSymbol = "BTC-USDT";
+    const std::string kTimestamp = "2025-06-14T10:00:00.000000Z";
+
+    std::shared_ptr<Order> makeOrder(int id, Order::Side side, double price, double qty = 1.0) {
+        return std::make_shared<Order>(std::to_string(id), kSymbol, Order::Type::LIMIT, side, qty, price, kTimestamp);
+    }
+
+    // Populate `levels` price levels per side with `per_level` orders each
+    void fillBook(OrderBook& book, int levels, int per_level) {
+        int id = 0;
+        for (int l = 0; l < levels; ++l) {
+            for (int i = 0; i < per_level; ++i) {
+                book.addOrder(makeOrder(id++, Order::Side::BUY, 49999.0 - l));
+                book.addOrder(makeOrder(id++, Order::Side::SELL, 50001.0 + l));
+            }
+        }
+    }
+}
+
+// Arg: number of distinct price levels the new orders spread over. Every
+// order is added once: when the pool of 4096 runs out, the book and the pool
+// are rebuilt outside the timed region, so the book never exceeds 4096 orders.
+static void BM_OrderBook_AddOrder(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    std::vector<std::shared_ptr<Order>> orders;
+    std::unique_ptr<OrderBook> book;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        if ((i & 4095) == 0) {
+            state.PauseTiming();
+            book = std::make_unique<OrderBook>(kSymbol);
+            orders.clear();
+            for (int n = 0; n < 4096; ++n) {
+                orders.push_back(makeOrder(n, Order::Side::BUY, 49999.0 - (n % levels)));
+            }
+            state.ResumeTiming();
+        }
+        book->addOrder(orders[i++ & 4095]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBook_AddOrder)->Arg(1)->Arg(64)->Arg(1024);
+
+// Arg: orders queued at the level the cancel targets
+static void BM_OrderBook_RemoveOrder(benchmark::State& state) {
+    const int per_level = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        OrderBook book(kSymbol);
+        for (int i = 0; i < per_level; ++i) book.addOrder(makeOrder(i, Order::Side::BUY, 50000.0));
+        state.ResumeTiming();
+        // Cancel from the middle of the queue
+        book.removeOrder(std::to_string(per_level / 2), Order::Side::BUY, 50000.0);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBook_RemoveOrder)->Arg(1)->Arg(16)->Arg(256);
+
+static void BM_OrderBook_GetBBO(benchmark::State& state) {
+    OrderBook book(kSymbol);
+    fillBook(book, 100, 4);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.getBBO());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBook_GetBBO);
+
+// Args: requested depth, orders per level
+static void BM_OrderBook_GetMarketDepth(benchmark::State& state) {
+    OrderBook book(kSymbol);
+    fillBook(book, 100, static_cast<int>(state.range(1)));
+    const int levels = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.getMarketDepth(levels));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBook_GetMarketDepth)->Args({5, 1})->Args({20, 1})->Args({20, 16});
+
+// Indicative uncross during a call. Args: crossed levels per side, orders per level
+static void BM_OrderBook_AuctionEquilibrium(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0));
+    OrderBook book(kSymbol);
+    int id = 0;
+    for (int l = 0; l < levels; ++l) {
+        for (int i = 0; i < state.range(1); ++i) {
+            book.addOrder(makeOrder(id++, Order::Side::BUY, 50000.0 + l));
+            book.addOrder(makeOrder(id++, Order::Side::SELL, 49999.0 + levels - l));
+        }
+    }
+    std::lock_guard<std::mutex> lock(book.mtx_);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.equilibrium());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderBook_AuctionEquilibrium)->Args({10, 4})->Args({100, 4})->Args({1000, 1})->Args({100, 64});
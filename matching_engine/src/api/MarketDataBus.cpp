@@ -0,0 +1,208 @@
+#include "MarketDataBus.h"
+#include <algorithm>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include "../utils/Utils.h"
+
+namespace {
+    MarketDataMessage blank(MarketDataMessage::Type type, uint8_t side) {
+        MarketDataMessage m;
+        std::memset(static_cast<void*>(&m), 0, sizeof(m));
+        m.type = type;
+        m.side = side;
+        return m;
+    }
+}
+
+MarketDataBus::MarketDataBus(std::shared_ptr<MatchingEngine> engine, const std::string& name,
+                             std::size_t capacity, int depth_levels)
+    : engine_(std::move(engine)), name_(name), depth_levels_(depth_levels) {
+#if defined(_WIN32)
+    (void)capacity;
+    if (name_.empty()) return;
+    throw std::runtime_error("Shared-memory market data needs POSIX");
+#else
+    if (name_.empty()) return;
+    capacity = Utils::roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity);
+    size_ = MarketDataRing::mappedSize(capacity);
+    // Readers still mapping a previous ring keep it; new ones find this one
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot create market data ring " + name_);
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("Cannot size market data ring " + name_);
+    }
+    void* base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("Cannot map market data ring " + name_);
+    }
+    // ftruncate zero-fills: every slot starts at sequence 0, "not written"
+    header_ = static_cast<MarketDataRing::Header*>(base);
+    header_->capacity = capacity;
+    header_->published.store(0, std::memory_order_relaxed);
+    slots_ = MarketDataRing::slots(header_);
+    mask_ = capacity - 1;
+    // Readers validate the magic last, once the rest of the header is in place
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = MarketDataRing::kMagic;
+#endif
+}
+
+MarketDataBus::~MarketDataBus() {
+#if !defined(_WIN32)
+    if (header_) {
+        munmap(header_, size_);
+        shm_unlink(name_.c_str());
+    }
+#endif
+}
+
+void MarketDataBus::addSink(const Sink& sink) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    sinks_.push_back(sink);
+}
+
+void MarketDataBus::addEventSink(const EventSink& sink) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    event_sinks_.push_back(sink);
+}
+
+void MarketDataBus::enableL3() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        l3_ = true;
+    }
+    engine_->setBookEventsEnabled(true);
+}
+
+void MarketDataBus::onTrade(const Trade& trade) {
+    uint8_t aggressor = trade.aggressor_side == "buy" ? 0 : trade.aggressor_side == "sell" ? 1 : 2;
+    MarketDataMessage m = blank(MarketDataMessage::Type::TRADE, aggressor);
+    m.trade.price = trade.price;
+    m.trade.quantity = trade.quantity;
+    m.trade.sequence = trade.sequence;
+    int64_t micros = 0;
+    Utils::parseTimestamp(trade.timestamp, micros);
+    m.trade.timestamp_us = micros;
+    std::lock_guard<std::mutex> lock(mtx_);
+    write(m, trade.symbol);
+}
+
+void MarketDataBus::onBookUpdate(const std::string& symbol) {
+    auto book = engine_->getBook(symbol);
+    if (!book) return;
+    // Snapshot and publish under one lock so deltas follow the order of the views
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (l3_) {
+        book->takeEvents(events_);
+        publishEvents(symbol);
+    }
+    SymbolState& last = last_[symbol];
+    TopOfBook top = book->getTopOfBook();
+    if (top.sequence != last.top_sequence) {
+        last.top_sequence = top.sequence;
+        MarketDataMessage m = blank(MarketDataMessage::Type::BBO, 0);
+        m.top.bid_price = top.bid_price;
+        m.top.bid_size = top.bid_size;
+        m.top.ask_price = top.ask_price;
+        m.top.ask_size = top.ask_size;
+        write(m, symbol);
+    }
+    Depth bids = book->getDepth(Order::Side::BUY, depth_levels_);
+    Depth asks = book->getDepth(Order::Side::SELL, depth_levels_);
+    diff(symbol, 0, last.bids, bids, std::greater<double>());
+    diff(symbol, 1, last.asks, asks, std::less<double>());
+    last.bids.swap(bids);
+    last.asks.swap(asks);
+}
+
+uint64_t MarketDataBus::published() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return sequence_;
+}
+
+uint64_t MarketDataBus::l3Snapshot(const std::string& symbol, std::vector<L3Order>& out) {
+    auto book = engine_->getBook(symbol);
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!book) return sequence_;
+    // Events up to the snapshot go out first, so the ones after it carry later sequences
+    book->takeEvents(events_, &out);
+    publishEvents(symbol);
+    return sequence_;
+}
+
+std::string MarketDataBus::getL3SnapshotJSON(const std::string& symbol) {
+    std::vector<L3Order> orders;
+    uint64_t sequence = l3Snapshot(symbol, orders);
+    nlohmann::json bids = nlohmann::json::array();
+    nlohmann::json asks = nlohmann::json::array();
+    for (const auto& order : orders) {
+        auto& side = order.side == Order::Side::BUY ? bids : asks;
+        side.push_back({order.order_ref, order.priority, order.price, order.quantity});
+    }
+    return nlohmann::json{{"symbol", symbol}, {"sequence", sequence}, {"bids", bids}, {"asks", asks}}.dump();
+}
+
+void MarketDataBus::publishEvents(const std::string& symbol) {
+    static const MarketDataMessage::Type kTypes[] = {
+        MarketDataMessage::Type::ORDER_ADD, MarketDataMessage::Type::ORDER_MODIFY,
+        MarketDataMessage::Type::ORDER_EXECUTE, MarketDataMessage::Type::ORDER_DELETE};
+    for (const auto& event : events_) {
+        MarketDataMessage m = blank(kTypes[static_cast<std::size_t>(event.type)],
+                                    event.side == Order::Side::BUY ? 0 : 1);
+        m.order.order_ref = event.order_ref;
+        m.order.priority = event.priority;
+        m.order.price = event.price;
+        m.order.quantity = event.quantity;
+        write(m, symbol);
+        for (const auto& sink : event_sinks_) sink(symbol, event);
+    }
+    events_.clear();
+}
+
+template <typename Better>
+void MarketDataBus::diff(const std::string& symbol, uint8_t side, const Depth& before, const Depth& after,
+                         Better better) {
+    // Both views are sorted best first: merge them
+    auto emit = [&](double price, double quantity) {
+        MarketDataMessage m = blank(MarketDataMessage::Type::LEVEL, side);
+        m.level.price = price;
+        m.level.quantity = quantity;
+        write(m, symbol);
+    };
+    std::size_t i = 0, j = 0;
+    while (i < before.size() || j < after.size()) {
+        if (j == after.size() || (i < before.size() && better(before[i].first, after[j].first))) {
+            emit(before[i++].first, 0.0);
+        } else if (i == before.size() || better(after[j].first, before[i].first)) {
+            emit(after[j].first, after[j].second);
+            ++j;
+        } else {
+            if (before[i].second != after[j].second) emit(after[j].first, after[j].second);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void MarketDataBus::write(MarketDataMessage& message, const std::string& symbol) {
+    std::memcpy(message.symbol, symbol.data(), std::min(symbol.size(), sizeof(message.symbol)));
+    uint64_t s = ++sequence_;
+    if (header_) {
+        uint64_t words[MarketDataRing::kWords];
+        std::memcpy(words, &message, sizeof(words));
+        MarketDataRing::Slot& slot = slots_[s & mask_];
+        slot.sequence.store(2 * s - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < MarketDataRing::kWords; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(2 * s, std::memory_order_release);
+        header_->published.store(s, std::memory_order_release);
+    }
+    for (const auto& sink : sinks_) sink(s, message);
+}
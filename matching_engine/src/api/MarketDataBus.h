@@ -0,0 +1,82 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "MarketDataRing.h"
+#include "../core/MatchingEngine.h"
+
+// Writer side of the shared-memory market data ring. Fed from the engine's
+// trade and book update callbacks, like WebSocketServer, it publishes every
+// trade, the BBO when it moves, and level deltas for the top depth_levels of
+// each side. With L3 enabled, every change to a resting order goes out ahead
+// of them. Publishing is serialized here, so the ring has a single writer.
+class MarketDataBus {
+public:
+    // Receives each message with its bus sequence, under the bus lock, so
+    // sinks see the same order as ring readers
+    using Sink = std::function<void(uint64_t sequence, const MarketDataMessage& message)>;
+    // Receives the raw L3 events, client order ids included, in the same order
+    using EventSink = std::function<void(const std::string& symbol, const BookEvent& event)>;
+
+    // Creates the ring, replacing a stale one of the same name. capacity is
+    // rounded up to a power of two. Throws std::runtime_error on failure. An
+    // empty name creates no ring and feeds the sinks only.
+    MarketDataBus(std::shared_ptr<MatchingEngine> engine,
+                  const std::string& name = MarketDataRing::kDefaultName,
+                  std::size_t capacity = 1 << 16, int depth_levels = 20);
+    ~MarketDataBus(); // Unlinks the ring; mapped readers see no more messages
+
+    MarketDataBus(const MarketDataBus&) = delete;
+    MarketDataBus& operator=(const MarketDataBus&) = delete;
+
+    // Call before the engine takes orders
+    void addSink(const Sink& sink);
+    // Call before the engine takes orders; needs enableL3()
+    void addEventSink(const EventSink& sink);
+    // Turns on the engine's book events and publishes them as ORDER_ messages
+    void enableL3();
+    void onTrade(const Trade& trade);
+    void onBookUpdate(const std::string& symbol);
+    uint64_t published() const;
+    // Every resting order of a symbol, for late L3 joiners. Returns the bus
+    // sequence it is current as of: apply ORDER_ messages after it.
+    uint64_t l3Snapshot(const std::string& symbol, std::vector<L3Order>& out);
+    // JSON: {"symbol","sequence","bids":[[order_ref,priority,price,quantity],...],"asks":[...]}
+    std::string getL3SnapshotJSON(const std::string& symbol);
+
+private:
+    using Depth = std::vector<std::pair<double, double>>;
+    struct SymbolState {
+        uint64_t top_sequence = 0;
+        Depth bids;
+        Depth asks;
+    };
+
+    std::shared_ptr<MatchingEngine> engine_;
+    std::string name_;
+    int depth_levels_;
+    MarketDataRing::Header* header_ = nullptr;
+    MarketDataRing::Slot* slots_ = nullptr;
+    std::size_t size_ = 0;
+    uint64_t mask_ = 0;
+    std::vector<Sink> sinks_;
+    std::vector<EventSink> event_sinks_;
+
+    mutable std::mutex mtx_; // Serializes writers; guards everything below
+    uint64_t sequence_ = 0;
+    std::unordered_map<std::string, SymbolState> last_;
+    bool l3_ = false;
+    std::vector<BookEvent> events_; // Scratch for draining a book
+
+    void publishEvents(const std::string& symbol);
+
+    void write(MarketDataMessage& message, const std::string& symbol);
+    // Emits a LEVEL for every price whose quantity differs between the two
+    // views, best price first on each side
+    template <typename Better>
+    void diff(const std::string& symbol, uint8_t side, const Depth& before, const Depth& after, Better better);
+};
@@ -0,0 +1,189 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Shared-memory market data for consumers on the engine's host. One writer
+// (MarketDataBus) appends fixed-size messages to a POSIX shared-memory ring;
+// any number of reader processes poll it without locks or syscalls. This
+// header is the whole reader library: include it and link -lrt where needed.
+
+struct MarketDataMessage {
+    // HEARTBEAT only travels on the UDP feed, never through the ring. The
+    // ORDER_ types are the L3 channel; see BookEvent for their meaning.
+    enum class Type : uint8_t { TRADE, BBO, LEVEL, HEARTBEAT, ORDER_ADD, ORDER_MODIFY, ORDER_EXECUTE, ORDER_DELETE };
+
+    struct TradeBody {
+        double price;
+        double quantity;
+        uint64_t sequence;    // Position on the symbol's trade tape
+        int64_t timestamp_us;
+    };
+    struct TopBody {
+        double bid_price; // 0 when the side is empty
+        double bid_size;
+        double ask_price;
+        double ask_size;
+    };
+    // New visible quantity at a price among the top levels; 0 removes it
+    struct LevelBody {
+        double price;
+        double quantity;
+    };
+    struct OrderBody {
+        uint64_t order_ref;
+        uint64_t priority;
+        double price;
+        double quantity;
+    };
+
+    Type type;
+    uint8_t side;        // LEVEL, ORDER_: 0 bid, 1 ask. TRADE: aggressor 0 buy, 1 sell, 2 none (auction)
+    uint8_t reserved[6];
+    char symbol[16];     // Zero-padded; not terminated when all 16 bytes are used
+    union {
+        TradeBody trade;
+        TopBody top;
+        LevelBody level;
+        OrderBody order;
+    };
+
+    std::string getSymbol() const { return std::string(symbol, strnlen(symbol, sizeof(symbol))); }
+};
+static_assert(sizeof(MarketDataMessage) == 56, "one slot per cache line");
+static_assert(std::is_trivially_copyable<MarketDataMessage>::value, "copied through atomic words");
+
+// Layout of the mapping: header, then a power-of-two array of slots. Each
+// slot is a sequence lock over one message: 2s-1 while message s is being
+// written, 2s once it is complete. A reader that finds a later message in its
+// slot, or sees the slot change while copying, was lapped by the writer.
+struct MarketDataRing {
+    static constexpr uint64_t kMagic = 0x4d44425553303031; // "MDBUS001"
+    static constexpr const char* kDefaultName = "/matching_engine_md";
+    static constexpr std::size_t kWords = sizeof(MarketDataMessage) / sizeof(uint64_t);
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> words[kWords];
+    };
+
+    struct alignas(64) Header {
+        uint64_t magic;
+        uint64_t capacity;
+        alignas(64) std::atomic<uint64_t> published; // Last complete message, 0 if none
+    };
+
+    static_assert(sizeof(Slot) == 64, "slot is one cache line");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "atomics must be address-free");
+
+    static std::size_t mappedSize(std::size_t capacity) {
+        return sizeof(Header) + capacity * sizeof(Slot);
+    }
+    static Slot* slots(Header* header) {
+        return reinterpret_cast<Slot*>(header + 1);
+    }
+};
+
+class MarketDataReader {
+public:
+    // Maps an existing ring read-only and starts after its newest message.
+    // Throws std::runtime_error if the ring does not exist or is not one.
+    explicit MarketDataReader(const std::string& name = MarketDataRing::kDefaultName) {
+#if defined(_WIN32)
+        (void)name;
+        throw std::runtime_error("Shared-memory market data needs POSIX");
+#else
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) throw std::runtime_error("No market data ring named " + name);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(MarketDataRing::Header)) {
+            close(fd);
+            throw std::runtime_error("Market data ring " + name + " is not initialised");
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        void* base = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) throw std::runtime_error("Cannot map market data ring " + name);
+        header_ = static_cast<MarketDataRing::Header*>(base);
+        if (header_->magic != MarketDataRing::kMagic ||
+            MarketDataRing::mappedSize(header_->capacity) != size_) {
+            munmap(base, size_);
+            throw std::runtime_error("Market data ring " + name + " has an unknown layout");
+        }
+        slots_ = MarketDataRing::slots(header_);
+        mask_ = header_->capacity - 1;
+        seekToLatest();
+#endif
+    }
+
+    ~MarketDataReader() {
+#if !defined(_WIN32)
+        if (header_) munmap(header_, size_);
+#endif
+    }
+
+    MarketDataReader(const MarketDataReader&) = delete;
+    MarketDataReader& operator=(const MarketDataReader&) = delete;
+
+    // Copies out the next message; false once caught up with the writer. If
+    // the writer lapped this reader, the skipped messages are added to lost()
+    // and reading resumes at the oldest message still in the ring.
+    bool poll(MarketDataMessage& out) {
+        for (;;) {
+            const MarketDataRing::Slot& slot = slots_[next_ & mask_];
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before < 2 * next_) return false; // Not written yet
+            if (before == 2 * next_) {
+                uint64_t words[MarketDataRing::kWords];
+                for (std::size_t i = 0; i < MarketDataRing::kWords; ++i) {
+                    words[i] = slot.words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                    std::memcpy(static_cast<void*>(&out), words, sizeof(out));
+                    ++next_;
+                    return true;
+                }
+            }
+            resync();
+        }
+    }
+
+    // Sequence of the next message poll() will return
+    uint64_t position() const { return next_; }
+    uint64_t lost() const { return lost_; }
+    // Sequence of the newest complete message
+    uint64_t published() const { return header_->published.load(std::memory_order_acquire); }
+    void seekToLatest() { next_ = published() + 1; }
+    // Oldest message still retained; it may be overwritten before it is read
+    void seekToOldest() {
+        uint64_t last = published();
+        next_ = last > header_->capacity ? last - header_->capacity + 1 : 1;
+    }
+
+private:
+    MarketDataRing::Header* header_ = nullptr;
+    const MarketDataRing::Slot* slots_ = nullptr;
+    std::size_t size_ = 0;
+    uint64_t mask_ = 0;
+    uint64_t next_ = 1;
+    uint64_t lost_ = 0;
+
+    void resync() {
+        uint64_t from = next_;
+        seekToOldest();
+        // Skip one more slot than strictly needed: the writer is about to reuse the oldest
+        if (next_ <= from) next_ = from + 1;
+        else ++next_;
+        lost_ += next_ - from;
+    }
+};
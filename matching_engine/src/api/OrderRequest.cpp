@@ -0,0 +1,219 @@
+#include "OrderRequest.h"
+#include <unordered_set>
+#include "../utils/Utils.h"
+
+namespace {
+    bool readNumber(const nlohmann::json& v, double& out) {
+        try {
+            if (v.is_string()) {
+                out = std::stod(v.get<std::string>());
+            } else {
+                out = v.get<double>();
+            }
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    bool fail(std::string& error, Metrics::RejectReason& reason,
+              const char* message, Metrics::RejectReason why) {
+        error = message;
+        reason = why;
+        return false;
+    }
+}
+
+bool parseOrderRequest(const nlohmann::json& j, OrderRequest& out,
+                       std::string& error, Metrics::RejectReason& reason) {
+    using R = Metrics::RejectReason;
+
+    // Validate required fields and types
+    if (!j.contains("symbol") || !j["symbol"].is_string()) {
+        return fail(error, reason, "Missing or invalid 'symbol' (string)", R::INVALID_SYMBOL);
+    }
+    if (!j.contains("order_type") || !j["order_type"].is_string()) {
+        return fail(error, reason, "Missing or invalid 'order_type' (string)", R::INVALID_ORDER_TYPE);
+    }
+    if (!j.contains("side") || !j["side"].is_string()) {
+        return fail(error, reason, "Missing or invalid 'side' (string)", R::INVALID_SIDE);
+    }
+    if (!j.contains("quantity") || !(j["quantity"].is_string() || j["quantity"].is_number())) {
+        return fail(error, reason, "Missing or invalid 'quantity' (string or number)", R::INVALID_QUANTITY);
+    }
+
+    out.symbol = j["symbol"].get<std::string>();
+    out.order_type = Utils::toUpper(j["order_type"].get<std::string>());
+    out.side = Utils::toUpper(j["side"].get<std::string>());
+
+    if (!readNumber(j["quantity"], out.quantity)) {
+        return fail(error, reason, "Invalid 'quantity' value", R::INVALID_QUANTITY);
+    }
+    if (out.quantity <= 0) {
+        return fail(error, reason, "'quantity' must be positive", R::INVALID_QUANTITY);
+    }
+
+    out.price = 0.0;
+    if (j.contains("price")) {
+        if (!readNumber(j["price"], out.price)) {
+            return fail(error, reason, "Invalid 'price' value", R::INVALID_PRICE);
+        }
+        if (out.price < 0) {
+            return fail(error, reason, "'price' must be non-negative", R::INVALID_PRICE);
+        }
+    }
+
+    if (out.order_type == "LIMIT") {
+        out.type = Order::Type::LIMIT;
+    } else if (out.order_type == "MARKET") {
+        out.type = Order::Type::MARKET;
+    } else if (out.order_type == "IOC") {
+        out.type = Order::Type::IOC;
+    } else if (out.order_type == "FOK") {
+        out.type = Order::Type::FOK;
+    } else if (out.order_type == "STOP") {
+        out.type = Order::Type::STOP;
+    } else if (out.order_type == "STOP_LIMIT") {
+        out.type = Order::Type::STOP_LIMIT;
+    } else {
+        return fail(error, reason, "Invalid 'order_type' (must be limit, market, ioc, fok, stop, stop_limit)", R::INVALID_ORDER_TYPE);
+    }
+
+    out.stop_price = 0.0;
+    if (out.type == Order::Type::STOP || out.type == Order::Type::STOP_LIMIT) {
+        if (!j.contains("stop_price") || !readNumber(j["stop_price"], out.stop_price)) {
+            return fail(error, reason, "Missing or invalid 'stop_price'", R::INVALID_PRICE);
+        }
+        if (out.stop_price <= 0) {
+            return fail(error, reason, "'stop_price' must be positive", R::INVALID_PRICE);
+        }
+    }
+
+    if (out.side == "BUY") {
+        out.order_side = Order::Side::BUY;
+    } else if (out.side == "SELL") {
+        out.order_side = Order::Side::SELL;
+    } else {
+        return fail(error, reason, "Invalid 'side' (must be buy or sell)", R::INVALID_SIDE);
+    }
+
+    out.time_in_force = Order::TimeInForce::GTC;
+    out.expire_time_us = 0;
+    if (j.contains("time_in_force")) {
+        if (!j["time_in_force"].is_string()) {
+            return fail(error, reason, "Invalid 'time_in_force' (string)", R::MALFORMED);
+        }
+        std::string tif = Utils::toUpper(j["time_in_force"].get<std::string>());
+        if (tif == "GTC") {
+            out.time_in_force = Order::TimeInForce::GTC;
+        } else if (tif == "GTT" || tif == "GTD") {
+            out.time_in_force = Order::TimeInForce::GTT;
+        } else if (tif == "DAY") {
+            out.time_in_force = Order::TimeInForce::DAY;
+        } else {
+            return fail(error, reason, "Invalid 'time_in_force' (must be gtc, gtt, gtd, day)", R::MALFORMED);
+        }
+        if (out.time_in_force != Order::TimeInForce::GTC && out.type != Order::Type::LIMIT) {
+            return fail(error, reason, "'time_in_force' only applies to limit orders", R::INVALID_ORDER_TYPE);
+        }
+    }
+    if (out.time_in_force == Order::TimeInForce::GTT) {
+        if (!j.contains("expire_time") || !j["expire_time"].is_string() ||
+            !Utils::parseTimestamp(j["expire_time"].get<std::string>(), out.expire_time_us)) {
+            return fail(error, reason, "Missing or invalid 'expire_time' (YYYY-MM-DDTHH:MM:SS.ffffffZ)", R::MALFORMED);
+        }
+        if (out.expire_time_us <= Utils::nowMicros()) {
+            return fail(error, reason, "'expire_time' is in the past", R::MALFORMED);
+        }
+    }
+
+    out.display_quantity = 0.0;
+    if (j.contains("display_quantity")) {
+        if (!readNumber(j["display_quantity"], out.display_quantity)) {
+            return fail(error, reason, "Invalid 'display_quantity' value", R::INVALID_QUANTITY);
+        }
+        if (out.display_quantity <= 0 || out.display_quantity > out.quantity) {
+            return fail(error, reason, "'display_quantity' must be positive and at most 'quantity'", R::INVALID_QUANTITY);
+        }
+        if (out.type != Order::Type::LIMIT) {
+            return fail(error, reason, "'display_quantity' only applies to limit orders", R::INVALID_ORDER_TYPE);
+        }
+    }
+
+    out.client_order_id = j.contains("client_order_id") && j["client_order_id"].is_string()
+        ? j["client_order_id"].get<std::string>() : "";
+    if (j.contains("account") && !j["account"].is_string()) {
+        return fail(error, reason, "Invalid 'account' (string)", R::MALFORMED);
+    }
+    out.account = j.value("account", "");
+
+    out.stp = Order::SelfTradePrevention::CANCEL_TAKER;
+    if (j.contains("stp")) {
+        if (!j["stp"].is_string()) {
+            return fail(error, reason, "Invalid 'stp' (string)", R::MALFORMED);
+        }
+        std::string stp = Utils::toUpper(j["stp"].get<std::string>());
+        if (stp == "NONE") {
+            out.stp = Order::SelfTradePrevention::NONE;
+        } else if (stp == "CANCEL_TAKER") {
+            out.stp = Order::SelfTradePrevention::CANCEL_TAKER;
+        } else if (stp == "CANCEL_MAKER") {
+            out.stp = Order::SelfTradePrevention::CANCEL_MAKER;
+        } else if (stp == "CANCEL_BOTH") {
+            out.stp = Order::SelfTradePrevention::CANCEL_BOTH;
+        } else if (stp == "DECREMENT") {
+            out.stp = Order::SelfTradePrevention::DECREMENT;
+        } else {
+            return fail(error, reason, "Invalid 'stp' (must be none, cancel_taker, cancel_maker, cancel_both, decrement)", R::MALFORMED);
+        }
+    }
+    return true;
+}
+
+bool parseQuoteRequest(const nlohmann::json& j, QuoteRequest& out,
+                       std::string& error, Metrics::RejectReason& reason) {
+    using R = Metrics::RejectReason;
+
+    if (!j.contains("account") || !j["account"].is_string() || j["account"].get<std::string>().empty()) {
+        return fail(error, reason, "Missing or invalid 'account' (string)", R::MALFORMED);
+    }
+    if (!j.contains("quotes") || !j["quotes"].is_array() || j["quotes"].empty()) {
+        return fail(error, reason, "Missing or invalid 'quotes' (non-empty array)", R::MALFORMED);
+    }
+    if (j["quotes"].size() > kMaxQuoteEntries) {
+        return fail(error, reason, "Too many 'quotes' in one message", R::MALFORMED);
+    }
+    out.account = j["account"].get<std::string>();
+    out.quote_id = j.contains("quote_id") && j["quote_id"].is_string() ? j["quote_id"].get<std::string>() : "";
+
+    out.entries.clear();
+    out.entries.reserve(j["quotes"].size());
+    std::unordered_set<std::string> symbols;
+    for (const auto& row : j["quotes"]) {
+        if (!row.is_array() || row.size() != 5 || !row[0].is_string()) {
+            return fail(error, reason, "Invalid quote (expected [symbol, bid_price, bid_quantity, ask_price, ask_quantity])", R::MALFORMED);
+        }
+        QuoteEntry entry;
+        entry.symbol = row[0].get<std::string>();
+        if (entry.symbol.empty() || !symbols.insert(entry.symbol).second) {
+            return fail(error, reason, "Missing or repeated quote 'symbol'", R::INVALID_SYMBOL);
+        }
+        if (!readNumber(row[1], entry.bid_price) || !readNumber(row[3], entry.ask_price)) {
+            return fail(error, reason, "Invalid quote price value", R::INVALID_PRICE);
+        }
+        if (!readNumber(row[2], entry.bid_quantity) || !readNumber(row[4], entry.ask_quantity)) {
+            return fail(error, reason, "Invalid quote quantity value", R::INVALID_QUANTITY);
+        }
+        if (entry.bid_quantity < 0 || entry.ask_quantity < 0) {
+            return fail(error, reason, "Quote quantities must be non-negative", R::INVALID_QUANTITY);
+        }
+        if ((entry.bid_quantity > 0 && entry.bid_price <= 0) || (entry.ask_quantity > 0 && entry.ask_price <= 0)) {
+            return fail(error, reason, "Quoted sides must have a positive price", R::INVALID_PRICE);
+        }
+        if (entry.bid_quantity > 0 && entry.ask_quantity > 0 && entry.bid_price >= entry.ask_price) {
+            return fail(error, reason, "Quote bid must be below its ask", R::INVALID_PRICE);
+        }
+        out.entries.push_back(std::move(entry));
+    }
+    return true;
+}
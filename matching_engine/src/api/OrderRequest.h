@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <nlohmann/json.hpp>
+#include <vector>
+#include "../core/Order.h"
+#include "../core/Quote.h"
+#include "../utils/Metrics.h"
+
+// Validated order entry message, shared by the REST and WebSocket gateways
+struct OrderRequest {
+    std::string symbol;
+    std::string order_type;       // upper-cased, as received
+    std::string side;             // upper-cased, as received
+    Order::Type type;
+    Order::Side order_side;
+    double quantity = 0.0;
+    double price = 0.0;
+    std::string client_order_id;  // optional, echoed back to the client
+    std::string account;          // optional, selects pre-trade risk limits
+    double stop_price = 0.0;       // required for stop and stop_limit
+    Order::TimeInForce time_in_force = Order::TimeInForce::GTC; // limit orders only
+    int64_t expire_time_us = 0;    // required for gtt
+    double display_quantity = 0.0; // optional iceberg peak size, limit orders only
+    Order::SelfTradePrevention stp = Order::SelfTradePrevention::CANCEL_TAKER;
+};
+
+// Returns false with a client-facing error and the reject reason if the
+// message is not a valid order.
+bool parseOrderRequest(const nlohmann::json& j, OrderRequest& out,
+                       std::string& error, Metrics::RejectReason& reason);
+
+// Validated mass quote message. Each row of "quotes" is
+// [symbol, bid_price, bid_quantity, ask_price, ask_quantity]; a zero quantity
+// pulls that side. Order ids are left for the gateway to assign.
+struct QuoteRequest {
+    std::string quote_id;  // optional, echoed back in the ack and on fills
+    std::string account;   // required; quotes are held per account
+    std::vector<QuoteEntry> entries;
+};
+
+constexpr std::size_t kMaxQuoteEntries = 100;
+
+bool parseQuoteRequest(const nlohmann::json& j, QuoteRequest& out,
+                       std::string& error, Metrics::RejectReason& reason);
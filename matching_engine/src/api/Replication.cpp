@@ -0,0 +1,376 @@
+#include "Replication.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include "../utils/Logger.h"
+#include "../utils/Utils.h"
+
+using boost::asio::ip::tcp;
+
+namespace {
+    // Reserves a frame header at the end of `out`; returns its offset
+    std::size_t beginFrame(std::string& out, ReplicationFrame::Kind kind) {
+        std::size_t start = out.size();
+        out.append(sizeof(uint32_t), '\0');
+        out.push_back(static_cast<char>(kind));
+        return start;
+    }
+
+    void endFrame(std::string& out, std::size_t start) {
+        uint32_t size = static_cast<uint32_t>(out.size() - start - ReplicationFrame::kHeaderSize);
+        std::memcpy(&out[start], &size, sizeof(size));
+    }
+}
+
+ReplicationPrimary::ReplicationPrimary(std::shared_ptr<MatchingEngine> engine, int port, int64_t heartbeat_us,
+                                       std::size_t max_history_bytes, int64_t send_timeout_us)
+    : engine_(std::move(engine)),
+      heartbeat_us_(heartbeat_us),
+      max_history_bytes_(max_history_bytes),
+      send_timeout_us_(send_timeout_us),
+      acceptor_(io_, tcp::endpoint(tcp::v4(), static_cast<unsigned short>(port))),
+      drain_timer_(io_) {}
+
+ReplicationPrimary::~ReplicationPrimary() {
+    stop();
+}
+
+void ReplicationPrimary::start() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (running_) return;
+        running_ = true;
+    }
+    engine_->setOnCommand([this](Command& command) { record(command); });
+    acceptNext();
+    io_thread_ = std::thread([this]() { io_.run(); });
+    send_thread_ = std::thread([this]() { sendLoop(); });
+}
+
+void ReplicationPrimary::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_one();
+    // The sender hands its last batch to the I/O thread, which then drains
+    if (send_thread_.joinable()) send_thread_.join();
+    boost::asio::post(io_, [this]() { drain(); });
+    if (io_thread_.joinable()) io_thread_.join();
+    engine_->setOnCommand(nullptr);
+    boost::system::error_code ec;
+    acceptor_.close(ec);
+    for (auto& backup : backups_) backup->socket.close(ec);
+    backups_.clear();
+    backup_count_ = 0;
+}
+
+int ReplicationPrimary::port() const {
+    return acceptor_.local_endpoint().port();
+}
+
+uint64_t ReplicationPrimary::lastSequence() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return sequence_;
+}
+
+std::size_t ReplicationPrimary::backupCount() const {
+    return backup_count_.load(std::memory_order_relaxed);
+}
+
+bool ReplicationPrimary::acceptsLateBackups() const {
+    return history_complete_.load(std::memory_order_relaxed);
+}
+
+void ReplicationPrimary::record(Command& command) {
+    // On the matching path: encode and append only, never touch a socket
+    std::lock_guard<std::mutex> lock(mtx_);
+    command.sequence = ++sequence_;
+    std::size_t start = beginFrame(pending_, ReplicationFrame::Kind::COMMAND);
+    encodeCommand(command, pending_);
+    endFrame(pending_, start);
+    // One wakeup per batch: later records just join it
+    if (sender_waiting_) {
+        sender_waiting_ = false;
+        cv_.notify_one();
+    }
+}
+
+void ReplicationPrimary::acceptNext() {
+    auto socket = std::make_shared<Socket>(io_);
+    acceptor_.async_accept(*socket, [this, socket](const boost::system::error_code& ec) {
+        if (ec) return; // Acceptor closed
+        if (!history_complete_) {
+            // A tail without the start cannot rebuild the books
+            Logger::warn("Replication: refusing a late backup, the journal history was dropped");
+            boost::system::error_code ignored;
+            socket->close(ignored);
+        } else {
+            // Gets everything delivered so far, then every later batch
+            socket->set_option(tcp::no_delay(true));
+            auto backup = std::make_shared<Backup>(std::move(*socket));
+            if (!history_.empty()) {
+                backup->queue.push_back(std::make_shared<const std::string>(history_));
+            }
+            backups_.push_back(backup);
+            backup_count_.store(backups_.size(), std::memory_order_relaxed);
+            flush(backup);
+        }
+        acceptNext();
+    });
+}
+
+void ReplicationPrimary::sendLoop() {
+    std::string batch;
+    for (;;) {
+        bool stopping;
+        bool heartbeat;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            sender_waiting_ = true;
+            cv_.wait_for(lock, std::chrono::microseconds(heartbeat_us_), [this]() {
+                return !running_ || !pending_.empty();
+            });
+            sender_waiting_ = false;
+            stopping = !running_;
+            batch.swap(pending_);
+            heartbeat = batch.empty();
+            if (heartbeat) {
+                // Idle: tell backups the primary is alive and how far it got
+                std::size_t start = beginFrame(batch, ReplicationFrame::Kind::HEARTBEAT);
+                batch.append(reinterpret_cast<const char*>(&sequence_), sizeof(sequence_));
+                endFrame(batch, start);
+            }
+        }
+        // Sockets are only written from the I/O thread, so a slow backup
+        // never holds up this loop or the engine
+        auto frames = std::make_shared<const std::string>(std::move(batch));
+        boost::asio::post(io_, [this, frames, heartbeat]() { deliver(frames, heartbeat); });
+        batch = std::string();
+        if (stopping) return;
+    }
+}
+
+void ReplicationPrimary::deliver(const Frames& frames, bool heartbeat) {
+    const int64_t now_us = Utils::nowMicros();
+    for (std::size_t i = 0; i < backups_.size();) {
+        auto backup = backups_[i];
+        if (backup->in_flight > 0 && now_us - backup->progress_us > send_timeout_us_) {
+            Logger::warn("Replication: dropping a backup that took nothing for " +
+                         std::to_string(send_timeout_us_ / 1000) + "ms");
+            drop(backup);
+            continue;
+        }
+        if (backup->backlog + frames->size() > kMaxBacklogBytes) {
+            Logger::warn("Replication: dropping a backup more than " + std::to_string(kMaxBacklogBytes) +
+                         " bytes behind");
+            drop(backup);
+            continue;
+        }
+        backup->queue.push_back(frames);
+        backup->backlog += frames->size();
+        flush(backup);
+        ++i;
+    }
+    if (!heartbeat && history_complete_) {
+        if (history_.size() + frames->size() > max_history_bytes_) {
+            history_complete_ = false;
+            std::string().swap(history_);
+            Logger::warn("Replication: journal history passed " + std::to_string(max_history_bytes_) +
+                         " bytes and was dropped; late backups will be refused");
+        } else {
+            history_.append(*frames);
+        }
+    }
+}
+
+void ReplicationPrimary::flush(const std::shared_ptr<Backup>& backup) {
+    if (backup->in_flight > 0) return;
+    if (backup->queue.empty()) {
+        if (draining_) drop(backup);
+        return;
+    }
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(backup->queue.size());
+    for (const auto& frames : backup->queue) buffers.push_back(boost::asio::buffer(*frames));
+    backup->in_flight = backup->queue.size();
+    backup->backlog = 0;
+    // Called between the partial writes a large gather takes: each one the
+    // backup reads counts as progress
+    auto progress = [backup](const boost::system::error_code& ec, std::size_t) -> std::size_t {
+        backup->progress_us = Utils::nowMicros();
+        return ec ? 0 : 65536;
+    };
+    boost::asio::async_write(backup->socket, buffers, progress, [this, backup](const boost::system::error_code& ec, std::size_t) {
+        if (ec) {
+            drop(backup);
+            return;
+        }
+        backup->queue.erase(backup->queue.begin(), backup->queue.begin() + static_cast<std::ptrdiff_t>(backup->in_flight));
+        backup->in_flight = 0;
+        flush(backup);
+    });
+}
+
+void ReplicationPrimary::drop(const std::shared_ptr<Backup>& backup) {
+    auto it = std::find(backups_.begin(), backups_.end(), backup);
+    if (it == backups_.end()) return;
+    boost::system::error_code ec;
+    backup->socket.close(ec);
+    backups_.erase(it);
+    backup_count_.store(backups_.size(), std::memory_order_relaxed);
+    if (draining_ && backups_.empty()) io_.stop();
+}
+
+void ReplicationPrimary::drain() {
+    // Runs after the sender's last delivery: no new backups, and each one
+    // is closed once its queue is written, or at the send timeout
+    draining_ = true;
+    boost::system::error_code ec;
+    acceptor_.close(ec);
+    if (backups_.empty()) {
+        io_.stop();
+        return;
+    }
+    drain_timer_.expires_after(std::chrono::microseconds(send_timeout_us_));
+    drain_timer_.async_wait([this](const boost::system::error_code& ec) {
+        if (!ec) io_.stop();
+    });
+    auto pending = backups_;
+    for (auto& backup : pending) flush(backup);
+}
+
+ReplicationBackup::ReplicationBackup(std::shared_ptr<MatchingEngine> engine, const std::string& host, int port,
+                                     int64_t timeout_us)
+    : engine_(std::move(engine)),
+      host_(host),
+      port_(port),
+      timeout_us_(timeout_us),
+      socket_(io_),
+      watchdog_(io_) {}
+
+ReplicationBackup::~ReplicationBackup() {
+    stop();
+}
+
+void ReplicationBackup::setOnFailover(const std::function<void()>& callback) {
+    on_failover_cb_ = callback;
+}
+
+void ReplicationBackup::start() {
+    engine_->setReplica(true);
+    last_heard_us_ = Utils::nowMicros();
+    tcp::resolver resolver(io_);
+    boost::system::error_code ec;
+    auto endpoints = resolver.resolve(host_, std::to_string(port_), ec);
+    if (ec) {
+        failover("cannot resolve " + host_);
+        return;
+    }
+    boost::asio::async_connect(socket_, endpoints, [this](const boost::system::error_code& ec, const tcp::endpoint&) {
+        if (ec) {
+            failover("cannot connect: " + ec.message());
+            return;
+        }
+        socket_.set_option(tcp::no_delay(true));
+        Logger::info("Replication: following primary " + host_ + ":" + std::to_string(port_));
+        readHeader();
+    });
+    armWatchdog();
+    thread_ = std::thread([this]() { io_.run(); });
+}
+
+void ReplicationBackup::stop() {
+    io_.stop();
+    if (thread_.joinable()) thread_.join();
+    boost::system::error_code ec;
+    socket_.close(ec);
+}
+
+uint64_t ReplicationBackup::appliedSequence() const {
+    return applied_.load(std::memory_order_acquire);
+}
+
+bool ReplicationBackup::failedOver() const {
+    return failed_.load(std::memory_order_acquire);
+}
+
+void ReplicationBackup::readHeader() {
+    boost::asio::async_read(socket_, boost::asio::buffer(header_), [this](const boost::system::error_code& ec, std::size_t) {
+        if (ec) {
+            failover("connection lost: " + ec.message());
+            return;
+        }
+        uint32_t size;
+        std::memcpy(&size, header_.data(), sizeof(size));
+        auto kind = static_cast<ReplicationFrame::Kind>(header_[sizeof(size)]);
+        if (size > ReplicationFrame::kMaxPayload) {
+            failover("oversized frame");
+            return;
+        }
+        body_.resize(size);
+        readBody(kind);
+    });
+}
+
+void ReplicationBackup::readBody(ReplicationFrame::Kind kind) {
+    boost::asio::async_read(socket_, boost::asio::buffer(body_), [this, kind](const boost::system::error_code& ec, std::size_t) {
+        if (ec) {
+            failover("connection lost: " + ec.message());
+            return;
+        }
+        last_heard_us_ = Utils::nowMicros();
+        handleFrame(kind);
+        if (!failed_) readHeader();
+    });
+}
+
+void ReplicationBackup::handleFrame(ReplicationFrame::Kind kind) {
+    if (kind == ReplicationFrame::Kind::HEARTBEAT) return;
+    Command command;
+    if (kind != ReplicationFrame::Kind::COMMAND || !decodeCommand(body_.data(), body_.size(), command)) {
+        failover("malformed frame");
+        return;
+    }
+    uint64_t expected = applied_.load(std::memory_order_relaxed) + 1;
+    if (command.sequence != expected) {
+        failover("sequence gap at " + std::to_string(expected));
+        return;
+    }
+    try {
+        engine_->apply(command);
+    } catch (const std::exception& e) {
+        // The primary hit the same error on this command; state still matches
+        Logger::err("Replication: command " + std::to_string(command.sequence) + " failed: " + e.what());
+    }
+    applied_.store(command.sequence, std::memory_order_release);
+}
+
+void ReplicationBackup::armWatchdog() {
+    // Checks a few times per timeout instead of rearming a timer per frame
+    watchdog_.expires_after(std::chrono::microseconds(timeout_us_ / 4 + 1));
+    watchdog_.async_wait([this](const boost::system::error_code& ec) {
+        if (ec || failed_) return;
+        if (Utils::nowMicros() - last_heard_us_ > timeout_us_) {
+            failover("no heartbeat for " + std::to_string(timeout_us_ / 1000) + "ms");
+            return;
+        }
+        armWatchdog();
+    });
+}
+
+void ReplicationBackup::failover(const std::string& reason) {
+    if (failed_.exchange(true)) return;
+    boost::system::error_code ec;
+    watchdog_.cancel();
+    socket_.close(ec);
+    Logger::err("Replication: primary lost (" + reason + "), taking over at sequence " +
+                std::to_string(applied_.load()));
+    engine_->setReplica(false);
+    if (on_failover_cb_) on_failover_cb_();
+}
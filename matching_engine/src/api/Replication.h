@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include "../core/MatchingEngine.h"
+
+// Hot standby. The primary journals every engine command and streams the
+// sequenced log to its backups over TCP; a backup replays it into a warm
+// engine and takes over when the primary goes quiet.
+//
+// Frames are [u32 payload length][u8 kind][payload], in host byte order. A
+// COMMAND carries an encoded Command, a HEARTBEAT the last sequence sent.
+struct ReplicationFrame {
+    enum class Kind : uint8_t { COMMAND, HEARTBEAT };
+    static constexpr std::size_t kHeaderSize = 5;
+    static constexpr uint32_t kMaxPayload = 1 << 20;
+};
+
+class ReplicationPrimary {
+public:
+    // Port 0 binds any free port; see port(). With no commands to send, a
+    // heartbeat goes out every heartbeat_us. A late backup replays the journal
+    // from the start; once that outgrows max_history_bytes it is dropped, and
+    // later backups are refused while connected ones keep streaming. Writes
+    // are asynchronous and per backup. One whose write makes no progress for
+    // send_timeout_us, or with kMaxBacklogBytes queued behind the write on the
+    // wire, is dropped, so it cannot stall the others or stop().
+    ReplicationPrimary(std::shared_ptr<MatchingEngine> engine, int port, int64_t heartbeat_us = 50'000,
+                       std::size_t max_history_bytes = std::size_t(256) << 20,
+                       int64_t send_timeout_us = 2'000'000);
+    ~ReplicationPrimary();
+
+    // Journals the engine from here on; call before it accepts orders
+    void start();
+    // Sends what is pending, waiting up to the send timeout for backups to
+    // take it, and disconnects them; call once the engine is idle
+    void stop();
+    int port() const;
+    uint64_t lastSequence() const;
+    std::size_t backupCount() const;
+    bool acceptsLateBackups() const; // False once the history was dropped
+
+    static constexpr std::size_t kMaxBacklogBytes = std::size_t(64) << 20;
+
+private:
+    using Socket = boost::asio::ip::tcp::socket;
+    using Frames = std::shared_ptr<const std::string>;
+
+    // Batches queue per backup and go out in one gathered write; the front
+    // in_flight entries are on the wire, the backlog bytes behind them
+    struct Backup {
+        explicit Backup(Socket s) : socket(std::move(s)) {}
+        Socket socket;
+        std::deque<Frames> queue;
+        std::size_t in_flight = 0;
+        std::size_t backlog = 0;
+        int64_t progress_us = 0; // When the write on the wire started or last completed
+    };
+
+    std::shared_ptr<MatchingEngine> engine_;
+    int64_t heartbeat_us_;
+    std::size_t max_history_bytes_;
+    int64_t send_timeout_us_;
+    boost::asio::io_context io_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::steady_timer drain_timer_;
+    std::thread io_thread_;
+    std::thread send_thread_;
+
+    // Written by the engine under a book lock, so only appends happen here.
+    // The sender takes everything pending at once: a burst of commands goes
+    // out in one write while the previous one is on the wire.
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::string pending_;
+    uint64_t sequence_ = 0;
+    bool sender_waiting_ = false;
+    bool running_ = false;
+
+    // I/O thread only
+    std::string history_; // Every command frame so far, replayed to late joiners
+    std::atomic<bool> history_complete_{true};
+    std::vector<std::shared_ptr<Backup>> backups_;
+    std::atomic<std::size_t> backup_count_{0};
+    bool draining_ = false;
+
+    void record(Command& command);
+    void acceptNext();
+    void sendLoop();
+    void deliver(const Frames& frames, bool heartbeat);
+    void flush(const std::shared_ptr<Backup>& backup);
+    void drop(const std::shared_ptr<Backup>& backup);
+    void drain();
+};
+
+class ReplicationBackup {
+public:
+    // Declares the primary lost after timeout_us without a frame
+    ReplicationBackup(std::shared_ptr<MatchingEngine> engine, const std::string& host, int port,
+                      int64_t timeout_us = 500'000);
+    ~ReplicationBackup();
+
+    // Called once, on the replication thread, when the primary is lost: the
+    // connection failed, broke, or went silent. The engine is no longer a
+    // replica by then and can take orders.
+    void setOnFailover(const std::function<void()>& callback);
+    // Makes the engine a replica, then connects and applies in the background
+    void start();
+    void stop();
+    uint64_t appliedSequence() const;
+    bool failedOver() const;
+
+private:
+    std::shared_ptr<MatchingEngine> engine_;
+    std::string host_;
+    int port_;
+    int64_t timeout_us_;
+    boost::asio::io_context io_;
+    boost::asio::ip::tcp::socket socket_;
+    boost::asio::steady_timer watchdog_;
+    std::thread thread_;
+    std::array<char, ReplicationFrame::kHeaderSize> header_{};
+    std::vector<char> body_;
+    int64_t last_heard_us_ = 0; // Replication thread only
+    std::atomic<uint64_t> applied_{0};
+    std::atomic<bool> failed_{false};
+    std::function<void()> on_failover_cb_;
+
+    void readHeader();
+    void readBody(ReplicationFrame::Kind kind);
+    void handleFrame(ReplicationFrame::Kind kind);
+    void armWatchdog();
+    void failover(const std::string& reason);
+};
@@ -1,11 +1,54 @@
 #include "RestServer.h"
+// Bounded accept backlog; must be defined before httplib is included
+#ifndef CPPHTTPLIB_LISTEN_BACKLOG
+#define CPPHTTPLIB_LISTEN_BACKLOG 512
+#endif
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 #include "../utils/Logger.h"
 #include "../utils/Utils.h"
+#include "../utils/Metrics.h"
+#include "OrderRequest.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+    // How long the connection now being served waited for a worker, and the
+    // share of that charged to the request being handled: only a
+    // connection's first request waited in the queue
+    thread_local int64_t connection_wait_us = 0;
+    thread_local int64_t request_wait_us = 0;
+
+    // httplib's pool, stamping each connection with its time in the queue
+    class TimedThreadPool : public httplib::ThreadPool {
+    public:
+        using httplib::ThreadPool::ThreadPool;
+
+        bool enqueue(std::function<void()> fn) override {
+            int64_t enqueued_us = Utils::nowMicros();
+            return httplib::ThreadPool::enqueue([fn = std::move(fn), enqueued_us]() {
+                connection_wait_us = Utils::nowMicros() - enqueued_us;
+                fn();
+            });
+        }
+    };
+}
 
 RestServer::RestServer(std::shared_ptr<MatchingEngine> engine, int port)
-    : engine_(engine), port_(port), running_(false) {}
+    : RestServer(engine, port, RestServerConfig{}) {}
+
+RestServer::RestServer(std::shared_ptr<MatchingEngine> engine, int port, const RestServerConfig& config)
+    : engine_(engine), port_(port), config_(config), running_(false) {
+    if (config_.worker_threads == 0) {
+        config_.worker_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (config_.max_inflight_orders == 0) {
+        // Leave a worker for cancels and market data queries
+        config_.max_inflight_orders = std::max<std::size_t>(1, config_.worker_threads - 1);
+    }
+}
 
 RestServer::~RestServer() {
     stop();
@@ -13,182 +56,497 @@ RestServer::~RestServer() {
 
 void RestServer::start() {
     if (!running_) {
+        svr_ = std::make_unique<httplib::Server>();
+        const std::size_t workers = config_.worker_threads;
+        const std::size_t max_queued = config_.max_queued_requests;
+        svr_->new_task_queue = [workers, max_queued]() {
+            return new TimedThreadPool(workers, max_queued);
+        };
+        svr_->set_keep_alive_max_count(config_.keep_alive_max_count);
+        svr_->set_keep_alive_timeout(config_.keep_alive_timeout_sec);
+        svr_->set_read_timeout(config_.read_timeout_sec, 0);
+        svr_->set_write_timeout(config_.write_timeout_sec, 0);
+        svr_->set_payload_max_length(config_.payload_max_bytes);
+        svr_->set_tcp_nodelay(true);
+        registerHandlers();
+
+        // Bind here so a port conflict is reported to the caller, and so
+        // stop() always has a listening socket to close
+        if (!svr_->bind_to_port("0.0.0.0", port_)) {
+            svr_.reset();
+            throw std::runtime_error("Failed to bind REST server to port " + std::to_string(port_));
+        }
+
         running_ = true;
         server_thread_ = std::thread([this]() {
             try {
-                httplib::Server svr;
-
-                // CORS preflight
-                svr.Options("/orders", [](const httplib::Request& req, httplib::Response& res) {
-                    res.set_header("Access-Control-Allow-Origin", "*");
-                    res.set_header("Access-Control-Allow-Methods", "POST, OPTIONS");
-                    res.set_header("Access-Control-Allow-Headers", "Content-Type");
-                    res.status = 204;
-                });
-
-                svr.Post("/orders", [this](const httplib::Request& req, httplib::Response& res) {
-                    auto set_cors = [&res]() {
-                        res.set_header("Access-Control-Allow-Origin", "*");
-                        res.set_header("Access-Control-Allow-Methods", "POST, OPTIONS");
-                        res.set_header("Access-Control-Allow-Headers", "Content-Type");
-                    };
-                    set_cors();
-                    try {
-                        auto j = nlohmann::json::parse(req.body);
-                        // Validate required fields and types
-                        if (!j.contains("symbol") || !j["symbol"].is_string()) {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"Missing or invalid 'symbol' (string)\"}", "application/json");
-                            Logger::err("Order rejected: missing/invalid symbol");
-                            return;
-                        }
-                        if (!j.contains("order_type") || !j["order_type"].is_string()) {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"Missing or invalid 'order_type' (string)\"}", "application/json");
-                            Logger::err("Order rejected: missing/invalid order_type");
-                            return;
-                        }
-                        if (!j.contains("side") || !j["side"].is_string()) {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"Missing or invalid 'side' (string)\"}", "application/json");
-                            Logger::err("Order rejected: missing/invalid side");
-                            return;
-                        }
-                        if (!j.contains("quantity") || !(j["quantity"].is_string() || j["quantity"].is_number())) {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"Missing or invalid 'quantity' (string or number)\"}", "application/json");
-                            Logger::err("Order rejected: missing/invalid quantity");
-                            return;
-                        }
-
-                        std::string symbol = j["symbol"].get<std::string>();
-                        std::string order_type = Utils::toUpper(j["order_type"].get<std::string>());
-                        std::string side = Utils::toUpper(j["side"].get<std::string>());
-                        double quantity = 0.0;
-
-                        try {
-                            if (j["quantity"].is_string()) {
-                                quantity = std::stod(j["quantity"].get<std::string>());
-                            } else {
-                                quantity = j["quantity"].get<double>();
-                            }
-                        } catch (const std::exception&) {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"Invalid 'quantity' value\"}", "application/json");
-                            Logger::err("Order rejected: invalid quantity value");
-                            return;
-                        }
-
-                        if (quantity <= 0) {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"'quantity' must be positive\"}", "application/json");
-                            Logger::err("Order rejected: non-positive quantity");
-                            return;
-                        }
-
-                        double price = 0.0;
-                        if (j.contains("price")) {
-                            try {
-                                if (j["price"].is_string()) {
-                                    price = std::stod(j["price"].get<std::string>());
-                                } else {
-                                    price = j["price"].get<double>();
-                                }
-                            } catch (const std::exception&) {
-                                res.status = 400;
-                                res.set_content("{\"error\":\"Invalid 'price' value\"}", "application/json");
-                                Logger::err("Order rejected: invalid price value");
-                                return;
-                            }
-                            if (price < 0) {
-                                res.status = 400;
-                                res.set_content("{\"error\":\"'price' must be non-negative\"}", "application/json");
-                                Logger::err("Order rejected: negative price");
-                                return;
-                            }
-                        }
-
-                        Order::Type type;
-                        if (order_type == "LIMIT") {
-                            type = Order::Type::LIMIT;
-                        } else if (order_type == "MARKET") {
-                            type = Order::Type::MARKET;
-                        } else if (order_type == "IOC") {
-                            type = Order::Type::IOC;
-                        } else if (order_type == "FOK") {
-                            type = Order::Type::FOK;
-                        } else {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"Invalid 'order_type' (must be limit, market, ioc, fok)\"}", "application/json");
-                            Logger::err("Order rejected: invalid order_type");
-                            return;
-                        }
-
-                        Order::Side s;
-                        if (side == "BUY") {
-                            s = Order::Side::BUY;
-                        } else if (side == "SELL") {
-                            s = Order::Side::SELL;
-                        } else {
-                            res.status = 400;
-                            res.set_content("{\"error\":\"Invalid 'side' (must be buy or sell)\"}", "application/json");
-                            Logger::err("Order rejected: invalid side");
-                            return;
-                        }
-
-                        std::string order_id = Utils::getCurrentTimestamp() + symbol + order_type + side; // Simple unique id
-                        std::string timestamp = Utils::getCurrentTimestamp();
-                        Order order(order_id, symbol, type, s, quantity, price, timestamp);
-
-                        Logger::info("Order received: " + order_id + " " + symbol + " " + order_type + " " + side + 
-                                    " qty=" + std::to_string(quantity) + " price=" + std::to_string(price));
-
-                        auto trades = engine_->processOrder(order);
-                        nlohmann::json resp;
-                        resp["order_id"] = order_id;
-                        resp["status"] = "success";
-                        resp["message"] = "Order submitted successfully";
-                        resp["executions"] = nlohmann::json::array();
-
-                        for (const auto& t : trades) {
-                            resp["executions"].push_back(nlohmann::json::parse(t.toJSON()));
-                        }
-
-                        res.status = 200;
-                        res.set_content(resp.dump(), "application/json");
-
-                    } catch (const std::exception& ex) {
-                        res.status = 400;
-                        std::string error_msg = "{\"error\":\"" + std::string(ex.what()) + "\"}";
-                        res.set_content(error_msg, "application/json");
-                        Logger::err("Order rejected: " + std::string(ex.what()));
-                    }
-                });
-
-                Logger::info("REST server listening on port " + std::to_string(port_));
-                if (!svr.listen("0.0.0.0", port_)) {
-                    Logger::err("Failed to start REST server on port " + std::to_string(port_));
-                    running_ = false;
-                }
+                Logger::info("REST server listening on port " + std::to_string(port_) +
+                             " with " + std::to_string(config_.worker_threads) + " workers");
+                svr_->listen_after_bind();
             } catch (const std::exception& e) {
                 Logger::err("REST server error: " + std::string(e.what()));
-                running_ = false;
             }
         });
     }
 }
 
+void RestServer::setBarAggregator(std::shared_ptr<BarAggregator> bars) {
+    bars_ = std::move(bars);
+}
+
+void RestServer::setMarketDataBus(std::shared_ptr<MarketDataBus> bus) {
+    md_bus_ = std::move(bus);
+}
+
+void RestServer::setReadReplica(std::shared_ptr<ReadReplica> replica) {
+    replica_ = std::move(replica);
+}
+
+void RestServer::setRiskManager(std::shared_ptr<RiskManager> risk) {
+    risk_ = std::move(risk);
+}
+
 void RestServer::stop() {
     if (running_) {
         running_ = false;
-        // The server will stop when the thread exits
+        // Wait for the listener to come up so stop() cannot be lost
+        for (int i = 0; i < 1000 && !svr_->is_running(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // Closes the listening socket; listen_after_bind() returns once the
+        // worker pool has finished the requests already in flight
+        svr_->stop();
         if (server_thread_.joinable()) {
             server_thread_.join();
         }
+        svr_.reset();
         Logger::info("REST server stopped");
     }
 }
 
+namespace {
+    constexpr std::size_t kDefaultTradesLimit = 1000;
+    constexpr int kDefaultDepthLevels = 10;
+
+    // Compares every byte, so a mismatch takes as long wherever it is
+    bool authorized(const httplib::Request& req, const std::string& token) {
+        const std::string expected = "Bearer " + token;
+        const std::string& given = req.get_header_value("Authorization");
+        unsigned char diff = given.size() == expected.size() ? 0 : 1;
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            diff |= static_cast<unsigned char>(expected[i] ^ (i < given.size() ? given[i] : 0));
+        }
+        return diff == 0;
+    }
+
+    nlohmann::json limitsJSON(const std::string& account, const RiskLimits& limits) {
+        return {{"account", account},
+                {"max_order_quantity", limits.max_order_quantity},
+                {"max_order_notional", limits.max_order_notional},
+                {"max_open_orders", limits.max_open_orders},
+                {"max_position", limits.max_position},
+                {"price_band", limits.price_band}};
+    }
+}
+
 void RestServer::registerHandlers() {
-    // Not used in this implementation
-}
\ No newline at end of file
+    svr_->set_pre_routing_handler([](const httplib::Request&, httplib::Response&) {
+        request_wait_us = connection_wait_us;
+        connection_wait_us = 0;
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+
+    // CORS preflight
+    svr_->Options("/orders", [](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_header("Access-Control-Allow-Methods", "POST, DELETE, OPTIONS");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type");
+        res.status = 204;
+    });
+
+    svr_->Post("/orders", [this](const httplib::Request& req, httplib::Response& res) {
+        auto set_cors = [&res]() {
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.set_header("Access-Control-Allow-Methods", "POST, OPTIONS");
+            res.set_header("Access-Control-Allow-Headers", "Content-Type");
+        };
+        set_cors();
+        Metrics::increment(Metrics::Counter::ORDERS_RECEIVED);
+
+        // Shed load up front rather than queueing more work behind a busy
+        // engine: too many orders on the workers, or this one queued too long
+        struct InflightGuard {
+            std::atomic<std::size_t>& n;
+            std::size_t count = n.fetch_add(1) + 1;
+            ~InflightGuard() { n.fetch_sub(1); }
+        } inflight{inflight_orders_};
+        if (!running_ || inflight.count > config_.max_inflight_orders ||
+            request_wait_us > static_cast<int64_t>(config_.max_queue_wait_ms) * 1000) {
+            res.status = 503;
+            res.set_header("Retry-After", "1");
+            res.set_content("{\"error\":\"Server busy, retry later\"}", "application/json");
+            Metrics::increment(Metrics::Counter::ORDERS_SHED);
+            return;
+        }
+
+        try {
+            auto j = nlohmann::json::parse(req.body);
+            OrderRequest request;
+            std::string error;
+            Metrics::RejectReason reason;
+            if (!parseOrderRequest(j, request, error, reason)) {
+                res.status = 400;
+                res.set_content(nlohmann::json{{"error", error}}.dump(), "application/json");
+                Metrics::reject(reason);
+                Logger::err("Order rejected: " + error);
+                return;
+            }
+
+            const std::string& symbol = request.symbol;
+            const std::string& order_type = request.order_type;
+            const std::string& side = request.side;
+            double quantity = request.quantity;
+            double price = request.price;
+
+            std::string order_id = Utils::getCurrentTimestamp() + symbol + order_type + side; // Simple unique id
+            std::string timestamp = Utils::getCurrentTimestamp();
+            Order order(order_id, symbol, request.type, request.order_side, quantity, price, timestamp);
+            order.setAccount(request.account);
+            order.setSelfTradePrevention(request.stp);
+            order.setDisplayQuantity(request.display_quantity);
+            order.setStopPrice(request.stop_price);
+            order.setTimeInForce(request.time_in_force, request.expire_time_us);
+
+            Logger::info("Order received: " + order_id + " " + symbol + " " + order_type + " " + side + 
+                        " qty=" + std::to_string(quantity) + " price=" + std::to_string(price));
+
+            RiskManager::Reject risk = RiskManager::Reject::NONE;
+            auto trades = engine_->processOrder(order, &risk);
+            if (risk != RiskManager::Reject::NONE) {
+                std::string message = RiskManager::rejectMessage(risk);
+                res.status = 400;
+                res.set_content(nlohmann::json{{"error", message}, {"order_id", order_id},
+                                               {"engine_id", order.getEngineId()}}.dump(), "application/json");
+                Metrics::reject(Metrics::RejectReason::RISK_LIMIT);
+                Logger::err("Order rejected by risk: " + order_id + " " + message);
+                return;
+            }
+            nlohmann::json resp;
+            resp["order_id"] = order_id;
+            resp["engine_id"] = order.getEngineId(); // Key for GET /orders/{engine_id}
+            resp["status"] = "success";
+            resp["message"] = "Order submitted successfully";
+            if (order.getStatus() == Order::Status::CANCELLED && order.getType() == Order::Type::LIMIT) {
+                resp["message"] = "Order cancelled by self-trade prevention";
+            }
+            resp["executions"] = nlohmann::json::array();
+
+            for (const auto& t : trades) {
+                resp["executions"].push_back(nlohmann::json::parse(t.toJSON()));
+            }
+
+            res.status = 200;
+            res.set_content(resp.dump(), "application/json");
+
+        } catch (const std::exception& ex) {
+            res.status = 400;
+            std::string error_msg = "{\"error\":\"" + std::string(ex.what()) + "\"}";
+            res.set_content(error_msg, "application/json");
+            Metrics::reject(Metrics::RejectReason::MALFORMED);
+            Logger::err("Order rejected: " + std::string(ex.what()));
+        }
+    });
+
+    // Mass cancel: everything an account has resting or parked, optionally in one symbol
+    svr_->Delete("/orders", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!req.has_param("account") || req.get_param_value("account").empty()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'account' query parameter\"}", "application/json");
+            return;
+        }
+        std::string symbol = req.has_param("symbol") ? req.get_param_value("symbol") : "";
+        std::size_t cancelled = engine_->cancelAllForAccount(req.get_param_value("account"), symbol);
+        Logger::info("Mass cancel for account " + req.get_param_value("account") + ": " +
+                     std::to_string(cancelled) + " orders");
+        res.status = 200;
+        res.set_content(nlohmann::json{{"cancelled", cancelled}}.dump(), "application/json");
+    });
+
+    // Lock-free top of book; never contends with matching
+    svr_->Get("/bbo", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        auto book = engine_->getBook(req.get_param_value("symbol"));
+        if (!book) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown symbol\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(book->getTopOfBookJSON(), "application/json");
+    });
+
+    // Call auction: indicative uncross (lock-free), start a call, and uncross
+    svr_->Get("/auction", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        auto book = engine_->getBook(req.get_param_value("symbol"));
+        if (!book) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown symbol\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(book->getAuctionStateJSON(), "application/json");
+    });
+
+    svr_->Post("/auction/start", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!req.has_param("symbol") || req.get_param_value("symbol").empty()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        const std::string symbol = req.get_param_value("symbol");
+        engine_->startAuction(symbol);
+        Logger::info("Call auction started for " + symbol);
+        res.status = 200;
+        res.set_content(engine_->getBook(symbol)->getAuctionStateJSON(), "application/json");
+    });
+
+    svr_->Post("/auction/uncross", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        const std::string symbol = req.get_param_value("symbol");
+        auto trades = engine_->uncross(symbol);
+        double volume = 0.0;
+        for (const auto& trade : trades) volume += trade.quantity;
+        Logger::info("Uncrossed " + symbol + ": " + std::to_string(trades.size()) + " trades, volume " +
+                     std::to_string(volume));
+        res.status = 200;
+        res.set_content(nlohmann::json{{"symbol", symbol}, {"trades", trades.size()}, {"volume", volume},
+                                       {"price", trades.empty() ? 0.0 : trades.front().price}}.dump(),
+                        "application/json");
+    });
+
+    // Recent trades from the symbol's tape; `since` is the last sequence the caller has seen
+    svr_->Get("/trades", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        uint64_t since = 0;
+        std::size_t limit = kDefaultTradesLimit;
+        try {
+            if (req.has_param("since")) since = std::stoull(req.get_param_value("since"));
+            if (req.has_param("limit")) limit = std::min<std::size_t>(std::stoul(req.get_param_value("limit")), TradeTape::kCapacity);
+        } catch (const std::exception&) {
+            res.status = 400;
+            res.set_content("{\"error\":\"'since' and 'limit' must be non-negative integers\"}", "application/json");
+            return;
+        }
+        auto book = engine_->getBook(req.get_param_value("symbol"));
+        if (!book) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown symbol\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(book->getRecentTradesJSON(since, limit), "application/json");
+    });
+
+    // OHLCV/VWAP bars, oldest first
+    svr_->Get("/bars", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!bars_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Bars are not enabled\"}", "application/json");
+            return;
+        }
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        BarAggregator::Interval interval = BarAggregator::Interval::MIN_1;
+        if (req.has_param("interval") && !BarAggregator::parseInterval(req.get_param_value("interval"), interval)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Invalid 'interval' (must be 1s, 1m or 5m)\"}", "application/json");
+            return;
+        }
+        std::size_t limit = BarAggregator::kHistory;
+        try {
+            if (req.has_param("limit")) limit = std::min<std::size_t>(std::stoul(req.get_param_value("limit")), limit);
+        } catch (const std::exception&) {
+            res.status = 400;
+            res.set_content("{\"error\":\"'limit' must be a non-negative integer\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(bars_->getBarsJSON(req.get_param_value("symbol"), interval, limit), "application/json");
+    });
+
+    // Every resting order for L3 late joiners, aligned with the bus sequence
+    svr_->Get("/l3", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!md_bus_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"L3 market data is not enabled\"}", "application/json");
+            return;
+        }
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(md_bus_->getL3SnapshotJSON(req.get_param_value("symbol")), "application/json");
+    });
+
+    // Order status and book queries below read the replica, never a live book
+    svr_->Get(R"(/orders/(\d{1,19}))", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        ReadReplica::OrderStatus status;
+        if (!replica_ || !replica_->getOrder(std::stoull(req.matches[1].str()), status)) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown order\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(status.toJSON(), "application/json");
+    });
+
+    svr_->Get("/depth", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!replica_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Read replica is not enabled\"}", "application/json");
+            return;
+        }
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        int levels = kDefaultDepthLevels;
+        try {
+            if (req.has_param("levels")) levels = std::stoi(req.get_param_value("levels"));
+        } catch (const std::exception&) {
+            levels = -1;
+        }
+        if (levels < 0) {
+            res.status = 400;
+            res.set_content("{\"error\":\"'levels' must be a non-negative integer\"}", "application/json");
+            return;
+        }
+        std::string depth = replica_->getMarketDepth(req.get_param_value("symbol"), levels);
+        if (depth.empty()) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown symbol\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(depth, "application/json");
+    });
+
+    svr_->Get("/snapshot", [this](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!replica_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Read replica is not enabled\"}", "application/json");
+            return;
+        }
+        if (!req.has_param("symbol")) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'symbol' query parameter\"}", "application/json");
+            return;
+        }
+        std::string snapshot = replica_->getSnapshot(req.get_param_value("symbol"));
+        if (snapshot.empty()) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown symbol\"}", "application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(snapshot, "application/json");
+    });
+
+    svr_->Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
+        std::vector<Metrics::BookSample> books;
+        for (const auto& entry : engine_->getBookStats()) {
+            const auto& stats = entry.second;
+            books.push_back({entry.first, stats.resting_orders, stats.bid_levels,
+                             stats.ask_levels, stats.memory_bytes});
+        }
+        res.status = 200;
+        res.set_content(Metrics::render(books), "text/plain; version=0.0.4");
+    });
+
+    // Per-account risk limits; only with a risk manager and an admin token
+    if (!risk_ || config_.admin_token.empty()) return;
+    auto account_of = [this](const httplib::Request& req, httplib::Response& res, std::string& account) {
+        if (!authorized(req, config_.admin_token)) {
+            res.status = 401;
+            res.set_content("{\"error\":\"Unauthorized\"}", "application/json");
+            return false;
+        }
+        if (!req.has_param("account") || req.get_param_value("account").empty()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Missing 'account' query parameter\"}", "application/json");
+            return false;
+        }
+        account = req.get_param_value("account");
+        return true;
+    };
+
+    svr_->Get("/admin/risk", [this, account_of](const httplib::Request& req, httplib::Response& res) {
+        std::string account;
+        if (!account_of(req, res, account)) return;
+        res.status = 200;
+        res.set_content(limitsJSON(account, risk_->getLimits(account)).dump(), "application/json");
+    });
+
+    // Fields left out keep their current value; zero turns a limit off
+    svr_->Put("/admin/risk", [this, account_of](const httplib::Request& req, httplib::Response& res) {
+        std::string account;
+        if (!account_of(req, res, account)) return;
+        RiskLimits limits = risk_->getLimits(account);
+        try {
+            auto body = nlohmann::json::parse(req.body);
+            auto field = [&body](const char* name, auto& value) {
+                if (!body.contains(name)) return;
+                auto parsed = body.at(name).get<std::remove_reference_t<decltype(value)>>();
+                if (body.at(name).get<double>() < 0.0) throw std::invalid_argument(std::string(name) + " must not be negative");
+                value = parsed;
+            };
+            field("max_order_quantity", limits.max_order_quantity);
+            field("max_order_notional", limits.max_order_notional);
+            field("max_open_orders", limits.max_open_orders);
+            field("max_position", limits.max_position);
+            field("price_band", limits.price_band);
+        } catch (const std::exception& ex) {
+            res.status = 400;
+            res.set_content(nlohmann::json{{"error", ex.what()}}.dump(), "application/json");
+            return;
+        }
+        risk_->setLimits(account, limits);
+        Logger::info("Risk limits updated for account " + account);
+        res.status = 200;
+        res.set_content(limitsJSON(account, limits).dump(), "application/json");
+    });
+}
@@ -3,20 +3,58 @@
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <ctime>
 #include "../core/MatchingEngine.h"
+#include "../core/BarAggregator.h"
+#include "../core/ReadReplica.h"
+#include "MarketDataBus.h"
+
+namespace httplib { class Server; }
+
+// HTTP gateway tuning. Zero means "derive a default" where noted.
+struct RestServerConfig {
+    std::size_t worker_threads = 0;          // 0 = one per hardware core
+    std::size_t max_queued_requests = 1024;  // accepted connections waiting for a worker
+    std::size_t max_inflight_orders = 0;     // 0 = worker_threads - 1 (min 1); beyond this orders get 503
+    std::size_t max_queue_wait_ms = 100;     // an order whose connection waited longer for a worker gets 503
+    std::size_t keep_alive_max_count = 1000; // requests served per connection before closing
+    time_t keep_alive_timeout_sec = 5;
+    time_t read_timeout_sec = 5;
+    time_t write_timeout_sec = 5;
+    std::size_t payload_max_bytes = 64 * 1024;
+    std::string admin_token;                 // Bearer token for /admin/*; empty leaves them off
+};
 
 class RestServer {
 public:
     RestServer(std::shared_ptr<MatchingEngine> engine, int port = 8080);
+    RestServer(std::shared_ptr<MatchingEngine> engine, int port, const RestServerConfig& config);
     ~RestServer();
     
     void start();
+    // Enables GET /bars; call before start()
+    void setBarAggregator(std::shared_ptr<BarAggregator> bars);
+    // Enables GET /l3, the order-level snapshot; call before start()
+    void setMarketDataBus(std::shared_ptr<MarketDataBus> bus);
+    // Enables GET /orders/{id}, /depth and /snapshot; call before start()
+    void setReadReplica(std::shared_ptr<ReadReplica> replica);
+    // Enables GET and PUT /admin/risk, per-account limits; needs admin_token.
+    // Call before start().
+    void setRiskManager(std::shared_ptr<RiskManager> risk);
+    // Stops accepting, lets in-flight requests finish, then joins the listener
     void stop();
     
 private:
     std::shared_ptr<MatchingEngine> engine_;
+    std::shared_ptr<BarAggregator> bars_;
+    std::shared_ptr<MarketDataBus> md_bus_;
+    std::shared_ptr<ReadReplica> replica_;
+    std::shared_ptr<RiskManager> risk_;
     int port_;
+    RestServerConfig config_;
     std::atomic<bool> running_;
+    std::atomic<std::size_t> inflight_orders_{0};
+    std::unique_ptr<httplib::Server> svr_;
     std::thread server_thread_;
     void registerHandlers();
-}; 
\ No newline at end of file
+}; 
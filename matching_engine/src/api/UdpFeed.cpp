@@ -0,0 +1,351 @@
+#include "UdpFeed.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/multicast.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include "../utils/Logger.h"
+#include "../utils/Utils.h"
+
+using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
+
+namespace {
+    void putRequest(char* out, uint64_t sequence, uint32_t count) {
+        std::memcpy(out, &sequence, sizeof(sequence));
+        std::memcpy(out + sizeof(sequence), &count, sizeof(count));
+    }
+
+    void getRequest(const char* in, uint64_t& sequence, uint32_t& count) {
+        std::memcpy(&sequence, in, sizeof(sequence));
+        std::memcpy(&count, in + sizeof(sequence), sizeof(count));
+    }
+}
+
+UdpFeedPublisher::UdpFeedPublisher(const std::vector<FeedLine>& lines, int retransmit_port, std::size_t history,
+                                   int64_t heartbeat_us)
+    : heartbeat_us_(heartbeat_us),
+      udp_(io_),
+      acceptor_(io_, tcp::endpoint(tcp::v4(), static_cast<unsigned short>(retransmit_port))),
+      heartbeat_(io_),
+      history_(Utils::roundUpToPowerOfTwo(std::max<std::size_t>(history, 2))),
+      mask_(history_.size() - 1) {
+    udp_.open(udp::v4());
+    // Never park the publisher, and with it the market data bus, on a full buffer
+    udp_.non_blocking(true);
+    for (const auto& line : lines) {
+        auto address = boost::asio::ip::make_address(line.address);
+        if (address.is_multicast()) {
+            // Stay on the local network segment, and reach subscribers on this host too
+            udp_.set_option(boost::asio::ip::multicast::hops(1));
+            udp_.set_option(boost::asio::ip::multicast::enable_loopback(true));
+        }
+        lines_.emplace_back(address, static_cast<unsigned short>(line.port));
+    }
+}
+
+UdpFeedPublisher::~UdpFeedPublisher() {
+    stop();
+}
+
+void UdpFeedPublisher::start() {
+    if (thread_.joinable()) return;
+    acceptNext();
+    armHeartbeat();
+    thread_ = std::thread([this]() { io_.run(); });
+}
+
+void UdpFeedPublisher::stop() {
+    io_.stop();
+    if (thread_.joinable()) thread_.join();
+    boost::system::error_code ec;
+    acceptor_.close(ec);
+}
+
+int UdpFeedPublisher::retransmitPort() const {
+    return acceptor_.local_endpoint().port();
+}
+
+void UdpFeedPublisher::publish(uint64_t sequence, const MarketDataMessage& message) {
+    FeedPacket packet{sequence, message};
+    std::lock_guard<std::mutex> lock(mtx_);
+    history_[sequence & mask_] = packet;
+    last_ = sequence;
+    sent_since_heartbeat_ = true;
+    send(packet);
+}
+
+uint64_t UdpFeedPublisher::lastSequence() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return last_;
+}
+
+uint64_t UdpFeedPublisher::droppedDatagrams() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return dropped_;
+}
+
+void UdpFeedPublisher::send(const FeedPacket& packet) {
+    // A full socket buffer drops the datagram like the network would; the
+    // subscriber recovers it from the history
+    boost::system::error_code ec;
+    for (const auto& line : lines_) {
+        udp_.send_to(boost::asio::buffer(&packet, sizeof(packet)), line, 0, ec);
+        if (ec == boost::asio::error::would_block) ++dropped_;
+    }
+}
+
+void UdpFeedPublisher::armHeartbeat() {
+    heartbeat_.expires_after(std::chrono::microseconds(heartbeat_us_));
+    heartbeat_.async_wait([this](const boost::system::error_code& ec) {
+        if (ec) return;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!sent_since_heartbeat_) {
+                FeedPacket packet;
+                std::memset(static_cast<void*>(&packet), 0, sizeof(packet));
+                packet.sequence = last_;
+                packet.message.type = MarketDataMessage::Type::HEARTBEAT;
+                send(packet);
+            }
+            sent_since_heartbeat_ = false;
+        }
+        armHeartbeat();
+    });
+}
+
+void UdpFeedPublisher::acceptNext() {
+    auto socket = std::make_shared<Socket>(io_);
+    acceptor_.async_accept(*socket, [this, socket](const boost::system::error_code& ec) {
+        if (ec) return; // Acceptor closed
+        socket->set_option(tcp::no_delay(true));
+        serve(socket);
+        acceptNext();
+    });
+}
+
+void UdpFeedPublisher::serve(std::shared_ptr<Socket> socket) {
+    auto request = std::make_shared<std::array<char, kRequestSize>>();
+    boost::asio::async_read(*socket, boost::asio::buffer(*request),
+                            [this, socket, request](const boost::system::error_code& ec, std::size_t) {
+        if (ec) return; // Subscriber went away
+        uint64_t from;
+        uint32_t count;
+        getRequest(request->data(), from, count);
+        auto reply = std::make_shared<std::string>();
+        retransmit(from, count, *reply);
+        boost::asio::async_write(*socket, boost::asio::buffer(*reply),
+                                 [this, socket, reply](const boost::system::error_code& ec, std::size_t) {
+            if (!ec) serve(socket);
+        });
+    });
+}
+
+void UdpFeedPublisher::retransmit(uint64_t from, uint32_t count, std::string& out) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const uint64_t oldest = last_ > history_.size() ? last_ - history_.size() + 1 : 1;
+    const uint64_t first = std::max<uint64_t>(from, oldest);
+    count = std::min(count, kMaxRetransmit);
+    uint64_t end = from + count; // One past the last requested
+    if (end < from || end > last_ + 1) end = last_ + 1;
+    uint32_t n = end > first ? static_cast<uint32_t>(end - first) : 0;
+    out.resize(kRequestSize + n * sizeof(FeedPacket));
+    putRequest(&out[0], first, n);
+    for (uint32_t i = 0; i < n; ++i) {
+        std::memcpy(&out[kRequestSize + i * sizeof(FeedPacket)], &history_[(first + i) & mask_], sizeof(FeedPacket));
+    }
+}
+
+UdpFeedSubscriber::UdpFeedSubscriber(const std::vector<FeedLine>& lines, const std::string& retransmit_host,
+                                     int retransmit_port, int64_t gap_timeout_us)
+    : retransmit_host_(retransmit_host),
+      retransmit_port_(retransmit_port),
+      gap_timeout_us_(gap_timeout_us),
+      retransmit_(io_),
+      gap_timer_(io_) {
+    for (const auto& line : lines) {
+        auto receiver = std::make_unique<Receiver>(io_);
+        auto address = boost::asio::ip::make_address(line.address);
+        auto port = static_cast<unsigned short>(line.port);
+        receiver->socket.open(udp::v4());
+        receiver->socket.set_option(udp::socket::reuse_address(true));
+        if (address.is_multicast()) {
+            receiver->socket.bind(udp::endpoint(udp::v4(), port));
+            receiver->socket.set_option(boost::asio::ip::multicast::join_group(address));
+        } else {
+            receiver->socket.bind(udp::endpoint(address, port));
+        }
+        receivers_.push_back(std::move(receiver));
+    }
+}
+
+UdpFeedSubscriber::~UdpFeedSubscriber() {
+    stop();
+}
+
+void UdpFeedSubscriber::setOnMessage(const Callback& callback) {
+    on_message_cb_ = callback;
+}
+
+void UdpFeedSubscriber::start() {
+    if (thread_.joinable()) return;
+    for (auto& receiver : receivers_) receive(*receiver);
+    thread_ = std::thread([this]() { io_.run(); });
+}
+
+void UdpFeedSubscriber::stop() {
+    io_.stop();
+    if (thread_.joinable()) thread_.join();
+    boost::system::error_code ec;
+    retransmit_.close(ec);
+    for (auto& receiver : receivers_) receiver->socket.close(ec);
+}
+
+uint64_t UdpFeedSubscriber::delivered() const {
+    return delivered_.load(std::memory_order_relaxed);
+}
+
+uint64_t UdpFeedSubscriber::duplicates() const {
+    return duplicates_.load(std::memory_order_relaxed);
+}
+
+uint64_t UdpFeedSubscriber::recovered() const {
+    return recovered_.load(std::memory_order_relaxed);
+}
+
+uint64_t UdpFeedSubscriber::lost() const {
+    return lost_.load(std::memory_order_relaxed);
+}
+
+void UdpFeedSubscriber::receive(Receiver& receiver) {
+    receiver.socket.async_receive_from(boost::asio::buffer(&receiver.packet, sizeof(receiver.packet)), receiver.sender,
+                                       [this, &receiver](const boost::system::error_code& ec, std::size_t size) {
+        if (ec) {
+            if (ec != boost::asio::error::operation_aborted) Logger::err("UDP feed: receive failed: " + ec.message());
+            return;
+        }
+        if (size == sizeof(FeedPacket)) handle(receiver.packet);
+        receive(receiver);
+    });
+}
+
+void UdpFeedSubscriber::handle(const FeedPacket& packet) {
+    if (packet.message.type == MarketDataMessage::Type::HEARTBEAT) {
+        if (next_ == 0) {
+            next_ = packet.sequence + 1;
+            known_last_ = packet.sequence;
+            return;
+        }
+        known_last_ = std::max(known_last_, packet.sequence);
+        if (known_last_ >= next_) armGapTimer();
+        return;
+    }
+    if (next_ == 0) next_ = packet.sequence;
+    known_last_ = std::max(known_last_, packet.sequence);
+    if (packet.sequence < next_ || pending_.count(packet.sequence)) {
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (packet.sequence > next_) {
+        // The other line may still bring the missing ones
+        pending_.emplace(packet.sequence, packet.message);
+        armGapTimer();
+        return;
+    }
+    deliver(packet.sequence, packet.message);
+    drain();
+}
+
+void UdpFeedSubscriber::deliver(uint64_t sequence, const MarketDataMessage& message) {
+    ++next_;
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+    if (on_message_cb_) on_message_cb_(sequence, message);
+}
+
+void UdpFeedSubscriber::drain() {
+    while (!pending_.empty() && pending_.begin()->first <= next_) {
+        auto it = pending_.begin();
+        if (it->first == next_) deliver(it->first, it->second);
+        pending_.erase(it);
+    }
+}
+
+void UdpFeedSubscriber::skipTo(uint64_t sequence) {
+    // Buffered messages inside the skipped range still go out, in order
+    while (next_ < sequence) {
+        if (!pending_.empty() && pending_.begin()->first == next_) {
+            deliver(next_, pending_.begin()->second);
+            pending_.erase(pending_.begin());
+            continue;
+        }
+        uint64_t upto = pending_.empty() ? sequence : std::min(sequence, pending_.begin()->first);
+        lost_.fetch_add(upto - next_, std::memory_order_relaxed);
+        next_ = upto;
+    }
+    drain();
+}
+
+void UdpFeedSubscriber::armGapTimer() {
+    if (gap_timer_armed_) return;
+    gap_timer_armed_ = true;
+    gap_timer_.expires_after(std::chrono::microseconds(gap_timeout_us_));
+    gap_timer_.async_wait([this](const boost::system::error_code& ec) {
+        gap_timer_armed_ = false;
+        if (ec || known_last_ < next_) return;
+        if (!recover()) {
+            // No service to ask: give up on the gap rather than stall the stream
+            skipTo(pending_.empty() ? known_last_ + 1 : pending_.begin()->first);
+        }
+        if (known_last_ >= next_) armGapTimer();
+    });
+}
+
+bool UdpFeedSubscriber::recover() {
+    boost::system::error_code ec;
+    if (!retransmit_.is_open()) {
+        tcp::resolver resolver(io_);
+        auto endpoints = resolver.resolve(retransmit_host_, std::to_string(retransmit_port_), ec);
+        if (!ec) boost::asio::connect(retransmit_, endpoints, ec);
+        if (ec) {
+            Logger::err("UDP feed: cannot reach retransmit service: " + ec.message());
+            retransmit_.close(ec);
+            return false;
+        }
+        retransmit_.set_option(tcp::no_delay(true));
+    }
+    // Up to the first buffered message, or everything announced by a heartbeat
+    uint64_t end = pending_.empty() ? known_last_ + 1 : pending_.begin()->first;
+    uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(end - next_, UdpFeedPublisher::kMaxRetransmit));
+    char header[UdpFeedPublisher::kRequestSize];
+    putRequest(header, next_, count);
+    std::vector<FeedPacket> packets;
+    boost::asio::write(retransmit_, boost::asio::buffer(header), ec);
+    if (!ec) boost::asio::read(retransmit_, boost::asio::buffer(header), ec);
+    uint64_t first = 0;
+    uint32_t n = 0;
+    if (!ec) {
+        getRequest(header, first, n);
+        if (n > UdpFeedPublisher::kMaxRetransmit) ec = boost::asio::error::message_size;
+    }
+    if (!ec) {
+        packets.resize(n);
+        boost::asio::read(retransmit_, boost::asio::buffer(packets), ec);
+    }
+    if (ec) {
+        Logger::err("UDP feed: retransmit failed: " + ec.message());
+        retransmit_.close(ec);
+        return false;
+    }
+    // The publisher no longer has what came before first
+    skipTo(first);
+    for (const auto& packet : packets) {
+        if (packet.sequence != next_) continue;
+        recovered_.fetch_add(1, std::memory_order_relaxed);
+        deliver(packet.sequence, packet.message);
+        drain();
+    }
+    return true;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include "MarketDataRing.h"
+
+// UDP market data. The publisher sends each MarketDataBus message once per
+// line, whatever the number of subscribers: to a multicast group, or to a
+// unicast address such as loopback. Running two lines (A and B) over separate
+// paths lets a subscriber fill a drop on one from the other. Messages both
+// lines missed are fetched over TCP from the publisher's bounded history.
+//
+// Every datagram is one FeedPacket, in host byte order. A retransmit request
+// is [u64 from][u32 count]; the reply is [u64 first][u32 count] followed by
+// count packets, where first > from means the older ones have been dropped.
+struct FeedPacket {
+    uint64_t sequence; // Bus sequence; for a HEARTBEAT, the last one sent
+    MarketDataMessage message;
+};
+static_assert(sizeof(FeedPacket) == 64, "one datagram per cache line");
+
+struct FeedLine {
+    std::string address; // Multicast group or unicast address
+    int port;
+};
+
+class UdpFeedPublisher {
+public:
+    static constexpr std::size_t kRequestSize = 12;
+    static constexpr uint32_t kMaxRetransmit = 4096; // Packets per reply
+
+    // history is rounded up to a power of two. Port 0 serves retransmits on
+    // any free port; see retransmitPort(). A heartbeat goes out on every line
+    // when nothing was sent for heartbeat_us, so tail drops are noticed.
+    UdpFeedPublisher(const std::vector<FeedLine>& lines, int retransmit_port,
+                     std::size_t history = 1 << 16, int64_t heartbeat_us = 100'000);
+    ~UdpFeedPublisher();
+
+    void start();
+    void stop();
+    int retransmitPort() const;
+    // A MarketDataBus sink: sequences must arrive in order, from one thread at a time
+    void publish(uint64_t sequence, const MarketDataMessage& message);
+    uint64_t lastSequence() const;
+    uint64_t droppedDatagrams() const; // Sends skipped because a socket buffer was full
+
+private:
+    using Socket = boost::asio::ip::tcp::socket;
+
+    int64_t heartbeat_us_;
+    boost::asio::io_context io_;
+    boost::asio::ip::udp::socket udp_;
+    std::vector<boost::asio::ip::udp::endpoint> lines_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::steady_timer heartbeat_;
+    std::thread thread_;
+
+    // Guards the UDP socket, shared with heartbeats, and the history
+    mutable std::mutex mtx_;
+    std::vector<FeedPacket> history_;
+    uint64_t mask_;
+    uint64_t last_ = 0;
+    uint64_t dropped_ = 0;
+    bool sent_since_heartbeat_ = false;
+
+    void send(const FeedPacket& packet);
+    void armHeartbeat();
+    void acceptNext();
+    void serve(std::shared_ptr<Socket> socket);
+    // Appends the reply to a retransmit request to out
+    void retransmit(uint64_t from, uint32_t count, std::string& out) const;
+};
+
+// Reference subscriber: arbitrates the lines and recovers gaps, delivering
+// every message once and in sequence order. Starts at the first packet seen.
+class UdpFeedSubscriber {
+public:
+    using Callback = std::function<void(uint64_t sequence, const MarketDataMessage& message)>;
+
+    // A gap the other line has not filled within gap_timeout_us is
+    // requested from the retransmit service
+    UdpFeedSubscriber(const std::vector<FeedLine>& lines, const std::string& retransmit_host, int retransmit_port,
+                      int64_t gap_timeout_us = 2'000);
+    ~UdpFeedSubscriber();
+
+    // Called on the subscriber's thread; set before start()
+    void setOnMessage(const Callback& callback);
+    void start();
+    void stop();
+    uint64_t delivered() const;
+    uint64_t duplicates() const; // Copies from the redundant line, mostly
+    uint64_t recovered() const;  // Fetched from the retransmit service
+    uint64_t lost() const;       // Older than the publisher's history, or unrecoverable
+
+private:
+    struct Receiver {
+        boost::asio::ip::udp::socket socket;
+        boost::asio::ip::udp::endpoint sender;
+        FeedPacket packet;
+        explicit Receiver(boost::asio::io_context& io) : socket(io) {}
+    };
+
+    std::string retransmit_host_;
+    int retransmit_port_;
+    int64_t gap_timeout_us_;
+    boost::asio::io_context io_;
+    std::vector<std::unique_ptr<Receiver>> receivers_;
+    boost::asio::ip::tcp::socket retransmit_;
+    boost::asio::steady_timer gap_timer_;
+    std::thread thread_;
+    Callback on_message_cb_;
+
+    // Subscriber thread only
+    uint64_t next_ = 0;      // Next sequence to deliver; 0 until the first packet
+    uint64_t known_last_ = 0; // Highest sequence known to exist
+    std::map<uint64_t, MarketDataMessage> pending_; // Arrived ahead of a gap
+    bool gap_timer_armed_ = false;
+
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> recovered_{0};
+    std::atomic<uint64_t> lost_{0};
+
+    void receive(Receiver& receiver);
+    void handle(const FeedPacket& packet);
+    void deliver(uint64_t sequence, const MarketDataMessage& message);
+    // Delivers buffered messages that are now in sequence
+    void drain();
+    void skipTo(uint64_t sequence);
+    void armGapTimer();
+    bool recover();
+};
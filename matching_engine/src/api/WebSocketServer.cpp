@@ -3,16 +3,21 @@
 #include <sstream> // Required for std::ostringstream
 #include <iostream>
 #include <thread>
+#include <algorithm>
+#include <boost/asio/post.hpp>
 #include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/Utils.h"
+#include "OrderRequest.h"
 
 using json = nlohmann::json;
 using namespace std::placeholders;
 
-WebSocketServer::WebSocketServer(std::shared_ptr<MatchingEngine> engine, uint16_t port)
+WebSocketServer::WebSocketServer(std::shared_ptr<MatchingEngine> engine, uint16_t port, std::size_t io_threads)
     : engine_(engine)
     , port_(port)
     , running_(false)
-    , strand_(std::make_shared<Strand>(io_context_.get_executor()))
+    , io_thread_count_(io_threads ? io_threads : std::max(1u, std::thread::hardware_concurrency()))
 {
     setupServer();
 }
@@ -23,8 +28,9 @@ WebSocketServer::~WebSocketServer() {
 
 void WebSocketServer::setupServer() {
     try {
-        // Initialize ASIO
-        server_.init_asio();
+        // Run the endpoint on our own io_context so a pool of threads can drive it
+        server_.init_asio(&io_context_);
+        server_.set_reuse_addr(true);
 
         // Register handlers
         registerHandlers();
@@ -63,23 +69,24 @@ void WebSocketServer::start() {
     if (!running_) {
         running_ = true;
         try {
-            // Start the server in a separate thread
-            std::thread server_thread([this]() {
-                try {
-                    server_.run();
-                } catch (const std::exception& e) {
-                    // Manually format the string for Logger::err
-                    std::ostringstream oss;
-                    oss << "Server error: " << e.what();
-                    Logger::err(oss.str());
-                    running_ = false;
-                }
-            });
-            server_thread.detach();
+            io_threads_.reserve(io_thread_count_);
+            for (std::size_t i = 0; i < io_thread_count_; ++i) {
+                io_threads_.emplace_back([this]() {
+                    try {
+                        io_context_.run();
+                    } catch (const std::exception& e) {
+                        // Manually format the string for Logger::err
+                        std::ostringstream oss;
+                        oss << "Server error: " << e.what();
+                        Logger::err(oss.str());
+                        running_ = false;
+                    }
+                });
+            }
 
             // Manually format the string for Logger::info
             std::ostringstream oss;
-            oss << "WebSocket server started on port " << port_;
+            oss << "WebSocket server started on port " << port_ << " with " << io_thread_count_ << " I/O threads";
             Logger::info(oss.str());
         } catch (const std::exception& e) {
             // Manually format the string for Logger::err
@@ -95,8 +102,32 @@ void WebSocketServer::start() {
 void WebSocketServer::stop() {
     if (running_) {
         running_ = false;
-        server_.stop_listening();
-        server_.stop();
+        websocketpp::lib::error_code ec;
+        server_.stop_listening(ec);
+
+        // Close sessions cleanly, then give the I/O threads a moment to flush close frames
+        std::vector<ConnectionHandle> open;
+        {
+            std::shared_lock<std::shared_mutex> lock(connections_mutex_);
+            for (const auto& conn : connections_) open.push_back(conn.first);
+        }
+        for (auto& hdl : open) {
+            server_.close(hdl, websocketpp::close::status::going_away, "Server shutting down", ec);
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                std::shared_lock<std::shared_mutex> lock(connections_mutex_);
+                if (connections_.empty()) break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        io_context_.stop();
+        for (auto& t : io_threads_) {
+            if (t.joinable()) t.join();
+        }
+        io_threads_.clear();
         Logger::info("WebSocket server stopped"); // This one already passes a single string
     }
 }
@@ -106,22 +137,247 @@ void WebSocketServer::setMessageHandler(MessageHandler handler) {
 }
 
 void WebSocketServer::broadcast(const std::string& message) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
+    std::shared_lock<std::shared_mutex> lock(connections_mutex_);
+    int64_t buffered = 0;
     for (const auto& conn : connections_) {
-        try {
-            server_.send(conn.first, message, websocketpp::frame::opcode::text);
-        } catch (const std::exception& e) {
-            // Manually format the string for Logger::err
-            std::ostringstream oss;
-            oss << "Error broadcasting message: " << e.what();
-            Logger::err(oss.str());
+        websocketpp::lib::error_code ec;
+        auto con = server_.get_con_from_hdl(conn.first, ec);
+        if (ec) {
+            Metrics::increment(Metrics::Counter::MARKET_DATA_DROPPED);
+            continue;
+        }
+        // Drop rather than queue without bound for consumers that cannot keep up
+        if (con->get_buffered_amount() > kMaxSendBufferBytes) {
+            Metrics::increment(Metrics::Counter::MARKET_DATA_DROPPED);
+            buffered += static_cast<int64_t>(con->get_buffered_amount());
+            continue;
+        }
+        if (con->send(message, websocketpp::frame::opcode::text)) {
+            Metrics::increment(Metrics::Counter::MARKET_DATA_DROPPED);
+        }
+        buffered += static_cast<int64_t>(con->get_buffered_amount());
+    }
+    Metrics::setGauge(Metrics::Gauge::WS_SEND_QUEUE_BYTES, buffered);
+}
+
+void WebSocketServer::publish(const std::string& key, const std::string& message) {
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    auto it = channel_subscribers_.find(key);
+    if (it == channel_subscribers_.end()) return;
+    for (const auto& hdl : it->second) {
+        websocketpp::lib::error_code ec;
+        auto con = server_.get_con_from_hdl(hdl, ec);
+        if (ec || con->get_buffered_amount() > kMaxSendBufferBytes ||
+            con->send(message, websocketpp::frame::opcode::text)) {
+            Metrics::increment(Metrics::Counter::MARKET_DATA_DROPPED);
+        }
+    }
+}
+
+void WebSocketServer::broadcastTrade(const Trade& trade) {
+    // Trade::toJSON() yields an object; splice the message type in front
+    std::string body = trade.toJSON();
+    publish("trades:" + trade.symbol, "{\"type\":\"trade\"," + body.substr(1));
+}
+
+void WebSocketServer::setBarAggregator(std::shared_ptr<BarAggregator> bars) {
+    bars_ = std::move(bars);
+}
+
+void WebSocketServer::setReadReplica(std::shared_ptr<ReadReplica> replica) {
+    replica_ = std::move(replica);
+}
+
+namespace {
+    std::string barsMessage(const BarAggregator& bars, const std::string& symbol) {
+        std::string out = "{\"type\":\"bars\",\"symbol\":" + json(symbol).dump() + ",\"bars\":[";
+        bool first = true;
+        for (const auto& entry : bars.getCurrentBars(symbol)) {
+            if (!first) out += ',';
+            out += entry.second.toJSON(symbol, entry.first);
+            first = false;
+        }
+        out += "]}";
+        return out;
+    }
+}
+
+void WebSocketServer::broadcastBars(const std::string& symbol) {
+    if (!bars_) return;
+    const std::string key = "bars:" + symbol;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        if (channel_subscribers_.find(key) == channel_subscribers_.end()) return;
+    }
+    publish(key, barsMessage(*bars_, symbol));
+}
+
+void WebSocketServer::broadcastMarketData(const std::string& symbol) {
+    const std::string depth_key = "depth:" + symbol;
+    const std::string bbo_key = "bbo:" + symbol;
+    const std::string auction_key = "auction:" + symbol;
+    bool want_depth, want_bbo, want_auction;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        want_depth = channel_subscribers_.count(depth_key) > 0;
+        want_bbo = channel_subscribers_.count(bbo_key) > 0;
+        want_auction = channel_subscribers_.count(auction_key) > 0;
+    }
+    if (!want_depth && !want_bbo && !want_auction) return;
+    auto book = engine_->getBook(symbol);
+    if (!book) return;
+
+    if (want_auction) {
+        // Indicative uncross, only when it moved (including the call ending)
+        uint64_t sequence = book->getAuctionState().sequence;
+        bool changed;
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            uint64_t& last = last_auction_sequence_[symbol];
+            changed = sequence != last;
+            last = sequence;
+        }
+        if (changed) {
+            publish(auction_key, "{\"type\":\"auction\"," + book->getAuctionStateJSON().substr(1));
+        }
+    }
+
+    if (want_bbo) {
+        // Only send when the top of book actually moved
+        uint64_t sequence = book->getTopOfBook().sequence;
+        bool changed;
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            uint64_t& last = last_bbo_sequence_[symbol];
+            changed = sequence != last;
+            last = sequence;
+        }
+        if (changed) {
+            publish(bbo_key, "{\"type\":\"bbo\"," + book->getTopOfBookJSON().substr(1));
         }
     }
+    if (want_depth) {
+        std::string depth = book->getMarketDepth(kDepthLevels);
+        publish(depth_key, "{\"type\":\"l2update\"," + depth.substr(1));
+    }
+}
+
+bool WebSocketServer::validateSubscriptionMessage(const json& msg, std::string& error) {
+    if (!msg.contains("symbol") || !msg["symbol"].is_string()) {
+        error = "Missing or invalid 'symbol' (string)";
+        return false;
+    }
+    if (msg.contains("channels")) {
+        if (!msg["channels"].is_array()) {
+            error = "'channels' must be an array";
+            return false;
+        }
+        for (const auto& c : msg["channels"]) {
+            if (!c.is_string() || (c != "trades" && c != "depth" && c != "bbo" && c != "bars" && c != "auction")) {
+                error = "Unknown channel (must be trades, depth, bbo, bars or auction)";
+                return false;
+            }
+        }
+    }
+    if (msg.contains("since") && !msg["since"].is_number_unsigned()) {
+        error = "'since' must be a trade sequence number";
+        return false;
+    }
+    return true;
+}
+
+namespace {
+    std::vector<std::string> requestedChannels(const json& msg) {
+        if (!msg.contains("channels")) return {"trades", "depth"};
+        return msg["channels"].get<std::vector<std::string>>();
+    }
+}
+
+void WebSocketServer::handleSubscription(ConnectionHandle hdl, const json& msg) {
+    std::string error;
+    if (!validateSubscriptionMessage(msg, error)) {
+        sendError(hdl, error);
+        return;
+    }
+    const std::string symbol = msg["symbol"].get<std::string>();
+    auto channels = requestedChannels(msg);
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        auto& keys = subscriptions_[hdl];
+        for (const auto& channel : channels) {
+            std::string key = channel + ":" + symbol;
+            if (keys.insert(key).second) {
+                channel_subscribers_[key].insert(hdl);
+                Metrics::addGauge(Metrics::Gauge::WS_SUBSCRIBERS, 1);
+            }
+        }
+    }
+    sendToConnection(hdl, json{{"type", "subscribed"}, {"symbol", symbol}, {"channels", channels}}.dump());
+
+    // Initial images go to the new subscriber only
+    if (bars_ && std::find(channels.begin(), channels.end(), "bars") != channels.end()) {
+        sendToConnection(hdl, barsMessage(*bars_, symbol));
+    }
+    auto book = engine_->getBook(symbol);
+    if (!book) return;
+    for (const auto& channel : channels) {
+        if (channel == "bbo") {
+            sendToConnection(hdl, "{\"type\":\"bbo\"," + book->getTopOfBookJSON().substr(1));
+        } else if (channel == "auction") {
+            sendToConnection(hdl, "{\"type\":\"auction\"," + book->getAuctionStateJSON().substr(1));
+        } else if (channel == "depth") {
+            // Off the replica, so a burst of subscribers never takes the book
+            // lock; empty until a first order has rested there
+            std::string depth = replica_ ? replica_->getMarketDepth(symbol, kDepthLevels)
+                                         : book->getMarketDepth(kDepthLevels);
+            if (!depth.empty()) sendToConnection(hdl, "{\"type\":\"l2update\"," + depth.substr(1));
+        } else if (channel == "trades" && msg.contains("since")) {
+            // Catch up from the tape. Live trades may interleave; clients
+            // drop any sequence they have already seen.
+            for (const auto& entry : book->getTradeTape().since(msg["since"].get<uint64_t>())) {
+                sendToConnection(hdl, "{\"type\":\"trade\"," + entry.toJSON(symbol).substr(1));
+            }
+        }
+    }
+}
+
+void WebSocketServer::handleUnsubscription(ConnectionHandle hdl, const json& msg) {
+    std::string error;
+    if (!validateSubscriptionMessage(msg, error)) {
+        sendError(hdl, error);
+        return;
+    }
+    const std::string symbol = msg["symbol"].get<std::string>();
+    auto channels = requestedChannels(msg);
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        auto it = subscriptions_.find(hdl);
+        if (it != subscriptions_.end()) {
+            for (const auto& channel : channels) {
+                std::string key = channel + ":" + symbol;
+                if (it->second.erase(key)) {
+                    auto subs = channel_subscribers_.find(key);
+                    if (subs != channel_subscribers_.end()) {
+                        subs->second.erase(hdl);
+                        if (subs->second.empty()) channel_subscribers_.erase(subs);
+                    }
+                    Metrics::addGauge(Metrics::Gauge::WS_SUBSCRIBERS, -1);
+                }
+            }
+        }
+    }
+    sendToConnection(hdl, json{{"type", "unsubscribed"}, {"symbol", symbol}, {"channels", channels}}.dump());
 }
 
 void WebSocketServer::onOpen(ConnectionHandle hdl) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    connections_[hdl] = std::make_shared<Strand>(io_context_.get_executor());
+    auto session = std::make_shared<Session>();
+    session->id = next_session_id_.fetch_add(1);
+    session->hdl = hdl;
+    session->strand = std::make_shared<Strand>(io_context_.get_executor());
+
+    std::unique_lock<std::shared_mutex> lock(connections_mutex_);
+    connections_[hdl] = session;
+    Metrics::setGauge(Metrics::Gauge::WS_CONNECTIONS, static_cast<int64_t>(connections_.size()));
     Logger::info("New WebSocket connection established"); // This one already passes a single string
 }
 
@@ -131,16 +387,384 @@ void WebSocketServer::onClose(ConnectionHandle hdl) {
 }
 
 void WebSocketServer::onMessage(ConnectionHandle hdl, MessagePtr msg) {
-    if (message_handler_) {
+    auto session = getSession(hdl);
+    if (!session) return;
+    // Hand off to the connection's strand: messages from one client are
+    // processed in order while other connections proceed on other threads
+    boost::asio::post(*session->strand, [this, session, msg]() {
         try {
-            message_handler_(hdl, msg->get_payload());
+            if (message_handler_) {
+                message_handler_(session->hdl, msg->get_payload());
+            } else {
+                handleMessage(session, msg->get_payload());
+            }
         } catch (const std::exception& e) {
             // Manually format the string for Logger::err
             std::ostringstream oss;
             oss << "Error handling message: " << e.what();
             Logger::err(oss.str());
-            sendError(hdl, "Error processing message");
+            sendError(session->hdl, "Error processing message");
         }
+    });
+}
+
+std::shared_ptr<WebSocketServer::Session> WebSocketServer::getSession(ConnectionHandle hdl) {
+    std::shared_lock<std::shared_mutex> lock(connections_mutex_);
+    auto it = connections_.find(hdl);
+    return it == connections_.end() ? nullptr : it->second;
+}
+
+void WebSocketServer::handleMessage(const std::shared_ptr<Session>& session, const std::string& payload) {
+    json msg = json::parse(payload, nullptr, false);
+    if (msg.is_discarded() || !msg.contains("type") || !msg["type"].is_string()) {
+        sendError(session->hdl, "Invalid message: expected a JSON object with a 'type'");
+        return;
+    }
+    const std::string& type = msg["type"].get_ref<const std::string&>();
+    if (type == "order") {
+        handleOrder(session, msg);
+    } else if (type == "cancel") {
+        handleCancel(session, msg);
+    } else if (type == "quote") {
+        handleQuote(session, msg);
+    } else if (type == "cancel_all") {
+        handleCancelAll(session, msg);
+    } else if (type == "session") {
+        handleSessionOptions(session, msg);
+    } else if (type == "subscribe") {
+        handleSubscription(session->hdl, msg);
+    } else if (type == "unsubscribe") {
+        handleUnsubscription(session->hdl, msg);
+    } else {
+        sendError(session->hdl, "Unknown message type '" + type + "'");
+    }
+}
+
+namespace {
+    const char* statusString(Order::Status status) {
+        switch (status) {
+            case Order::Status::NEW:              return "new";
+            case Order::Status::PARTIALLY_FILLED: return "partially_filled";
+            case Order::Status::FILLED:           return "filled";
+            case Order::Status::CANCELLED:        return "cancelled";
+            case Order::Status::REJECTED:         return "rejected";
+        }
+        return "unknown";
+    }
+
+    json fillMessage(const Trade& trade, const std::string& client_order_id, const std::string& order_id,
+                     Order::Side side, const char* liquidity) {
+        return {
+            {"type", "fill"},
+            {"client_order_id", client_order_id},
+            {"order_id", order_id},
+            {"trade_id", trade.trade_id},
+            {"symbol", trade.symbol},
+            {"side", side == Order::Side::BUY ? "buy" : "sell"},
+            {"price", trade.price},
+            {"quantity", trade.quantity},
+            {"liquidity", liquidity},
+            {"timestamp", trade.timestamp}
+        };
+    }
+}
+
+void WebSocketServer::handleOrder(const std::shared_ptr<Session>& session, const json& msg) {
+    Metrics::increment(Metrics::Counter::ORDERS_RECEIVED);
+    OrderRequest request;
+    std::string error;
+    Metrics::RejectReason reason;
+    if (!parseOrderRequest(msg, request, error, reason)) {
+        Metrics::reject(reason);
+        std::string cid = msg.contains("client_order_id") && msg["client_order_id"].is_string()
+            ? msg["client_order_id"].get<std::string>() : "";
+        sendToConnection(session->hdl, json{{"type", "reject"}, {"client_order_id", cid}, {"reason", error}}.dump());
+        return;
+    }
+
+    std::string order_id = "ws" + std::to_string(session->id) + "-" + std::to_string(++session->next_order_seq);
+    const std::string& live_key = request.client_order_id.empty() ? order_id : request.client_order_id;
+    if (session->live_orders.count(live_key)) {
+        Metrics::reject(Metrics::RejectReason::MALFORMED);
+        sendToConnection(session->hdl, json{{"type", "reject"}, {"client_order_id", request.client_order_id},
+                                            {"reason", "Duplicate 'client_order_id'"}}.dump());
+        return;
+    }
+
+    Order order(order_id, request.symbol, request.type, request.order_side,
+                request.quantity, request.price, Utils::getCurrentTimestamp());
+    order.setAccount(request.account);
+    order.setSelfTradePrevention(request.stp);
+    order.setDisplayQuantity(request.display_quantity);
+    order.setStopPrice(request.stop_price);
+    order.setTimeInForce(request.time_in_force, request.expire_time_us);
+    order.setSessionId(session->id);
+
+    // Register before matching: fills are routed from the engine's trade
+    // stream, and once the remainder rests another session can fill it
+    // before processOrder has even returned here
+    {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        order_owners_[order_id] = {session, request.client_order_id, live_key, request.quantity};
+    }
+
+    RiskManager::Reject risk = RiskManager::Reject::NONE;
+    auto trades = engine_->processOrder(order, &risk);
+    if (risk != RiskManager::Reject::NONE) {
+        {
+            std::lock_guard<std::mutex> lock(owners_mutex_);
+            order_owners_.erase(order_id);
+        }
+        Metrics::reject(Metrics::RejectReason::RISK_LIMIT);
+        sendToConnection(session->hdl, json{{"type", "reject"}, {"client_order_id", request.client_order_id},
+                                            {"order_id", order_id}, {"reason", RiskManager::rejectMessage(risk)}}.dump());
+        return;
+    }
+
+    // The engine leaves a rested order NEW or PARTIALLY_FILLED with its
+    // remainder as quantity, and a parked stop NEW; self-trade prevention
+    // may have cancelled or shrunk it without a trade
+    const bool rested = (order.getType() == Order::Type::LIMIT || order.isStop()) &&
+                        (order.getStatus() == Order::Status::NEW ||
+                         order.getStatus() == Order::Status::PARTIALLY_FILLED);
+    double filled = 0.0;
+    for (const auto& t : trades) {
+        if (t.taker_order_id == order_id) filled += t.quantity;
+    }
+    bool resting = false;
+    double leaves = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        auto it = order_owners_.find(order_id);
+        if (it != order_owners_.end()) {
+            // Fills were subtracted as they were routed; take off the rest
+            it->second.remaining -= request.quantity - filled - order.getQuantity();
+            leaves = it->second.remaining;
+            resting = rested && leaves > Utils::kQuantityEpsilon;
+            if (!resting) order_owners_.erase(it);
+        }
+    }
+    if (resting) {
+        session->live_orders[live_key] = {order_id, request.symbol, request.order_side, request.price};
+    }
+
+    const char* status = statusString(order.getStatus());
+    if (!rested && order.getStatus() == Order::Status::NEW) {
+        status = "cancelled"; // Unfilled market/IOC/FOK orders never rest
+    }
+    // Fills were posted to this session's strand and follow the ack
+    sendToConnection(session->hdl, json{
+        {"type", "ack"},
+        {"client_order_id", request.client_order_id},
+        {"order_id", order_id},
+        {"engine_id", order.getEngineId()},
+        {"symbol", request.symbol},
+        {"status", order.isStop() && resting ? "parked" : status},
+        {"leaves_quantity", resting ? leaves : 0.0}
+    }.dump());
+}
+
+void WebSocketServer::routeFills(const Trade& trade) {
+    if (trade.aggressor_side == "none") {
+        // Uncross: the taker fields hold the buyer
+        routeFill(trade, trade.taker_order_id, Order::Side::BUY, "auction");
+        routeFill(trade, trade.maker_order_id, Order::Side::SELL, "auction");
+        return;
+    }
+    Order::Side taker_side = trade.aggressor_side == "buy" ? Order::Side::BUY : Order::Side::SELL;
+    Order::Side maker_side = taker_side == Order::Side::BUY ? Order::Side::SELL : Order::Side::BUY;
+    routeFill(trade, trade.taker_order_id, taker_side, "taker");
+    routeFill(trade, trade.maker_order_id, maker_side, "maker");
+}
+
+void WebSocketServer::routeFill(const Trade& trade, const std::string& order_id, Order::Side side, const char* liquidity) {
+    std::shared_ptr<Session> owner;
+    std::string client_order_id;
+    std::string live_key;
+    bool done = false;
+    {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        auto it = order_owners_.find(order_id);
+        if (it == order_owners_.end()) return; // Order came from REST
+        owner = it->second.session.lock();
+        client_order_id = it->second.client_order_id;
+        live_key = it->second.live_key;
+        it->second.remaining -= trade.quantity;
+        done = it->second.remaining <= Utils::kQuantityEpsilon;
+        if (done || !owner) order_owners_.erase(it);
+    }
+    if (!owner) return;
+
+    std::string payload = fillMessage(trade, client_order_id, order_id, side, liquidity).dump();
+    // Session state belongs to the owner's strand
+    boost::asio::post(*owner->strand, [this, owner, payload, live_key, done]() {
+        if (done) owner->live_orders.erase(live_key);
+        sendToConnection(owner->hdl, payload);
+    });
+}
+
+void WebSocketServer::onOrderReduced(const Order& order) {
+    std::shared_ptr<Session> owner;
+    std::string client_order_id;
+    std::string live_key;
+    bool done = order.getStatus() == Order::Status::CANCELLED;
+    {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        auto it = order_owners_.find(order.getOrderId());
+        if (it == order_owners_.end()) return;
+        owner = it->second.session.lock();
+        client_order_id = it->second.client_order_id;
+        live_key = it->second.live_key;
+        it->second.remaining = std::min(it->second.remaining, order.getLeavesQuantity());
+        if (done || !owner) order_owners_.erase(it);
+    }
+    if (!owner) return;
+
+    std::string payload = json{
+        {"type", done ? "cancelled" : "reduced"},
+        {"client_order_id", client_order_id},
+        {"order_id", order.getOrderId()},
+        {"symbol", order.getSymbol()},
+        {"leaves_quantity", done ? 0.0 : order.getLeavesQuantity()}
+    }.dump();
+    boost::asio::post(*owner->strand, [this, owner, payload, live_key, done]() {
+        if (done) owner->live_orders.erase(live_key);
+        sendToConnection(owner->hdl, payload);
+    });
+}
+
+void WebSocketServer::handleCancel(const std::shared_ptr<Session>& session, const json& msg) {
+    std::string key;
+    if (msg.contains("client_order_id") && msg["client_order_id"].is_string()) {
+        key = msg["client_order_id"].get<std::string>();
+    } else if (msg.contains("order_id") && msg["order_id"].is_string()) {
+        key = msg["order_id"].get<std::string>();
+    }
+
+    json ack = {{"type", "cancel_ack"}, {"client_order_id", key}};
+    auto it = session->live_orders.find(key);
+    if (it == session->live_orders.end()) {
+        ack["status"] = "not_found";
+        sendToConnection(session->hdl, ack.dump());
+        return;
+    }
+    Session::LiveOrder live = it->second;
+    session->live_orders.erase(it);
+
+    bool removed = engine_->cancelOrder(live.symbol, live.order_id, live.side, live.price);
+    if (removed) {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        order_owners_.erase(live.order_id);
+    }
+    ack["order_id"] = live.order_id;
+    ack["status"] = removed ? "cancelled" : "not_found";
+    sendToConnection(session->hdl, ack.dump());
+}
+
+void WebSocketServer::handleCancelAll(const std::shared_ptr<Session>& session, const json& msg) {
+    // This session's orders by default, or everything an account has resting
+    std::string symbol = msg.contains("symbol") && msg["symbol"].is_string() ? msg["symbol"].get<std::string>() : "";
+    std::string account = msg.contains("account") && msg["account"].is_string() ? msg["account"].get<std::string>() : "";
+    std::size_t cancelled = account.empty() ? engine_->cancelAllForSession(session->id, symbol)
+                                            : engine_->cancelAllForAccount(account, symbol);
+    // Per-order "cancelled" messages are queued on this strand and follow
+    sendToConnection(session->hdl, json{{"type", "cancel_all_ack"}, {"symbol", symbol}, {"account", account},
+                                        {"cancelled", cancelled}}.dump());
+}
+
+void WebSocketServer::handleQuote(const std::shared_ptr<Session>& session, const json& msg) {
+    Metrics::increment(Metrics::Counter::QUOTES_RECEIVED);
+    QuoteRequest request;
+    std::string error;
+    Metrics::RejectReason reason;
+    if (!parseQuoteRequest(msg, request, error, reason)) {
+        Metrics::reject(reason);
+        std::string qid = msg.contains("quote_id") && msg["quote_id"].is_string()
+            ? msg["quote_id"].get<std::string>() : "";
+        sendToConnection(session->hdl, json{{"type", "quote_reject"}, {"quote_id", qid}, {"reason", error}}.dump());
+        return;
+    }
+
+    Quote quote;
+    quote.account = request.account;
+    quote.session_id = session->id;
+    quote.timestamp = Utils::getCurrentTimestamp();
+    quote.entries = std::move(request.entries);
+    // Every quoted side gets an id up front; the engine uses it only if the
+    // side enters the book as a new order. Fills carry the quote_id.
+    {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        auto assign = [&](std::string& order_id, double quantity) {
+            if (quantity <= 0) return;
+            order_id = "ws" + std::to_string(session->id) + "-" + std::to_string(++session->next_order_seq);
+            order_owners_[order_id] = {session, request.quote_id, order_id, quantity};
+        };
+        for (auto& entry : quote.entries) {
+            assign(entry.bid_order_id, entry.bid_quantity);
+            assign(entry.ask_order_id, entry.ask_quantity);
+        }
+    }
+
+    std::vector<QuoteResult> results;
+    engine_->processQuote(quote, results);
+
+    json rows = json::array();
+    json rejects = json::array();
+    {
+        std::lock_guard<std::mutex> lock(owners_mutex_);
+        auto settle = [&](const QuoteEntry& entry, Order::Side side, const std::string& assigned,
+                          double price, const QuoteSideResult& result) {
+            if (!result.replaced_order_id.empty()) {
+                order_owners_.erase(result.replaced_order_id);
+                session->live_orders.erase(result.replaced_order_id);
+            }
+            if (!assigned.empty() && assigned != result.order_id) order_owners_.erase(assigned);
+            if (result.reject != RiskManager::Reject::NONE) {
+                rejects.push_back({entry.symbol, side == Order::Side::BUY ? "buy" : "sell",
+                                   RiskManager::rejectMessage(result.reject)});
+            }
+            if (result.order_id.empty()) return json::array({nullptr, 0.0});
+            auto it = order_owners_.find(result.order_id);
+            if (it == order_owners_.end()) return json::array({nullptr, 0.0}); // Filled since
+            // An amended side may have filled since the engine reported it
+            it->second.remaining = std::min(it->second.remaining, result.leaves_quantity);
+            if (it->second.session.lock() == session) {
+                session->live_orders[result.order_id] = {result.order_id, entry.symbol, side, price};
+            }
+            return json::array({result.order_id, it->second.remaining});
+        };
+        for (std::size_t i = 0; i < quote.entries.size(); ++i) {
+            const QuoteEntry& entry = quote.entries[i];
+            json bid = settle(entry, Order::Side::BUY, entry.bid_order_id, entry.bid_price, results[i].bid);
+            json ask = settle(entry, Order::Side::SELL, entry.ask_order_id, entry.ask_price, results[i].ask);
+            rows.push_back({entry.symbol, bid[0], bid[1], ask[0], ask[1]});
+        }
+    }
+
+    // One ack per message: [symbol, bid_order_id, bid_leaves, ask_order_id,
+    // ask_leaves] per row, null where a side is not on the book
+    json ack = {{"type", "quote_ack"}, {"quote_id", request.quote_id}, {"quotes", std::move(rows)}};
+    if (!rejects.empty()) ack["rejects"] = std::move(rejects);
+    sendToConnection(session->hdl, ack.dump());
+}
+
+void WebSocketServer::handleSessionOptions(const std::shared_ptr<Session>& session, const json& msg) {
+    if (msg.contains("cancel_on_disconnect")) {
+        if (!msg["cancel_on_disconnect"].is_boolean()) {
+            sendError(session->hdl, "Invalid 'cancel_on_disconnect' (boolean)");
+            return;
+        }
+        session->cancel_on_disconnect = msg["cancel_on_disconnect"].get<bool>();
+    }
+    sendToConnection(session->hdl, json{{"type", "session_ack"}, {"session_id", session->id},
+                                        {"cancel_on_disconnect", session->cancel_on_disconnect.load()}}.dump());
+}
+
+void WebSocketServer::sendToConnection(ConnectionHandle hdl, const std::string& payload) {
+    websocketpp::lib::error_code ec;
+    server_.send(hdl, payload, websocketpp::frame::opcode::text, ec);
+    if (ec) {
+        Logger::debug("WebSocket send failed: " + ec.message());
     }
 }
 
@@ -150,11 +774,37 @@ void WebSocketServer::onError(ConnectionHandle hdl) {
 }
 
 void WebSocketServer::cleanupConnection(ConnectionHandle hdl) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    connections_.erase(hdl);
-    
+    // Owner entries hold weak session pointers and are dropped lazily on the next fill
+    uint64_t cancel_session = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(connections_mutex_);
+        auto conn = connections_.find(hdl);
+        // onError and onClose may both run; only the first sees the session
+        if (conn != connections_.end()) {
+            if (conn->second->cancel_on_disconnect) cancel_session = conn->second->id;
+            connections_.erase(conn);
+        }
+        Metrics::setGauge(Metrics::Gauge::WS_CONNECTIONS, static_cast<int64_t>(connections_.size()));
+    }
+    if (cancel_session != 0) {
+        std::size_t cancelled = engine_->cancelAllForSession(cancel_session);
+        Logger::info("Cancel on disconnect: " + std::to_string(cancelled) + " orders of session " +
+                     std::to_string(cancel_session));
+    }
+
     std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    subscriptions_.erase(hdl);
+    auto it = subscriptions_.find(hdl);
+    if (it != subscriptions_.end()) {
+        for (const auto& key : it->second) {
+            auto subs = channel_subscribers_.find(key);
+            if (subs != channel_subscribers_.end()) {
+                subs->second.erase(hdl);
+                if (subs->second.empty()) channel_subscribers_.erase(subs);
+            }
+        }
+        Metrics::addGauge(Metrics::Gauge::WS_SUBSCRIBERS, -static_cast<int64_t>(it->second.size()));
+        subscriptions_.erase(it);
+    }
 }
 
 void WebSocketServer::sendError(ConnectionHandle hdl, const std::string& error_msg) {
@@ -171,5 +821,3 @@ void WebSocketServer::sendError(ConnectionHandle hdl, const std::string& error_m
         Logger::err(oss.str());
     }
 }
-
-// ... rest of the implementation ...
\ No newline at end of file
@@ -16,9 +16,14 @@
 #include <nlohmann/json.hpp>
 #include "../core/MatchingEngine.h"
 #include "../core/OrderBook.h"
+#include "../core/BarAggregator.h"
+#include "../core/ReadReplica.h"
 #include "../utils/Logger.h"
 #include <unordered_map>
 #include <atomic>
+#include <vector>
+#include <thread>
+#include <shared_mutex>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
 
@@ -45,7 +50,8 @@ public:
     using MessagePtr = WsServer::message_ptr;
     using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
 
-    WebSocketServer(std::shared_ptr<MatchingEngine> engine, uint16_t port = 9002);
+    // io_threads == 0 uses one I/O thread per hardware core
+    WebSocketServer(std::shared_ptr<MatchingEngine> engine, uint16_t port = 9002, std::size_t io_threads = 0);
     ~WebSocketServer();
 
     // Start the WebSocket server
@@ -57,27 +63,91 @@ public:
     // Market data and trade streaming
     void broadcastMarketData(const std::string& symbol);
     void broadcastTrade(const Trade& trade);
+    void broadcastBars(const std::string& symbol);
+    // Sends each side of an engine trade to the session owning that order,
+    // whichever gateway the counterparty came through
+    void routeFills(const Trade& trade);
+    // Tells the owning session that the engine cancelled or shrank its
+    // resting order without a trade
+    void onOrderReduced(const Order& order);
+    // Enables the "bars" channel; call before start()
+    void setBarAggregator(std::shared_ptr<BarAggregator> bars);
+    // Serves the "depth" subscribe image from the replica instead of the
+    // live book; call before start()
+    void setReadReplica(std::shared_ptr<ReadReplica> replica);
     void handleSubscription(ConnectionHandle hdl, const nlohmann::json& msg);
     void handleUnsubscription(ConnectionHandle hdl, const nlohmann::json& msg);
 
 private:
+    // Order entry state for one connection. Everything after `strand` is
+    // only touched from that strand.
+    struct Session {
+        struct LiveOrder {
+            std::string order_id;
+            std::string symbol;
+            Order::Side side;
+            double price;
+        };
+
+        uint64_t id;
+        ConnectionHandle hdl;
+        // Read when the connection closes, which may be off the strand
+        std::atomic<bool> cancel_on_disconnect{false};
+        std::shared_ptr<Strand> strand;
+        uint64_t next_order_seq = 0;
+        // Resting orders keyed by client_order_id (order_id when none was given)
+        std::unordered_map<std::string, LiveOrder> live_orders;
+    };
+
+    // Routes fills to the session that owns an order, from entry until it is
+    // done or off the book
+    struct OrderOwner {
+        std::weak_ptr<Session> session;
+        std::string client_order_id;
+        std::string live_key;
+        double remaining;
+    };
+
+    // Depth levels pushed on the "depth" channel
+    static constexpr int kDepthLevels = 10;
+
+    // Per-connection send buffer above which market data is dropped
+    static constexpr std::size_t kMaxSendBufferBytes = 4 * 1024 * 1024;
+
+    // Shared by every I/O thread; declared before server_ so it outlives the endpoint
+    boost::asio::io_context io_context_;
+
     // Server instance and configuration
     WsServer server_;
     std::shared_ptr<MatchingEngine> engine_;
+    std::shared_ptr<BarAggregator> bars_;
+    std::shared_ptr<ReadReplica> replica_;
     uint16_t port_;
     MessageHandler message_handler_;
     std::atomic<bool> running_;
+    std::size_t io_thread_count_;
+    std::vector<std::thread> io_threads_;
 
-    // Connection and subscription management
-    std::mutex connections_mutex_;
+    // Connection and subscription management. Each connection's handlers are
+    // serialized on its own strand so different connections run in parallel.
+    std::shared_mutex connections_mutex_;
     std::unordered_map<ConnectionHandle, 
-                      std::shared_ptr<Strand>, 
+                      std::shared_ptr<Session>, 
                       ConnectionHandleHash,
                       ConnectionHandleEqual> connections_;
+    std::atomic<uint64_t> next_session_id_{1};
     std::mutex subscriptions_mutex_;
+    // Subscription keys are "<channel>:<symbol>"
     std::map<ConnectionHandle, 
              std::set<std::string>, 
              std::owner_less<ConnectionHandle>> subscriptions_;
+    std::unordered_map<std::string,
+                       std::set<ConnectionHandle, std::owner_less<ConnectionHandle>>> channel_subscribers_;
+    std::unordered_map<std::string, uint64_t> last_bbo_sequence_; // by symbol
+    std::unordered_map<std::string, uint64_t> last_auction_sequence_; // by symbol
+
+    std::mutex owners_mutex_;
+    std::unordered_map<std::string, OrderOwner> order_owners_; // by engine order id
 
     // WebSocket event handlers
     void onOpen(ConnectionHandle hdl);
@@ -91,7 +161,16 @@ private:
     bool validateSubscriptionMessage(const nlohmann::json& msg, std::string& error);
     void sendError(ConnectionHandle hdl, const std::string& error_msg);
     void cleanupConnection(ConnectionHandle hdl);
+    std::shared_ptr<Session> getSession(ConnectionHandle hdl);
 
-    boost::asio::io_context io_context_;
-    std::shared_ptr<Strand> strand_;
+    // Order entry protocol
+    void handleMessage(const std::shared_ptr<Session>& session, const std::string& payload);
+    void handleOrder(const std::shared_ptr<Session>& session, const nlohmann::json& msg);
+    void handleCancel(const std::shared_ptr<Session>& session, const nlohmann::json& msg);
+    void handleCancelAll(const std::shared_ptr<Session>& session, const nlohmann::json& msg);
+    void handleQuote(const std::shared_ptr<Session>& session, const nlohmann::json& msg);
+    void handleSessionOptions(const std::shared_ptr<Session>& session, const nlohmann::json& msg);
+    void routeFill(const Trade& trade, const std::string& order_id, Order::Side side, const char* liquidity);
+    void sendToConnection(ConnectionHandle hdl, const std::string& payload);
+    void publish(const std::string& key, const std::string& message);
 }; 
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "BarAggregator.h"
+#include <algorithm>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "../utils/Utils.h"
+
+double BarAggregator::Bar::vwap() const {
+    return volume > 0.0 ? notional / volume : 0.0;
+}
+
+std::string BarAggregator::Bar::toJSON(const std::string& symbol, Interval interval) const {
+    nlohmann::json j = {
+        {"symbol", symbol},
+        {"interval", intervalName(interval)},
+        {"start", Utils::formatTimestamp(start_us)},
+        {"open", open},
+        {"high", high},
+        {"low", low},
+        {"close", close},
+        {"volume", volume},
+        {"vwap", vwap()},
+        {"trades", trades}
+    };
+    return j.dump();
+}
+
+const char* BarAggregator::intervalName(Interval interval) {
+    switch (interval) {
+        case Interval::SEC_1: return "1s";
+        case Interval::MIN_1: return "1m";
+        case Interval::MIN_5: return "5m";
+        default:              return "unknown";
+    }
+}
+
+bool BarAggregator::parseInterval(const std::string& name, Interval& out) {
+    for (std::size_t i = 0; i < kIntervals; ++i) {
+        auto interval = static_cast<Interval>(i);
+        if (name == intervalName(interval)) {
+            out = interval;
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t BarAggregator::intervalMicros(Interval interval) {
+    switch (interval) {
+        case Interval::SEC_1: return 1000000LL;
+        case Interval::MIN_1: return 60LL * 1000000LL;
+        case Interval::MIN_5: return 300LL * 1000000LL;
+        default:              return 1000000LL;
+    }
+}
+
+void BarAggregator::onTrade(const Trade& trade) {
+    int64_t ts;
+    if (!Utils::parseTimestamp(trade.timestamp, ts)) {
+        ts = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::shared_ptr<SymbolBars> bars;
+    {
+        std::lock_guard<std::mutex> lock(symbols_mtx_);
+        auto& entry = symbols_[trade.symbol];
+        if (!entry) entry = std::make_shared<SymbolBars>();
+        bars = entry;
+    }
+
+    std::lock_guard<std::mutex> lock(bars->mtx);
+    for (std::size_t i = 0; i < kIntervals; ++i) {
+        const int64_t len = intervalMicros(static_cast<Interval>(i));
+        const int64_t start = ts - ts % len;
+        Series& series = bars->series[i];
+        if (series.latest_start_us >= 0 &&
+            start <= series.latest_start_us - len * static_cast<int64_t>(kHistory)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        Bar& bar = series.slots[static_cast<std::size_t>(start / len) % kHistory];
+        if (bar.trades == 0 || bar.start_us != start) {
+            bar = Bar{};
+            bar.start_us = start;
+            bar.open = bar.high = bar.low = trade.price;
+        }
+        bar.high = std::max(bar.high, trade.price);
+        bar.low = std::min(bar.low, trade.price);
+        bar.close = trade.price;
+        bar.volume += trade.quantity;
+        bar.notional += trade.price * trade.quantity;
+        ++bar.trades;
+        series.latest_start_us = std::max(series.latest_start_us, start);
+    }
+}
+
+std::shared_ptr<BarAggregator::SymbolBars> BarAggregator::find(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(symbols_mtx_);
+    auto it = symbols_.find(symbol);
+    return it == symbols_.end() ? nullptr : it->second;
+}
+
+std::vector<BarAggregator::Bar> BarAggregator::getBars(const std::string& symbol, Interval interval, std::size_t limit) const {
+    std::vector<Bar> out;
+    auto bars = find(symbol);
+    if (!bars) return out;
+
+    const int64_t len = intervalMicros(interval);
+    std::lock_guard<std::mutex> lock(bars->mtx);
+    const Series& series = bars->series[static_cast<std::size_t>(interval)];
+    if (series.latest_start_us < 0) return out;
+    for (std::size_t k = 0; k < kHistory && out.size() < limit; ++k) {
+        int64_t start = series.latest_start_us - static_cast<int64_t>(k) * len;
+        const Bar& bar = series.slots[static_cast<std::size_t>(start / len) % kHistory];
+        if (bar.trades > 0 && bar.start_us == start) out.push_back(bar);
+    }
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+std::vector<std::pair<BarAggregator::Interval, BarAggregator::Bar>> BarAggregator::getCurrentBars(const std::string& symbol) const {
+    std::vector<std::pair<Interval, Bar>> out;
+    auto bars = find(symbol);
+    if (!bars) return out;
+
+    std::lock_guard<std::mutex> lock(bars->mtx);
+    for (std::size_t i = 0; i < kIntervals; ++i) {
+        const Series& series = bars->series[i];
+        if (series.latest_start_us < 0) continue;
+        const int64_t len = intervalMicros(static_cast<Interval>(i));
+        out.emplace_back(static_cast<Interval>(i),
+                         series.slots[static_cast<std::size_t>(series.latest_start_us / len) % kHistory]);
+    }
+    return out;
+}
+
+std::string BarAggregator::getBarsJSON(const std::string& symbol, Interval interval, std::size_t limit) const {
+    std::string out = "{\"symbol\":" + nlohmann::json(symbol).dump() +
+                      ",\"interval\":\"" + intervalName(interval) + "\",\"bars\":[";
+    bool first = true;
+    for (const auto& bar : getBars(symbol, interval, limit)) {
+        if (!first) out += ',';
+        out += bar.toJSON(symbol, interval);
+        first = false;
+    }
+    out += "]}";
+    return out;
+}
+
+uint64_t BarAggregator::getDroppedTrades() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
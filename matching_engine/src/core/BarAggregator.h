@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Trade.h"
+
+// Rolls the trade stream up into OHLCV bars per symbol at fixed intervals.
+// Feed it from MatchingEngine::setOnTrade; each trade is O(1) per interval.
+class BarAggregator {
+public:
+    enum class Interval { SEC_1, MIN_1, MIN_5, COUNT };
+
+    struct Bar {
+        int64_t start_us = 0;   // Bucket start, microseconds since the epoch
+        double open = 0.0;
+        double high = 0.0;
+        double low = 0.0;
+        double close = 0.0;
+        double volume = 0.0;
+        double notional = 0.0;  // Sum of price * quantity
+        uint64_t trades = 0;
+
+        double vwap() const;
+        std::string toJSON(const std::string& symbol, Interval interval) const;
+    };
+
+    // Bars retained per symbol and interval
+    static constexpr std::size_t kHistory = 360;
+
+    void onTrade(const Trade& trade);
+
+    // Up to `limit` most recent bars that saw trades, oldest first
+    std::vector<Bar> getBars(const std::string& symbol, Interval interval, std::size_t limit = kHistory) const;
+    // Bars containing the symbol's most recent trade, one per interval
+    std::vector<std::pair<Interval, Bar>> getCurrentBars(const std::string& symbol) const;
+    std::string getBarsJSON(const std::string& symbol, Interval interval, std::size_t limit) const;
+
+    // Trades too old for the retained window
+    uint64_t getDroppedTrades() const;
+
+    static const char* intervalName(Interval interval);
+    static bool parseInterval(const std::string& name, Interval& out);
+    static int64_t intervalMicros(Interval interval);
+
+private:
+    static constexpr std::size_t kIntervals = static_cast<std::size_t>(Interval::COUNT);
+
+    // Slots are indexed by bucket number, so a trade lands in its bar in O(1)
+    // even when trades arrive slightly out of timestamp order.
+    struct Series {
+        std::array<Bar, kHistory> slots;
+        int64_t latest_start_us = -1;
+    };
+
+    struct SymbolBars {
+        mutable std::mutex mtx;
+        std::array<Series, kIntervals> series;
+    };
+
+    mutable std::mutex symbols_mtx_;
+    std::map<std::string, std::shared_ptr<SymbolBars>> symbols_;
+    std::atomic<uint64_t> dropped_{0};
+
+    std::shared_ptr<SymbolBars> find(const std::string& symbol) const;
+};
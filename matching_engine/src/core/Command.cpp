@@ -0,0 +1,208 @@
+#include "Command.h"
+#include <cstring>
+#include <type_traits>
+
+namespace {
+    template <typename T>
+    void put(std::string& out, T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw copy");
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(std::string& out, const std::string& value) {
+        put<uint32_t>(out, static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    // Bounds-checked reads; any failure poisons the reader
+    struct Reader {
+        const char* p;
+        const char* end;
+        bool ok = true;
+
+        template <typename T>
+        T get() {
+            T value{};
+            if (!ok || static_cast<std::size_t>(end - p) < sizeof(T)) {
+                ok = false;
+                return value;
+            }
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return value;
+        }
+
+        std::string getString() {
+            uint32_t size = get<uint32_t>();
+            if (!ok || static_cast<std::size_t>(end - p) < size) {
+                ok = false;
+                return {};
+            }
+            std::string value(p, size);
+            p += size;
+            return value;
+        }
+    };
+
+    void putOrder(std::string& out, const Order& order) {
+        putString(out, order.getOrderId());
+        putString(out, order.getSymbol());
+        putString(out, order.getTimestamp());
+        putString(out, order.getAccount());
+        put<uint8_t>(out, static_cast<uint8_t>(order.getType()));
+        put<uint8_t>(out, static_cast<uint8_t>(order.getSide()));
+        put<uint8_t>(out, static_cast<uint8_t>(order.getSelfTradePrevention()));
+        put<uint8_t>(out, static_cast<uint8_t>(order.getTimeInForce()));
+        put<uint8_t>(out, order.isQuote() ? 1 : 0);
+        put<double>(out, order.getQuantity());
+        put<double>(out, order.getPrice());
+        put<double>(out, order.getDisplayQuantity());
+        put<double>(out, order.getStopPrice());
+        put<int64_t>(out, order.getExpireTime());
+        put<uint64_t>(out, order.getSessionId());
+        put<uint64_t>(out, order.getEngineId());
+    }
+
+    std::optional<Order> getOrder(Reader& in) {
+        std::string order_id = in.getString();
+        std::string symbol = in.getString();
+        std::string timestamp = in.getString();
+        std::string account = in.getString();
+        auto type = static_cast<Order::Type>(in.get<uint8_t>());
+        auto side = static_cast<Order::Side>(in.get<uint8_t>());
+        auto stp = static_cast<Order::SelfTradePrevention>(in.get<uint8_t>());
+        auto tif = static_cast<Order::TimeInForce>(in.get<uint8_t>());
+        bool quote = in.get<uint8_t>() != 0;
+        double quantity = in.get<double>();
+        double price = in.get<double>();
+        double display_quantity = in.get<double>();
+        double stop_price = in.get<double>();
+        int64_t expire_time = in.get<int64_t>();
+        uint64_t session_id = in.get<uint64_t>();
+        uint64_t engine_id = in.get<uint64_t>();
+        if (!in.ok) return std::nullopt;
+        Order order(order_id, symbol, type, side, quantity, price, timestamp);
+        order.setAccount(account);
+        order.setSelfTradePrevention(stp);
+        order.setTimeInForce(tif, expire_time);
+        order.setQuote(quote);
+        if (display_quantity > 0.0) order.setDisplayQuantity(display_quantity);
+        if (stop_price > 0.0) order.setStopPrice(stop_price);
+        order.setSessionId(session_id);
+        order.setEngineId(engine_id);
+        return order;
+    }
+}
+
+void encodeCommand(const Command& command, std::string& out) {
+    put<uint8_t>(out, static_cast<uint8_t>(command.type));
+    put<uint64_t>(out, command.sequence);
+    put<int64_t>(out, command.time_us);
+    putString(out, command.symbol);
+    switch (command.type) {
+        case Command::Type::ORDER:
+            putOrder(out, *command.order);
+            break;
+        case Command::Type::CANCEL:
+            putString(out, command.order_id);
+            put<uint8_t>(out, static_cast<uint8_t>(command.side));
+            put<double>(out, command.price);
+            break;
+        case Command::Type::QUOTE: {
+            const QuoteEntry& entry = command.quote.entries.front();
+            putString(out, command.quote.account);
+            put<uint64_t>(out, command.quote.session_id);
+            putString(out, command.quote.timestamp);
+            put<double>(out, entry.bid_price);
+            put<double>(out, entry.bid_quantity);
+            put<double>(out, entry.ask_price);
+            put<double>(out, entry.ask_quantity);
+            putString(out, entry.bid_order_id);
+            putString(out, entry.ask_order_id);
+            put<uint64_t>(out, entry.bid_engine_id);
+            put<uint64_t>(out, entry.ask_engine_id);
+            break;
+        }
+        case Command::Type::CANCEL_ACCOUNT:
+            putString(out, command.account);
+            break;
+        case Command::Type::CANCEL_SESSION:
+            put<uint64_t>(out, command.session_id);
+            break;
+        case Command::Type::PRICE_BAND:
+            put<double>(out, command.band.width);
+            put<int64_t>(out, command.band.half_life_us);
+            put<int64_t>(out, command.band.auction_us);
+            break;
+        case Command::Type::EXPIRE:
+        case Command::Type::END_SESSION:
+            put<uint32_t>(out, static_cast<uint32_t>(command.engine_ids.size()));
+            for (uint64_t id : command.engine_ids) put<uint64_t>(out, id);
+            break;
+        case Command::Type::START_AUCTION:
+        case Command::Type::UNCROSS:
+            break;
+    }
+}
+
+bool decodeCommand(const char* data, std::size_t size, Command& out) {
+    Reader in{data, data + size};
+    uint8_t type = in.get<uint8_t>();
+    if (type > static_cast<uint8_t>(Command::Type::PRICE_BAND)) return false;
+    out = Command{};
+    out.type = static_cast<Command::Type>(type);
+    out.sequence = in.get<uint64_t>();
+    out.time_us = in.get<int64_t>();
+    out.symbol = in.getString();
+    switch (out.type) {
+        case Command::Type::ORDER:
+            out.order = getOrder(in);
+            break;
+        case Command::Type::CANCEL:
+            out.order_id = in.getString();
+            out.side = static_cast<Order::Side>(in.get<uint8_t>());
+            out.price = in.get<double>();
+            break;
+        case Command::Type::QUOTE: {
+            QuoteEntry entry;
+            entry.symbol = out.symbol;
+            out.quote.account = in.getString();
+            out.quote.session_id = in.get<uint64_t>();
+            out.quote.timestamp = in.getString();
+            entry.bid_price = in.get<double>();
+            entry.bid_quantity = in.get<double>();
+            entry.ask_price = in.get<double>();
+            entry.ask_quantity = in.get<double>();
+            entry.bid_order_id = in.getString();
+            entry.ask_order_id = in.getString();
+            entry.bid_engine_id = in.get<uint64_t>();
+            entry.ask_engine_id = in.get<uint64_t>();
+            out.quote.entries.push_back(std::move(entry));
+            break;
+        }
+        case Command::Type::CANCEL_ACCOUNT:
+            out.account = in.getString();
+            break;
+        case Command::Type::CANCEL_SESSION:
+            out.session_id = in.get<uint64_t>();
+            break;
+        case Command::Type::PRICE_BAND:
+            out.band.width = in.get<double>();
+            out.band.half_life_us = in.get<int64_t>();
+            out.band.auction_us = in.get<int64_t>();
+            break;
+        case Command::Type::EXPIRE:
+        case Command::Type::END_SESSION: {
+            uint32_t count = in.get<uint32_t>();
+            // Each id takes 8 bytes; refuse a count the record cannot hold
+            if (!in.ok || static_cast<std::size_t>(in.end - in.p) / sizeof(uint64_t) < count) return false;
+            out.engine_ids.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) out.engine_ids.push_back(in.get<uint64_t>());
+            break;
+        }
+        case Command::Type::START_AUCTION:
+        case Command::Type::UNCROSS:
+            break;
+    }
+    return in.ok && in.p == in.end && (out.type != Command::Type::ORDER || out.order);
+}
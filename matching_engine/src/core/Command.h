@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Order.h"
+#include "OrderBook.h"
+#include "Quote.h"
+
+// One state-changing engine input as journaled for replicas. Each applies to
+// one book; replaying a book's commands in order, at their time_us, rebuilds
+// it exactly. Only the fields of its type are meaningful.
+struct Command {
+    enum class Type : uint8_t {
+        ORDER,          // order, as submitted; risk rejects are never journaled
+        CANCEL,         // order_id, side, price
+        QUOTE,          // quote, one entry; sides the primary rejected are zeroed
+        CANCEL_ACCOUNT, // account
+        CANCEL_SESSION, // session_id
+        EXPIRE,         // engine_ids: the GTT orders that expired
+        END_SESSION,    // engine_ids: the DAY orders that expired
+        START_AUCTION,
+        UNCROSS,
+        PRICE_BAND      // band
+    };
+
+    Type type = Type::ORDER;
+    uint64_t sequence = 0; // Assigned by the journal; gap-free in log order
+    int64_t time_us = 0;   // Engine clock when the command applied
+    std::string symbol;
+    std::optional<Order> order;
+    Quote quote;
+    std::string order_id;
+    Order::Side side = Order::Side::BUY;
+    double price = 0.0;
+    std::string account;
+    uint64_t session_id = 0;
+    PriceBand band;
+    std::vector<uint64_t> engine_ids;
+};
+
+// Compact binary form for the replication stream, in host byte order: the
+// primary and its backups run the same build on the same architecture.
+// Appends to `out`; decoding returns false on a truncated or unknown record.
+void encodeCommand(const Command& command, std::string& out);
+bool decodeCommand(const char* data, std::size_t size, Command& out);
@@ -1,6 +1,29 @@
 #include "MatchingEngine.h"
+#include <algorithm>
 #include <stdexcept>
 #include <mutex>
+#include "../utils/Metrics.h"
+#include "../utils/Utils.h"
+
+namespace {
+    // Applies a fill to the order at the front of a level
+    void fillFront(OrderQueue& queue, OrderBook& book, double qty) {
+        std::shared_ptr<Order> resting_order = queue.front();
+        book.executeFront(queue, qty);
+        if (resting_order->getQuantity() == 0) {
+            if (book.refillFront(queue)) {
+                // Refilled in place and requeued behind the level
+                resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
+            } else {
+                resting_order->setStatus(Order::Status::FILLED);
+                book.unlinkOrder(*resting_order);
+                queue.pop();
+            }
+        } else {
+            resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
+        }
+    }
+}
 
 MatchingEngine::MatchingEngine() {}
 
@@ -8,120 +31,818 @@ void MatchingEngine::setOnTrade(const TradeCallback& callback) {
     on_trade_cb_ = callback;
 }
 
+void MatchingEngine::setOnBookUpdate(const BookUpdateCallback& callback) {
+    on_book_update_cb_ = callback;
+}
+
+void MatchingEngine::setOnOrderReduced(const OrderCallback& callback) {
+    on_order_reduced_cb_ = callback;
+}
+
+void MatchingEngine::setOutputBus(std::shared_ptr<OutputBus> bus) {
+    output_ = std::move(bus);
+}
+
+void MatchingEngine::setOnCommand(const CommandCallback& callback) {
+    on_command_cb_ = callback;
+}
+
+void MatchingEngine::assignEngineId(Order& order) {
+    const uint64_t id = order.getEngineId();
+    if (!replica_ || id == 0) {
+        order.setEngineId(last_engine_id_.fetch_add(1, std::memory_order_relaxed) + 1);
+        return;
+    }
+    // Never hand the primary's ids out again after a takeover
+    uint64_t last = last_engine_id_.load(std::memory_order_relaxed);
+    while (last < id && !last_engine_id_.compare_exchange_weak(last, id, std::memory_order_relaxed)) {
+    }
+}
+
+void MatchingEngine::setReplica(bool replica) {
+    replica_ = replica;
+    replay_time_us_ = 0;
+}
+
+int64_t MatchingEngine::now() const {
+    return replica_ ? replay_time_us_ : Utils::nowMicros();
+}
+
+void MatchingEngine::journal(Command& command, const OrderBook& book, int64_t now_us) {
+    command.symbol = book.getSymbol();
+    command.time_us = now_us;
+    on_command_cb_(command);
+}
+
+void MatchingEngine::apply(const Command& command) {
+    replay_time_us_ = command.time_us;
+    switch (command.type) {
+        case Command::Type::ORDER:
+            processOrder(*command.order);
+            break;
+        case Command::Type::CANCEL:
+            cancelOrder(command.symbol, command.order_id, command.side, command.price);
+            break;
+        case Command::Type::QUOTE: {
+            std::vector<QuoteResult> results;
+            processQuote(command.quote, results);
+            break;
+        }
+        case Command::Type::CANCEL_ACCOUNT:
+            cancelAllForAccount(command.account, command.symbol);
+            break;
+        case Command::Type::CANCEL_SESSION:
+            cancelAllForSession(command.session_id, command.symbol);
+            break;
+        case Command::Type::EXPIRE:
+        case Command::Type::END_SESSION:
+            if (auto book = getBook(command.symbol)) {
+                expireBook(*book, command.type == Command::Type::END_SESSION, command.time_us, &command.engine_ids);
+            }
+            break;
+        case Command::Type::START_AUCTION:
+            startAuction(command.symbol);
+            break;
+        case Command::Type::UNCROSS:
+            uncross(command.symbol);
+            break;
+        case Command::Type::PRICE_BAND:
+            setPriceBand(command.symbol, command.band);
+            break;
+    }
+}
+
 void MatchingEngine::notifyTrade(const Trade& trade) {
     if (on_trade_cb_) {
         on_trade_cb_(trade);
     }
 }
 
-std::vector<Trade> MatchingEngine::processOrder(const Order& order) {
-    if (order_books_.find(order.getSymbol()) == order_books_.end()) {
-        order_books_[order.getSymbol()] = std::make_shared<OrderBook>(order.getSymbol());
+std::shared_ptr<OrderBook> MatchingEngine::getOrCreateBook(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(books_mtx_);
+    auto it = order_books_.find(symbol);
+    if (it == order_books_.end()) {
+        it = order_books_.emplace(symbol, std::make_shared<OrderBook>(symbol)).first;
+        it->second->setPriceBand(default_band_); // Not yet visible to other threads
+        if (book_events_) it->second->setEventsEnabled(true);
+    }
+    return it->second;
+}
+
+std::shared_ptr<OrderBook> MatchingEngine::getBook(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(books_mtx_);
+    auto it = order_books_.find(symbol);
+    return it == order_books_.end() ? nullptr : it->second;
+}
+
+std::vector<std::pair<std::string, OrderBook::Stats>> MatchingEngine::getBookStats() const {
+    auto books = booksFor("");
+    std::vector<std::pair<std::string, OrderBook::Stats>> stats;
+    stats.reserve(books.size());
+    for (const auto& book : books) {
+        stats.emplace_back(book->getSymbol(), book->getStats());
+    }
+    return stats;
+}
+
+void MatchingEngine::setDefaultPriceBand(const PriceBand& band) {
+    std::lock_guard<std::mutex> lock(books_mtx_);
+    default_band_ = band;
+}
+
+void MatchingEngine::setBookEventsEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(books_mtx_);
+    book_events_ = enabled;
+    for (const auto& entry : order_books_) entry.second->setEventsEnabled(enabled);
+}
+
+void MatchingEngine::setPriceBand(const std::string& symbol, const PriceBand& band) {
+    auto book = getOrCreateBook(symbol);
+    std::lock_guard<std::mutex> lock(book->mtx_);
+    book->setPriceBand(band);
+    if (on_command_cb_) {
+        Command command;
+        command.type = Command::Type::PRICE_BAND;
+        command.band = band;
+        journal(command, *book, now());
+    }
+}
+
+void MatchingEngine::setRiskManager(std::shared_ptr<RiskManager> risk) {
+    risk_ = std::move(risk);
+}
+
+void MatchingEngine::finishMatch(Order& order, std::vector<Trade>& trades, MatchOutcome& outcome, OrderBook& book) {
+    book.recordTrades(trades, outcome.now_us);
+    if (!trades.empty()) {
+        auto range = std::minmax_element(trades.begin(), trades.end(),
+                                         [](const Trade& a, const Trade& b) { return a.price < b.price; });
+        book.triggerStops(range.first->price, range.second->price, outcome.triggered);
+    }
+    if (risk_) {
+        risk_->settle(order, trades);
+        // The outcome spans every order in the pass; release each reduction once
+        for (; outcome.released < outcome.reduced.size(); ++outcome.released) {
+            const auto& reduced = outcome.reduced[outcome.released];
+            risk_->release(reduced.order, reduced.quantity);
+        }
+    }
+    if (outcome.halted && book.getPhase() == OrderBook::Phase::CONTINUOUS) {
+        book.haltForVolatility(outcome.now_us);
+        Metrics::increment(Metrics::Counter::VOLATILITY_HALTS);
     }
-    Order::Type type = order.getType();
+    book.updateBBO();
+}
+
+std::vector<Trade> MatchingEngine::processOrder(const Order& order, RiskManager::Reject* risk_reject) {
+    auto book = getOrCreateBook(order.getSymbol());
+    Order& incoming = const_cast<Order&>(order);
     std::vector<Trade> trades;
-    
-    switch (type) {
+    assignEngineId(incoming);
+
+    if (risk_) {
+        RiskManager::Reject reject = risk_->reserve(order, book->getTopOfBook(), !replica_);
+        if (risk_reject) *risk_reject = reject;
+        if (reject != RiskManager::Reject::NONE) {
+            incoming.setStatus(Order::Status::REJECTED);
+            if (output_) {
+                OutputBus::Batch batch(*output_, 1);
+                OutputEvent& event = batch.next(OutputEvent::Type::ORDER, order.getSymbol());
+                event.order = incoming;
+                event.reject = reject;
+            }
+            return trades;
+        }
+    }
+
+    MatchOutcome outcome;
+    Outputs outputs;
+    {
+        // One lock for the order and every stop it triggers, so a cascade
+        // completes before any other order reaches the book
+        std::lock_guard<std::mutex> lock(book->mtx_);
+        outcome.now_us = now();
+        if (on_command_cb_) {
+            Command command;
+            command.type = Command::Type::ORDER;
+            command.order = incoming;
+            journal(command, *book, outcome.now_us);
+        }
+        if (incoming.isStop() && !stopReached(incoming, *book)) {
+            incoming.setStatus(Order::Status::NEW);
+            book->parkStop(std::make_shared<Order>(incoming));
+        } else {
+            incoming.trigger();
+            trades = match(incoming, *book, outcome);
+        }
+        runTriggered(*book, trades, outcome);
+        claimOutputs(outputs, trades.size() + outcome.reduced.size() + 2);
+    }
+    publish(order.getSymbol(), trades, outcome, outputs, &incoming);
+    return trades;
+}
+
+std::vector<Trade> MatchingEngine::processQuote(const Quote& quote, std::vector<QuoteResult>& results) {
+    if (quote.account.empty()) throw std::invalid_argument("Quote requires an account");
+    std::vector<Trade> all_trades;
+    results.assign(quote.entries.size(), QuoteResult{});
+    for (std::size_t i = 0; i < quote.entries.size(); ++i) {
+        const QuoteEntry& entry = quote.entries[i];
+        QuoteResult& result = results[i];
+        auto book = getOrCreateBook(entry.symbol);
+        std::vector<Trade> trades;
+        MatchOutcome outcome;
+        Outputs outputs;
+        {
+            // Both sides change under one lock, so no order sees half a quote.
+            // Old sides are settled first: a new bid never meets the old ask.
+            std::lock_guard<std::mutex> lock(book->mtx_);
+            outcome.now_us = now();
+            bool enter_bid = amendQuoteSide(*book, quote.account, Order::Side::BUY,
+                                            entry.bid_price, entry.bid_quantity, result.bid, outcome);
+            bool enter_ask = amendQuoteSide(*book, quote.account, Order::Side::SELL,
+                                            entry.ask_price, entry.ask_quantity, result.ask, outcome);
+            if (enter_bid) {
+                enterQuoteSide(*book, quote, Order::Side::BUY, entry.bid_price, entry.bid_quantity,
+                               entry.bid_order_id, entry.bid_engine_id, result.bid, trades, outcome);
+            }
+            if (enter_ask) {
+                enterQuoteSide(*book, quote, Order::Side::SELL, entry.ask_price, entry.ask_quantity,
+                               entry.ask_order_id, entry.ask_engine_id, result.ask, trades, outcome);
+            }
+            runTriggered(*book, trades, outcome);
+            book->updateBBO();
+            if (on_command_cb_) {
+                Command command;
+                command.type = Command::Type::QUOTE;
+                command.quote.account = quote.account;
+                command.quote.session_id = quote.session_id;
+                command.quote.timestamp = quote.timestamp;
+                command.quote.entries.push_back(entry);
+                // A side risk refused was pulled without a replacement
+                QuoteEntry& logged = command.quote.entries.back();
+                if (result.bid.reject != RiskManager::Reject::NONE) logged.bid_quantity = 0.0;
+                if (result.ask.reject != RiskManager::Reject::NONE) logged.ask_quantity = 0.0;
+                logged.bid_engine_id = result.bid.engine_id;
+                logged.ask_engine_id = result.ask.engine_id;
+                journal(command, *book, outcome.now_us);
+            }
+            claimOutputs(outputs, trades.size() + outcome.reduced.size() + outcome.entered.size() + 1);
+        }
+        publish(entry.symbol, trades, outcome, outputs);
+        all_trades.insert(all_trades.end(), trades.begin(), trades.end());
+    }
+    return all_trades;
+}
+
+bool MatchingEngine::amendQuoteSide(OrderBook& book, const std::string& account, Order::Side side,
+                                    double price, double quantity, QuoteSideResult& result,
+                                    MatchOutcome& outcome) {
+    std::shared_ptr<Order> current = book.quoteSlot(account, side);
+    if (current && quantity > 0 && current->getPrice() == price && quantity <= current->getQuantity()) {
+        // Same price and no larger: amend in place, keeping time priority
+        double cut = current->getQuantity() - quantity;
+        if (cut > 0) {
+            book.reduceResting(*current, cut);
+            // Published like any in-place reduction, but released now: no
+            // fill loop may follow to do it
+            outcome.reduced.push_back({*current, cut});
+            if (risk_) risk_->release(*current, cut);
+            outcome.released = outcome.reduced.size();
+        }
+        result.order_id = current->getOrderId();
+        result.leaves_quantity = quantity;
+        result.priority_kept = true;
+        return false;
+    }
+    if (current) {
+        book.removeResting(current);
+        current->setStatus(Order::Status::CANCELLED);
+        if (risk_) risk_->onCancel(*current);
+        result.replaced_order_id = current->getOrderId();
+    }
+    return quantity > 0;
+}
+
+void MatchingEngine::enterQuoteSide(OrderBook& book, const Quote& quote, Order::Side side, double price,
+                                    double quantity, const std::string& order_id, uint64_t engine_id,
+                                    QuoteSideResult& result, std::vector<Trade>& trades, MatchOutcome& outcome) {
+    Order order(order_id, book.getSymbol(), Order::Type::LIMIT, side, quantity, price, quote.timestamp);
+    order.setAccount(quote.account);
+    order.setSessionId(quote.session_id);
+    order.setQuote(true);
+    order.setEngineId(engine_id);
+    assignEngineId(order);
+    if (risk_) {
+        result.reject = risk_->reserve(order, book.getTopOfBook(), !replica_);
+        if (result.reject != RiskManager::Reject::NONE) {
+            order.setStatus(Order::Status::REJECTED);
+            outcome.entered.push_back(order);
+            return;
+        }
+    }
+    result.engine_id = order.getEngineId();
+    auto fills = match(order, book, outcome);
+    outcome.entered.push_back(order);
+    trades.insert(trades.end(), fills.begin(), fills.end());
+    if (order.getStatus() == Order::Status::NEW || order.getStatus() == Order::Status::PARTIALLY_FILLED) {
+        result.order_id = order_id;
+        result.leaves_quantity = order.getQuantity();
+    }
+}
+
+void MatchingEngine::runTriggered(OrderBook& book, std::vector<Trade>& trades, MatchOutcome& outcome) {
+    // Triggered stops run in the order they were parked; each may add more
+    for (std::size_t i = 0; i < outcome.triggered.size(); ++i) {
+        std::shared_ptr<Order> stop = outcome.triggered[i];
+        stop->trigger();
+        auto fired = match(*stop, book, outcome);
+        trades.insert(trades.end(), fired.begin(), fired.end());
+        // Whatever a triggered order leaves unfilled and off the book is gone
+        const bool rested = stop->getType() == Order::Type::LIMIT &&
+                            (stop->getStatus() == Order::Status::NEW ||
+                             stop->getStatus() == Order::Status::PARTIALLY_FILLED);
+        if (!rested && stop->getStatus() != Order::Status::FILLED) {
+            stop->setStatus(Order::Status::CANCELLED);
+            outcome.reduced.push_back({*stop, stop->getQuantity()});
+        }
+    }
+}
+
+void MatchingEngine::claimOutputs(Outputs& outputs, std::size_t count) {
+    if (output_) outputs.emplace(*output_, count);
+}
+
+void MatchingEngine::publish(const std::string& symbol, const std::vector<Trade>& trades, const MatchOutcome& outcome,
+                             Outputs& outputs, const Order* order) {
+    if (!trades.empty()) {
+        Metrics::increment(Metrics::Counter::TRADES, trades.size());
+    }
+
+    // Notify about each trade
+    for (const auto& trade : trades) {
+        notifyTrade(trade);
+    }
+    if (on_order_reduced_cb_) {
+        for (const auto& reduced : outcome.reduced) on_order_reduced_cb_(reduced.order);
+    }
+    if (on_book_update_cb_) {
+        on_book_update_cb_(symbol);
+    }
+    if (outputs) {
+        for (const auto& trade : trades) outputs->next(OutputEvent::Type::TRADE, symbol).trade = trade;
+        for (const auto& reduced : outcome.reduced) outputs->next(OutputEvent::Type::REDUCED, symbol).order = reduced.order;
+        for (const auto& entered : outcome.entered) outputs->next(OutputEvent::Type::ORDER, symbol).order = entered;
+        if (order) outputs->next(OutputEvent::Type::ORDER, symbol).order = *order;
+        outputs->next(OutputEvent::Type::BOOK_UPDATE, symbol);
+        outputs.reset();
+    }
+}
+
+std::vector<Trade> MatchingEngine::match(Order& order, OrderBook& book, MatchOutcome& outcome) {
+    outcome.taker_stopped = false;
+    if (book.getPhase() == OrderBook::Phase::AUCTION) return accumulate(order, book, outcome);
+    switch (order.getType()) {
         case Order::Type::MARKET:
-            trades = matchMarketOrder(const_cast<Order&>(order));
-            break;
+            return matchMarketOrder(order, book, outcome);
         case Order::Type::LIMIT:
-            trades = matchLimitOrder(const_cast<Order&>(order));
-            break;
+            return matchLimitOrder(order, book, outcome);
         case Order::Type::IOC:
-            trades = matchIOCOrder(const_cast<Order&>(order));
-            break;
+            return matchIOCOrder(order, book, outcome);
         case Order::Type::FOK:
-            trades = matchFOKOrder(const_cast<Order&>(order));
-            break;
+            return matchFOKOrder(order, book, outcome);
         default:
             throw std::invalid_argument("Unknown order type");
     }
+}
 
-    // Notify about each trade
-    for (const auto& trade : trades) {
-        notifyTrade(trade);
+std::vector<Trade> MatchingEngine::accumulate(Order& order, OrderBook& book, MatchOutcome& outcome) {
+    std::vector<Trade> trades;
+    if (order.getType() == Order::Type::LIMIT) {
+        order.setStatus(Order::Status::NEW);
+        book.restOrder(std::make_shared<Order>(order));
+    } else {
+        // Nothing executes before the uncross
+        order.setStatus(Order::Status::CANCELLED);
     }
-
+    finishMatch(order, trades, outcome, book);
     return trades;
 }
 
-std::vector<Trade> MatchingEngine::matchMarketOrder(Order& order) {
+void MatchingEngine::startAuction(const std::string& symbol) {
+    auto book = getOrCreateBook(symbol);
+    Outputs outputs;
+    {
+        std::lock_guard<std::mutex> lock(book->mtx_);
+        book->setPhase(OrderBook::Phase::AUCTION);
+        if (on_command_cb_) {
+            Command command;
+            command.type = Command::Type::START_AUCTION;
+            journal(command, *book, now());
+        }
+        claimOutputs(outputs, 1);
+    }
+    if (on_book_update_cb_) {
+        on_book_update_cb_(symbol);
+    }
+    if (outputs) {
+        outputs->next(OutputEvent::Type::BOOK_UPDATE, symbol);
+    }
+}
+
+std::vector<Trade> MatchingEngine::uncross(const std::string& symbol) {
     std::vector<Trade> trades;
-    auto& book = order_books_[order.getSymbol()];
-    std::unique_lock<std::mutex> lock(book->mtx_);
-    double remaining_qty = order.getQuantity();
-    auto side = order.getSide();
-    if (side == Order::Side::BUY) {
-        // BUY: match against asks_
-        for (auto it = book->asks_.begin(); it != book->asks_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "buy";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
-                    queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
-                }
+    auto book = getBook(symbol);
+    if (!book) return trades;
+    MatchOutcome outcome;
+    Outputs outputs;
+    {
+        std::lock_guard<std::mutex> lock(book->mtx_);
+        if (book->getPhase() != OrderBook::Phase::AUCTION) return trades;
+        outcome.now_us = now();
+        uncrossLocked(*book, trades, outcome);
+        claimOutputs(outputs, trades.size() + outcome.reduced.size() + 1);
+    }
+    publish(symbol, trades, outcome, outputs);
+    return trades;
+}
+
+void MatchingEngine::uncrossLocked(OrderBook& book, std::vector<Trade>& trades, MatchOutcome& outcome) {
+    if (on_command_cb_) {
+        Command command;
+        command.type = Command::Type::UNCROSS;
+        journal(command, book, outcome.now_us);
+    }
+    AuctionState state = book.equilibrium();
+    if (state.volume > 0.0) executeUncross(book, state.price, outcome.now_us, trades);
+    book.setPhase(OrderBook::Phase::CONTINUOUS);
+    book.recordTrades(trades, outcome.now_us);
+    // The uncross price is the new reference for the band
+    if (!trades.empty()) book.resetReference(state.price, outcome.now_us);
+    if (risk_) risk_->settleAuction(trades);
+    if (!trades.empty()) book.triggerStops(state.price, state.price, outcome.triggered);
+    runTriggered(book, trades, outcome);
+    book.updateBBO();
+}
+
+std::size_t MatchingEngine::uncrossDue(int64_t now_us) {
+    std::size_t reopened = 0;
+    for (const auto& book : booksFor("")) {
+        if (!book->getAuctionState().active) continue; // Lock-free skip for continuous books
+        std::vector<Trade> trades;
+        MatchOutcome outcome;
+        Outputs outputs;
+        {
+            std::lock_guard<std::mutex> lock(book->mtx_);
+            int64_t end = book->auctionEnd();
+            if (end == 0 || end > now_us) continue;
+            outcome.now_us = now_us;
+            uncrossLocked(*book, trades, outcome);
+            claimOutputs(outputs, trades.size() + outcome.reduced.size() + 1);
+        }
+        publish(book->getSymbol(), trades, outcome, outputs);
+        ++reopened;
+    }
+    return reopened;
+}
+
+void MatchingEngine::executeUncross(OrderBook& book, double price, int64_t now_us, std::vector<Trade>& trades) {
+    const std::string timestamp = Utils::formatTimestamp(now_us);
+    auto bid = book.bids_.begin();
+    auto ask = book.asks_.begin();
+    // Price-time priority on both sides, so whatever is left cannot cross
+    while (bid != book.bids_.end() && ask != book.asks_.end() && bid->first >= price && ask->first <= price) {
+        OrderQueue& bids = bid->second;
+        OrderQueue& asks = ask->second;
+        const Order& buyer = *bids.front();
+        const Order& seller = *asks.front();
+        Trade trade;
+        trade.trade_id = std::to_string(rand());
+        trade.timestamp = timestamp;
+        trade.symbol = book.getSymbol();
+        trade.price = price;
+        trade.quantity = std::min(buyer.getQuantity(), seller.getQuantity());
+        trade.aggressor_side = "none";
+        trade.maker_order_id = seller.getOrderId();
+        trade.taker_order_id = buyer.getOrderId();
+        trade.maker_account = seller.getAccount();
+        trade.taker_account = buyer.getAccount();
+        trade.maker_engine_id = seller.getEngineId();
+        trade.taker_engine_id = buyer.getEngineId();
+        fillFront(bids, book, trade.quantity);
+        fillFront(asks, book, trade.quantity);
+        trades.push_back(std::move(trade));
+        if (bids.empty()) bid = book.bids_.erase(bid);
+        if (asks.empty()) ask = book.asks_.erase(ask);
+    }
+}
+
+bool MatchingEngine::stopReached(const Order& order, const OrderBook& book) const {
+    double last = book.getTopOfBook().last_price;
+    if (last <= 0.0) return false;
+    return order.getSide() == Order::Side::BUY ? last >= order.getStopPrice()
+                                               : last <= order.getStopPrice();
+}
+
+std::size_t MatchingEngine::expireOrders(int64_t now_us) {
+    return expire(false, now_us);
+}
+
+std::size_t MatchingEngine::endSession() {
+    return expire(true, Utils::nowMicros());
+}
+
+std::size_t MatchingEngine::expire(bool session_end, int64_t now_us) {
+    if (replica_) return 0; // Follows the primary's EXPIRE and END_SESSION instead
+    std::size_t total = 0;
+    for (const auto& book : booksFor("")) {
+        total += expireBook(*book, session_end, now_us);
+    }
+    return total;
+}
+
+std::size_t MatchingEngine::expireBook(OrderBook& book, bool session_end, int64_t now_us,
+                                       const std::vector<uint64_t>* replayed) {
+    std::vector<std::shared_ptr<Order>> expired;
+    Outputs outputs;
+    {
+        std::lock_guard<std::mutex> lock(book.mtx_);
+        if (replayed) {
+            // The replica's wheel runs on its own clock; remove exactly what the primary did
+            book.takeTimed(*replayed, expired);
+        } else if (session_end) {
+            book.expiries_.expireSession(expired);
+        } else {
+            book.expiries_.advance(now_us, expired);
+        }
+        if (expired.empty()) return 0;
+        // Fired timers are already released; each order is still resting
+        for (const auto& order : expired) {
+            order->setExpiryTimer(OrderBook::ExpiryWheel::kNone);
+            book.removeResting(order);
+        }
+        if (on_command_cb_) {
+            Command command;
+            command.type = session_end ? Command::Type::END_SESSION : Command::Type::EXPIRE;
+            command.engine_ids.reserve(expired.size());
+            for (const auto& order : expired) command.engine_ids.push_back(order->getEngineId());
+            journal(command, book, now_us);
+        }
+        settleCancelled(book, expired, outputs);
+    }
+    Metrics::increment(Metrics::Counter::ORDERS_EXPIRED, expired.size());
+    notifyCancelled(book, expired, outputs);
+    return expired.size();
+}
+
+std::size_t MatchingEngine::cancelAllForAccount(const std::string& account, const std::string& symbol) {
+    if (account.empty()) return 0;
+    Command command;
+    command.type = Command::Type::CANCEL_ACCOUNT;
+    command.account = account;
+    return massCancel(symbol, command, [&account](OrderBook& book, std::vector<std::shared_ptr<Order>>& out) {
+        book.takeAccountOrders(account, out);
+    });
+}
+
+std::size_t MatchingEngine::cancelAllForSession(uint64_t session_id, const std::string& symbol) {
+    if (session_id == 0) return 0;
+    Command command;
+    command.type = Command::Type::CANCEL_SESSION;
+    command.session_id = session_id;
+    return massCancel(symbol, command, [session_id](OrderBook& book, std::vector<std::shared_ptr<Order>>& out) {
+        book.takeSessionOrders(session_id, out);
+    });
+}
+
+template <typename Take>
+std::size_t MatchingEngine::massCancel(const std::string& symbol, const Command& command, Take take) {
+    std::size_t total = 0;
+    std::vector<std::shared_ptr<Order>> cancelled;
+    for (const auto& book : booksFor(symbol)) {
+        cancelled.clear();
+        Outputs outputs;
+        {
+            std::lock_guard<std::mutex> lock(book->mtx_);
+            take(*book, cancelled);
+            if (!cancelled.empty() && on_command_cb_) {
+                // Journaled per book, so it lands in that book's order
+                Command entry = command;
+                journal(entry, *book, now());
             }
-            if (queue.empty()) {
-                it = book->asks_.erase(it);
-            } else {
-                ++it;
+            settleCancelled(*book, cancelled, outputs);
+        }
+        total += cancelled.size();
+        notifyCancelled(*book, cancelled, outputs);
+    }
+    return total;
+}
+
+std::vector<std::shared_ptr<OrderBook>> MatchingEngine::booksFor(const std::string& symbol) const {
+    std::vector<std::shared_ptr<OrderBook>> books;
+    std::lock_guard<std::mutex> lock(books_mtx_);
+    if (!symbol.empty()) {
+        auto it = order_books_.find(symbol);
+        if (it != order_books_.end()) books.push_back(it->second);
+        return books;
+    }
+    books.reserve(order_books_.size());
+    for (const auto& entry : order_books_) books.push_back(entry.second);
+    return books;
+}
+
+void MatchingEngine::settleCancelled(OrderBook& book, const std::vector<std::shared_ptr<Order>>& orders,
+                                     Outputs& outputs) {
+    if (orders.empty()) return;
+    for (const auto& order : orders) {
+        order->setStatus(Order::Status::CANCELLED);
+        if (risk_) risk_->onCancel(*order);
+    }
+    book.updateBBO();
+    claimOutputs(outputs, orders.size() + 1);
+}
+
+void MatchingEngine::notifyCancelled(OrderBook& book, const std::vector<std::shared_ptr<Order>>& orders,
+                                     Outputs& outputs) {
+    if (orders.empty()) return;
+    if (on_order_reduced_cb_) {
+        for (const auto& order : orders) on_order_reduced_cb_(*order);
+    }
+    if (on_book_update_cb_) {
+        on_book_update_cb_(book.getSymbol());
+    }
+    if (outputs) {
+        for (const auto& order : orders) outputs->next(OutputEvent::Type::REDUCED, book.getSymbol()).order = *order;
+        outputs->next(OutputEvent::Type::BOOK_UPDATE, book.getSymbol());
+        outputs.reset();
+    }
+}
+
+bool MatchingEngine::cancelOrder(const std::string& symbol, const std::string& order_id, Order::Side side, double price) {
+    auto book = getBook(symbol);
+    if (!book) return false;
+    std::shared_ptr<Order> removed;
+    Outputs outputs;
+    {
+        std::lock_guard<std::mutex> lock(book->mtx_);
+        removed = book->takeOrder(order_id, side, price);
+        if (!removed) removed = book->removeStop(order_id, side);
+        if (!removed) return false;
+        if (on_command_cb_) {
+            Command command;
+            command.type = Command::Type::CANCEL;
+            command.order_id = order_id;
+            command.side = side;
+            command.price = price;
+            journal(command, *book, now());
+        }
+        removed->setStatus(Order::Status::CANCELLED);
+        if (risk_) risk_->onCancel(*removed);
+        claimOutputs(outputs, 2);
+    }
+    if (on_book_update_cb_) {
+        on_book_update_cb_(symbol);
+    }
+    if (outputs) {
+        // Off the book, so no longer shared with matching
+        outputs->next(OutputEvent::Type::ORDER, symbol).order = *removed;
+        outputs->next(OutputEvent::Type::BOOK_UPDATE, symbol);
+    }
+    return true;
+}
+
+template <typename Levels>
+double MatchingEngine::sweep(Order& order, Levels& levels, OrderBook& book, bool priced,
+                             std::vector<Trade>& trades, MatchOutcome& outcome) {
+    const bool buy = order.getSide() == Order::Side::BUY;
+    const double limit_price = order.getPrice();
+    const std::string& account = order.getAccount();
+    const auto stp = order.getSelfTradePrevention();
+    const bool check_self = stp != Order::SelfTradePrevention::NONE && !account.empty();
+    double remaining_qty = order.getQuantity();
+    std::string timestamp; // Matching clock, formatted on the first fill
+
+    for (auto it = levels.begin(); it != levels.end() && remaining_qty > 0 && !outcome.taker_stopped;) {
+        if (priced && (buy ? it->first > limit_price : it->first < limit_price)) break;
+        if (!book.withinBand(it->first)) {
+            outcome.halted = true;
+            break;
+        }
+        auto& queue = it->second;
+        while (!queue.empty() && remaining_qty > 0) {
+            std::shared_ptr<Order> resting_order = queue.front();
+            if (check_self && resting_order->getAccount() == account) {
+                if (!preventSelfTrade(order, *resting_order, queue, book, remaining_qty, outcome)) break;
+                continue;
             }
+            double match_qty = std::min(remaining_qty, resting_order->getQuantity());
+            Trade trade;
+            trade.trade_id = std::to_string(rand());
+            // Not the order's own time: a triggered stop may have been parked for hours
+            if (timestamp.empty()) timestamp = Utils::formatTimestamp(outcome.now_us);
+            trade.timestamp = timestamp;
+            trade.symbol = order.getSymbol();
+            trade.price = resting_order->getPrice();
+            trade.quantity = match_qty;
+            trade.aggressor_side = buy ? "buy" : "sell";
+            trade.maker_order_id = resting_order->getOrderId();
+            trade.taker_order_id = order.getOrderId();
+            trade.maker_account = resting_order->getAccount();
+            trade.taker_account = account;
+            trade.maker_engine_id = resting_order->getEngineId();
+            trade.taker_engine_id = order.getEngineId();
+            trades.push_back(std::move(trade));
+            remaining_qty -= match_qty;
+            fillFront(queue, book, match_qty);
         }
-    } else {
-        // SELL: match against bids_
-        for (auto it = book->bids_.begin(); it != book->bids_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "sell";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
+        if (queue.empty()) {
+            it = levels.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return remaining_qty;
+}
+
+bool MatchingEngine::preventSelfTrade(Order& taker, Order& maker, OrderQueue& queue, OrderBook& book,
+                                      double& remaining_qty, MatchOutcome& outcome) {
+    auto cancelMaker = [&]() {
+        maker.setStatus(Order::Status::CANCELLED);
+        book.unlinkOrder(maker);
+        outcome.reduced.push_back({maker, maker.getLeavesQuantity()});
+        queue.pop();
+    };
+    switch (taker.getSelfTradePrevention()) {
+        case Order::SelfTradePrevention::CANCEL_MAKER:
+            cancelMaker();
+            return true;
+        case Order::SelfTradePrevention::CANCEL_BOTH:
+            cancelMaker();
+            outcome.taker_stopped = true;
+            return false;
+        case Order::SelfTradePrevention::DECREMENT: {
+            // Shrink both sides by the overlap; nothing trades
+            double qty = std::min(remaining_qty, maker.getQuantity());
+            remaining_qty -= qty;
+            book.reduceFront(queue, qty);
+            if (maker.getQuantity() <= 0) {
+                if (!book.refillFront(queue)) {
+                    maker.setStatus(Order::Status::CANCELLED);
+                    book.unlinkOrder(maker);
                     queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
                 }
             }
-            if (queue.empty()) {
-                it = book->bids_.erase(it);
-            } else {
-                ++it;
+            outcome.reduced.push_back({maker, qty});
+            outcome.taker_stopped = remaining_qty <= 0;
+            return !outcome.taker_stopped;
+        }
+        case Order::SelfTradePrevention::CANCEL_TAKER:
+        default:
+            outcome.taker_stopped = true;
+            return false;
+    }
+}
+
+template <typename Levels>
+double MatchingEngine::available(const Order& order, const Levels& levels, const OrderBook& book) const {
+    // Mirrors sweep() so a FOK is only accepted if the sweep will complete it.
+    // Iceberg reserves count: the sweep refills them at the same price.
+    const bool buy = order.getSide() == Order::Side::BUY;
+    const double limit_price = order.getPrice();
+    const double wanted = order.getQuantity();
+    const auto stp = order.getSelfTradePrevention();
+    const bool check_self = stp != Order::SelfTradePrevention::NONE && !order.getAccount().empty();
+    double available_qty = 0.0;
+    for (auto it = levels.begin(); it != levels.end() && available_qty < wanted; ++it) {
+        if (buy ? it->first > limit_price : it->first < limit_price) break;
+        if (!book.withinBand(it->first)) break;
+        for (const auto& resting : it->second) {
+            if (available_qty >= wanted) break;
+            if (check_self && resting->getAccount() == order.getAccount()) {
+                if (stp == Order::SelfTradePrevention::CANCEL_MAKER) continue;
+                if (stp == Order::SelfTradePrevention::DECREMENT) {
+                    available_qty += resting->getLeavesQuantity();
+                    continue;
+                }
+                return available_qty; // The taker would stop here
             }
+            available_qty += resting->getLeavesQuantity();
         }
     }
-    if (remaining_qty == 0) {
+    return available_qty;
+}
+
+std::vector<Trade> MatchingEngine::matchMarketOrder(Order& order, OrderBook& book, MatchOutcome& outcome) {
+    std::vector<Trade> trades;
+    // An optional price protects the sweep: nothing fills beyond it
+    const bool protected_sweep = order.getPrice() > 0.0;
+    double remaining_qty = order.getSide() == Order::Side::BUY
+        ? sweep(order, book.asks_, book, protected_sweep, trades, outcome)
+        : sweep(order, book.bids_, book, protected_sweep, trades, outcome);
+    if (outcome.taker_stopped) {
+        order.setStatus(Order::Status::CANCELLED);
+        order.setQuantity(remaining_qty);
+    } else if (remaining_qty == 0) {
         order.setStatus(Order::Status::FILLED);
     } else if (remaining_qty < order.getQuantity()) {
         order.setStatus(Order::Status::PARTIALLY_FILLED);
@@ -129,177 +850,43 @@ std::vector<Trade> MatchingEngine::matchMarketOrder(Order& order) {
     } else {
         order.setStatus(Order::Status::NEW);
     }
+    finishMatch(order, trades, outcome, book);
     return trades;
 }
 
-std::vector<Trade> MatchingEngine::matchLimitOrder(Order& order) {
+std::vector<Trade> MatchingEngine::matchLimitOrder(Order& order, OrderBook& book, MatchOutcome& outcome) {
     std::vector<Trade> trades;
-    auto& book = order_books_[order.getSymbol()];
-    std::unique_lock<std::mutex> lock(book->mtx_);
-    double remaining_qty = order.getQuantity();
-    double limit_price = order.getPrice();
-    auto side = order.getSide();
-    if (side == Order::Side::BUY) {
-        for (auto it = book->asks_.begin(); it != book->asks_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            if (price > limit_price) break;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "buy";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
-                    queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
-                }
-            }
-            if (queue.empty()) {
-                it = book->asks_.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    } else {
-        for (auto it = book->bids_.begin(); it != book->bids_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            if (price < limit_price) break;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "sell";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
-                    queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
-                }
-            }
-            if (queue.empty()) {
-                it = book->bids_.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
-    if (remaining_qty > 0) {
+    double remaining_qty = order.getSide() == Order::Side::BUY
+        ? sweep(order, book.asks_, book, true, trades, outcome)
+        : sweep(order, book.bids_, book, true, trades, outcome);
+    if (outcome.taker_stopped) {
+        // Self-trade prevention cancelled the remainder; it never rests
+        order.setStatus(Order::Status::CANCELLED);
+        order.setQuantity(remaining_qty);
+    } else if (remaining_qty > 0) {
         if (remaining_qty < order.getQuantity()) {
             order.setStatus(Order::Status::PARTIALLY_FILLED);
         } else {
             order.setStatus(Order::Status::NEW);
         }
         order.setQuantity(remaining_qty);
-        lock.unlock();
-        book->addOrder(std::make_shared<Order>(order));
+        book.restOrder(std::make_shared<Order>(order));
     } else {
         order.setStatus(Order::Status::FILLED);
     }
+    finishMatch(order, trades, outcome, book);
     return trades;
 }
 
-std::vector<Trade> MatchingEngine::matchIOCOrder(Order& order) {
+std::vector<Trade> MatchingEngine::matchIOCOrder(Order& order, OrderBook& book, MatchOutcome& outcome) {
     std::vector<Trade> trades;
-    auto& book = order_books_[order.getSymbol()];
-    std::unique_lock<std::mutex> lock(book->mtx_);
-    double remaining_qty = order.getQuantity();
-    double limit_price = order.getPrice();
-    auto side = order.getSide();
-    if (side == Order::Side::BUY) {
-        for (auto it = book->asks_.begin(); it != book->asks_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            if (price > limit_price) break;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "buy";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
-                    queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
-                }
-            }
-            if (queue.empty()) {
-                it = book->asks_.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    } else {
-        for (auto it = book->bids_.begin(); it != book->bids_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            if (price < limit_price) break;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "sell";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
-                    queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
-                }
-            }
-            if (queue.empty()) {
-                it = book->bids_.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
-    if (remaining_qty == 0) {
+    double remaining_qty = order.getSide() == Order::Side::BUY
+        ? sweep(order, book.asks_, book, true, trades, outcome)
+        : sweep(order, book.bids_, book, true, trades, outcome);
+    if (outcome.taker_stopped) {
+        order.setStatus(Order::Status::CANCELLED);
+        order.setQuantity(remaining_qty);
+    } else if (remaining_qty == 0) {
         order.setStatus(Order::Status::FILLED);
     } else if (remaining_qty < order.getQuantity()) {
         order.setStatus(Order::Status::PARTIALLY_FILLED);
@@ -307,112 +894,30 @@ std::vector<Trade> MatchingEngine::matchIOCOrder(Order& order) {
     } else {
         order.setStatus(Order::Status::CANCELLED);
     }
+    finishMatch(order, trades, outcome, book);
     return trades;
 }
 
-std::vector<Trade> MatchingEngine::matchFOKOrder(Order& order) {
+std::vector<Trade> MatchingEngine::matchFOKOrder(Order& order, OrderBook& book, MatchOutcome& outcome) {
     std::vector<Trade> trades;
-    auto& book = order_books_[order.getSymbol()];
-    std::unique_lock<std::mutex> lock(book->mtx_);
-    double remaining_qty = order.getQuantity();
-    double limit_price = order.getPrice();
-    auto side = order.getSide();
-    double available_qty = 0.0;
-    if (side == Order::Side::BUY) {
-        for (auto it = book->asks_.begin(); it != book->asks_.end() && available_qty < remaining_qty; ++it) {
-            double price = it->first;
-            if (price > limit_price) break;
-            std::queue<std::shared_ptr<Order>> queue = it->second;
-            while (!queue.empty() && available_qty < remaining_qty) {
-                available_qty += queue.front()->getQuantity();
-                queue.pop();
-            }
-        }
-    } else {
-        for (auto it = book->bids_.begin(); it != book->bids_.end() && available_qty < remaining_qty; ++it) {
-            double price = it->first;
-            if (price < limit_price) break;
-            std::queue<std::shared_ptr<Order>> queue = it->second;
-            while (!queue.empty() && available_qty < remaining_qty) {
-                available_qty += queue.front()->getQuantity();
-                queue.pop();
-            }
-        }
-    }
-    if (available_qty < remaining_qty) {
+    double available_qty = order.getSide() == Order::Side::BUY
+        ? available(order, book.asks_, book)
+        : available(order, book.bids_, book);
+    if (available_qty < order.getQuantity()) {
         order.setStatus(Order::Status::CANCELLED);
+        finishMatch(order, trades, outcome, book);
         return trades;
     }
-    remaining_qty = order.getQuantity();
-    if (side == Order::Side::BUY) {
-        for (auto it = book->asks_.begin(); it != book->asks_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            if (price > limit_price) break;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "buy";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
-                    queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
-                }
-            }
-            if (queue.empty()) {
-                it = book->asks_.erase(it);
-            } else {
-                ++it;
-            }
-        }
+    double remaining_qty = order.getSide() == Order::Side::BUY
+        ? sweep(order, book.asks_, book, true, trades, outcome)
+        : sweep(order, book.bids_, book, true, trades, outcome);
+    if (outcome.taker_stopped || remaining_qty > 0) {
+        // Only reachable when decrement consumed the order
+        order.setStatus(Order::Status::CANCELLED);
+        order.setQuantity(remaining_qty);
     } else {
-        for (auto it = book->bids_.begin(); it != book->bids_.end() && remaining_qty > 0;) {
-            double price = it->first;
-            if (price < limit_price) break;
-            auto& queue = it->second;
-            while (!queue.empty() && remaining_qty > 0) {
-                auto& resting_order = queue.front();
-                double match_qty = std::min(remaining_qty, resting_order->getQuantity());
-                Trade trade;
-                trade.trade_id = std::to_string(rand());
-                trade.timestamp = order.getTimestamp();
-                trade.symbol = order.getSymbol();
-                trade.price = resting_order->getPrice();
-                trade.quantity = match_qty;
-                trade.aggressor_side = "sell";
-                trade.maker_order_id = resting_order->getOrderId();
-                trade.taker_order_id = order.getOrderId();
-                trades.push_back(trade);
-                remaining_qty -= match_qty;
-                double new_resting_qty = resting_order->getQuantity() - match_qty;
-                resting_order->setQuantity(new_resting_qty);
-                if (new_resting_qty == 0) {
-                    resting_order->setStatus(Order::Status::FILLED);
-                    queue.pop();
-                } else {
-                    resting_order->setStatus(Order::Status::PARTIALLY_FILLED);
-                }
-            }
-            if (queue.empty()) {
-                it = book->bids_.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        order.setStatus(Order::Status::FILLED);
     }
-    order.setStatus(Order::Status::FILLED);
+    finishMatch(order, trades, outcome, book);
     return trades;
-} 
\ No newline at end of file
+}
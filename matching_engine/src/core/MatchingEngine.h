@@ -1,32 +1,215 @@
 #pragma once
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <string>
 #include <map>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include "Order.h"
 #include "Trade.h"
+#include "Command.h"
 #include "OrderBook.h"
+#include "Quote.h"
+#include "RiskManager.h"
+#include "OutputBus.h"
 
 class MatchingEngine {
 public:
     using TradeCallback = std::function<void(const Trade&)>;
+    using BookUpdateCallback = std::function<void(const std::string& symbol)>;
+    using OrderCallback = std::function<void(const Order&)>;
+    using CommandCallback = std::function<void(Command&)>;
 
     MatchingEngine();
-    std::vector<Trade> processOrder(const Order& order);
+    // With a risk manager set, orders failing pre-trade checks are not matched:
+    // they come back REJECTED with no trades and the reason in *risk_reject.
+    // The returned trades include those of any stops the order triggered,
+    // in execution order; their taker_order_id names the stop.
+    std::vector<Trade> processOrder(const Order& order, RiskManager::Reject* risk_reject = nullptr);
+    // Applies a mass quote, symbol by symbol; both sides of a symbol change
+    // under one book lock. A side at an unchanged price and no larger size is
+    // amended in place and keeps its time priority; any other change pulls
+    // the old side and enters a new limit order, which may trade. Quote
+    // changes are reported only through `results` (one per entry), never the
+    // reduced-order callback. Returns the trades, as processOrder does.
+    std::vector<Trade> processQuote(const Quote& quote, std::vector<QuoteResult>& results);
+    // Removes a resting or parked stop order; false if it is no longer on the book
+    bool cancelOrder(const std::string& symbol, const std::string& order_id, Order::Side side, double price);
+    
+    // Call auction: from startAuction, orders for the symbol rest without
+    // matching (market, IOC and FOK orders are cancelled) and the book
+    // publishes its indicative uncross. uncross() executes everything that
+    // crosses at the volume-maximizing price, in price-time priority, then
+    // resumes continuous matching. Returns the trades; empty if no call ran.
+    void startAuction(const std::string& symbol);
+    std::vector<Trade> uncross(const std::string& symbol);
+
+    // Volatility circuit breaker: a fill outside the symbol's band stops the
+    // sweep at the last in-band level and moves the book into a call auction
+    // (a FOK that would need such a fill is killed instead). The default
+    // applies to books created afterwards; width 0 disables the band.
+    void setDefaultPriceBand(const PriceBand& band);
+    void setPriceBand(const std::string& symbol, const PriceBand& band);
+    // Uncrosses volatility auctions whose duration has run out by now_us.
+    // Call periodically; returns the number of books reopened.
+    std::size_t uncrossDue(int64_t now_us);
+
+    // Order-level market data: every book buffers a BookEvent per change to
+    // a resting order, for a consumer to drain with OrderBook::takeEvents()
+    // after each book update callback
+    void setBookEventsEnabled(bool enabled);
+
+    // Cancels resting GTT orders whose expire time, rounded up to the
+    // millisecond, is at or before now_us, reporting each through the
+    // reduced-order callback. Call periodically.
+    std::size_t expireOrders(int64_t now_us);
+    // Session end: cancels every resting DAY order. This and expireOrders()
+    // are no-ops on a replica, which expires what the primary journaled.
+    std::size_t endSession();
+
+    // Cancel every resting and parked order of an account or gateway session,
+    // in one symbol or (if empty) all. Cost is linear in the orders cancelled;
+    // each is reported through the reduced-order callback. Returns the count.
+    std::size_t cancelAllForAccount(const std::string& account, const std::string& symbol = "");
+    std::size_t cancelAllForSession(uint64_t session_id, const std::string& symbol = "");
     
     // Register callback for trade notifications
     void setOnTrade(const TradeCallback& callback);
+    // Called once per processed order or cancel, outside the book lock
+    void setOnBookUpdate(const BookUpdateCallback& callback);
+    // Called outside the book lock when the engine shrinks or cancels a
+    // resting order without a trade, e.g. self-trade prevention. The order
+    // shows its remaining quantity, and CANCELLED once it is off the book.
+    void setOnOrderReduced(const OrderCallback& callback);
+    // Every output also goes to the bus as one contiguous run of events per
+    // command, written after unlocking: trades, reduced orders, the order's
+    // final state (or its rejection) and a book update. Consumers run on their own threads,
+    // so adding one costs matching nothing. Set before accepting orders.
+    void setOutputBus(std::shared_ptr<OutputBus> bus);
+
+    // Enables pre-trade risk; call before accepting orders
+    void setRiskManager(std::shared_ptr<RiskManager> risk);
+
+    // Replication journal: called under the book lock with every command that
+    // changes a book, in the order it applied there; the journal stamps its
+    // sequence. Must not call back into the engine. Set before accepting orders.
+    void setOnCommand(const CommandCallback& callback);
+    // Replays a journaled command at its time_us. A replica applies one
+    // stream from one thread; risk limits are not enforced while it is one.
+    void apply(const Command& command);
+    void setReplica(bool replica);
+
+    // Book for a symbol, or nullptr if nothing has traded or rested there yet
+    std::shared_ptr<OrderBook> getBook(const std::string& symbol) const;
+
+    // Per-symbol book statistics for the metrics endpoint
+    std::vector<std::pair<std::string, OrderBook::Stats>> getBookStats() const;
     
     // Expose order books for WebSocket server
     std::map<std::string, std::shared_ptr<OrderBook>> order_books_;
 
 private:
-    std::vector<Trade> matchMarketOrder(Order& order);
-    std::vector<Trade> matchLimitOrder(Order& order);
-    std::vector<Trade> matchIOCOrder(Order& order);
-    std::vector<Trade> matchFOKOrder(Order& order);
+    // Guards insertion into order_books_; each book has its own mutex
+    mutable std::mutex books_mtx_;
+    PriceBand default_band_; // Guarded by books_mtx_
+    bool book_events_ = false; // Guarded by books_mtx_
+    std::shared_ptr<OrderBook> getOrCreateBook(const std::string& symbol);
+
+    // Side effects of matching beyond the trades themselves
+    struct MatchOutcome {
+        struct Reduced {
+            Order order;       // Snapshot after the change
+            double quantity;   // Removed without trading
+        };
+        bool taker_stopped = false; // Self-trade prevention cancelled the taker
+        bool halted = false;        // The sweep stopped at the price band
+        int64_t now_us = 0;         // Engine clock for the whole command
+        std::vector<Reduced> reduced;
+        std::size_t released = 0;   // Leading entries of reduced already released to risk
+        std::vector<Order> entered; // Quote sides entered or refused, for the output bus
+        std::vector<std::shared_ptr<Order>> triggered; // Stops fired by the trades, in parking order
+    };
+
+    // The match functions run with the book lock held by processOrder
+    std::vector<Trade> match(Order& order, OrderBook& book, MatchOutcome& outcome);
+    std::vector<Trade> matchMarketOrder(Order& order, OrderBook& book, MatchOutcome& outcome);
+    std::vector<Trade> matchLimitOrder(Order& order, OrderBook& book, MatchOutcome& outcome);
+    std::vector<Trade> matchIOCOrder(Order& order, OrderBook& book, MatchOutcome& outcome);
+    std::vector<Trade> matchFOKOrder(Order& order, OrderBook& book, MatchOutcome& outcome);
+    // Auction-phase entry: limit orders rest, everything else is cancelled
+    std::vector<Trade> accumulate(Order& order, OrderBook& book, MatchOutcome& outcome);
+    // Pairs crossing bids and asks off at one price; caller holds the book lock
+    void executeUncross(OrderBook& book, double price, int64_t now_us, std::vector<Trade>& trades);
+    // Runs the uncross and reopens the book; caller holds the book lock
+    void uncrossLocked(OrderBook& book, std::vector<Trade>& trades, MatchOutcome& outcome);
+    // Whether the last trade has already reached a stop's trigger price
+    bool stopReached(const Order& order, const OrderBook& book) const;
+
+    // The one fill loop: walks a side in price-time priority and returns the
+    // taker's unfilled quantity. Caller holds the book lock.
+    template <typename Levels>
+    double sweep(Order& order, Levels& levels, OrderBook& book, bool priced, std::vector<Trade>& trades, MatchOutcome& outcome);
+    // Quantity a FOK could take, honouring self-trade prevention and the price band
+    template <typename Levels>
+    double available(const Order& order, const Levels& levels, const OrderBook& book) const;
+    // Applies the taker's self-trade prevention mode to a resting order of the
+    // same account at the front of `queue`. Returns false if the taker stops.
+    bool preventSelfTrade(Order& taker, Order& maker, OrderQueue& queue, OrderBook& book, double& remaining_qty, MatchOutcome& outcome);
+
+    // Under the book lock: matches the stops collected in outcome.triggered,
+    // appending their trades
+    void runTriggered(OrderBook& book, std::vector<Trade>& trades, MatchOutcome& outcome);
+    using Outputs = std::optional<OutputBus::Batch>;
+    // Under the book lock: claims the command's output bus slots, so the bus
+    // sequence follows the book's order; a no-op without a bus
+    void claimOutputs(Outputs& outputs, std::size_t count);
+    // After unlocking: trade, reduced-order and book update callbacks, and
+    // the same into the claimed outputs after `order`'s state if one is given
+    void publish(const std::string& symbol, const std::vector<Trade>& trades, const MatchOutcome& outcome,
+                 Outputs& outputs, const Order* order = nullptr);
+
+    // Keeps or pulls an account's current quote side; true if a new order
+    // must be entered for it. Runs before anything else adds to `outcome`.
+    bool amendQuoteSide(OrderBook& book, const std::string& account, Order::Side side,
+                        double price, double quantity, QuoteSideResult& result, MatchOutcome& outcome);
+    void enterQuoteSide(OrderBook& book, const Quote& quote, Order::Side side, double price, double quantity,
+                        const std::string& order_id, uint64_t engine_id, QuoteSideResult& result,
+                        std::vector<Trade>& trades, MatchOutcome& outcome);
+
+    // Walks every book's expiry wheel; timers never require scanning levels
+    std::size_t expire(bool session_end, int64_t now_us);
+    // With `replayed`, expires those engine ids rather than what is due
+    std::size_t expireBook(OrderBook& book, bool session_end, int64_t now_us,
+                           const std::vector<uint64_t>* replayed = nullptr);
+    template <typename Take>
+    std::size_t massCancel(const std::string& symbol, const Command& command, Take take);
+    // One book, or every book if symbol is empty
+    std::vector<std::shared_ptr<OrderBook>> booksFor(const std::string& symbol) const;
+    // For orders already off the book: under its lock, then after unlocking
+    void settleCancelled(OrderBook& book, const std::vector<std::shared_ptr<Order>>& orders, Outputs& outputs);
+    void notifyCancelled(OrderBook& book, const std::vector<std::shared_ptr<Order>>& orders, Outputs& outputs);
+
+    // Under the book lock: sequence trades, collect triggered stops, settle
+    // risk, republish BBO
+    void finishMatch(Order& order, std::vector<Trade>& trades, MatchOutcome& outcome, OrderBook& book);
+
+    // A fresh engine id; a replica keeps the one the primary journaled
+    void assignEngineId(Order& order);
+    // Wall clock, or the command's time while a replica applies it
+    int64_t now() const;
+    // Under the book lock: hands a command to the journal, if one is set
+    void journal(Command& command, const OrderBook& book, int64_t now_us);
 
+    std::shared_ptr<RiskManager> risk_;
+    std::atomic<bool> replica_{false}; // Also read by the expiry driver
+    int64_t replay_time_us_ = 0;
+    std::atomic<uint64_t> last_engine_id_{0};
+    CommandCallback on_command_cb_;
     TradeCallback on_trade_cb_;
+    BookUpdateCallback on_book_update_cb_;
+    OrderCallback on_order_reduced_cb_;
+    std::shared_ptr<OutputBus> output_;
     void notifyTrade(const Trade& trade);
 }; 
\ No newline at end of file
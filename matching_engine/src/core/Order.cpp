@@ -1,4 +1,5 @@
 #include "Order.h"
+#include <algorithm>
 
 Order::Order(const std::string& order_id,
              const std::string& symbol,
@@ -18,6 +19,56 @@ double Order::getQuantity() const { return quantity_; }
 double Order::getPrice() const { return price_; }
 const std::string& Order::getTimestamp() const { return timestamp_; }
 Order::Status Order::getStatus() const { return status_; }
+const std::string& Order::getAccount() const { return account_; }
+Order::SelfTradePrevention Order::getSelfTradePrevention() const { return stp_; }
+double Order::getDisplayQuantity() const { return display_quantity_; }
+double Order::getReserveQuantity() const { return reserve_quantity_; }
+double Order::getLeavesQuantity() const { return quantity_ + reserve_quantity_; }
+double Order::getStopPrice() const { return stop_price_; }
+bool Order::isStop() const { return type_ == Type::STOP || type_ == Type::STOP_LIMIT; }
+Order::TimeInForce Order::getTimeInForce() const { return tif_; }
+int64_t Order::getExpireTime() const { return expire_time_us_; }
+uint32_t Order::getExpiryTimer() const { return expiry_timer_; }
+uint64_t Order::getSessionId() const { return session_id_; }
+uint64_t Order::getEngineId() const { return engine_id_; }
+bool Order::isQuote() const { return quote_; }
+Order::BookLinks& Order::bookLinks() { return links_; }
+const Order::BookLinks& Order::bookLinks() const { return links_; }
 
 void Order::setStatus(Status status) { status_ = status; }
-void Order::setQuantity(double quantity) { quantity_ = quantity; } 
\ No newline at end of file
+void Order::setQuantity(double quantity) { quantity_ = quantity; }
+void Order::setAccount(const std::string& account) { account_ = account; }
+void Order::setSelfTradePrevention(SelfTradePrevention mode) { stp_ = mode; }
+void Order::setDisplayQuantity(double display_quantity) { display_quantity_ = display_quantity; }
+void Order::setStopPrice(double stop_price) { stop_price_ = stop_price; }
+void Order::setTimeInForce(TimeInForce tif, int64_t expire_time_us) {
+    tif_ = tif;
+    expire_time_us_ = expire_time_us;
+}
+void Order::setExpiryTimer(uint32_t handle) { expiry_timer_ = handle; }
+void Order::setSessionId(uint64_t session_id) { session_id_ = session_id; }
+void Order::setEngineId(uint64_t engine_id) { engine_id_ = engine_id; }
+void Order::setQuote(bool quote) { quote_ = quote; }
+
+void Order::trigger() {
+    if (type_ == Type::STOP) {
+        type_ = Type::MARKET;
+    } else if (type_ == Type::STOP_LIMIT) {
+        type_ = Type::LIMIT;
+    }
+}
+
+void Order::splitReserve() {
+    if (display_quantity_ > 0 && quantity_ > display_quantity_) {
+        reserve_quantity_ += quantity_ - display_quantity_;
+        quantity_ = display_quantity_;
+    }
+}
+
+bool Order::replenish() {
+    if (reserve_quantity_ <= 0) return false;
+    double slice = std::min(display_quantity_, reserve_quantity_);
+    quantity_ += slice;
+    reserve_quantity_ -= slice;
+    return true;
+}
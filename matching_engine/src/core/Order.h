@@ -2,12 +2,20 @@
 #include <string>
 #include <cstdint>
 #include <chrono>
+#include <list>
+#include <memory>
 
 class Order {
 public:
-    enum class Type { MARKET, LIMIT, IOC, FOK };
+    // STOP and STOP_LIMIT park until a trade reaches the stop price, then
+    // become MARKET and LIMIT respectively
+    enum class Type { MARKET, LIMIT, IOC, FOK, STOP, STOP_LIMIT };
     enum class Side { BUY, SELL };
-    enum class Status { NEW, PARTIALLY_FILLED, FILLED, CANCELLED };
+    enum class Status { NEW, PARTIALLY_FILLED, FILLED, CANCELLED, REJECTED };
+    // GTT rests until its expire time, DAY until the session ends
+    enum class TimeInForce { GTC, GTT, DAY };
+    // What happens when this order would trade against its own account
+    enum class SelfTradePrevention { NONE, CANCEL_TAKER, CANCEL_MAKER, CANCEL_BOTH, DECREMENT };
 
     Order(const std::string& order_id,
           const std::string& symbol,
@@ -22,14 +30,59 @@ public:
     const std::string& getSymbol() const;
     Type getType() const;
     Side getSide() const;
-    double getQuantity() const;
+    double getQuantity() const; // Displayed quantity while an iceberg rests
     double getPrice() const;
     const std::string& getTimestamp() const;
     Status getStatus() const;
+    const std::string& getAccount() const; // Empty if the order carries no account
+    SelfTradePrevention getSelfTradePrevention() const;
+    double getDisplayQuantity() const; // Iceberg peak size; 0 shows everything
+    double getReserveQuantity() const; // Hidden behind the displayed slice
+    double getLeavesQuantity() const;  // Displayed plus reserve
+    double getStopPrice() const;
+    bool isStop() const; // Not yet triggered
+    TimeInForce getTimeInForce() const;
+    int64_t getExpireTime() const; // Microseconds since the epoch; GTT only
+    uint32_t getExpiryTimer() const; // Book's timer handle while resting
+    uint64_t getSessionId() const; // Gateway session that entered it; 0 if none
+    uint64_t getEngineId() const;  // Unique per engine, assigned on entry; 0 before
+    bool isQuote() const; // One side of its account's two-sided quote
 
     // Setters
     void setStatus(Status status);
     void setQuantity(double quantity);
+    void setAccount(const std::string& account);
+    void setSelfTradePrevention(SelfTradePrevention mode);
+    void setDisplayQuantity(double display_quantity);
+    void setStopPrice(double stop_price);
+    void setTimeInForce(TimeInForce tif, int64_t expire_time_us = 0);
+    void setExpiryTimer(uint32_t handle);
+    void setSessionId(uint64_t session_id);
+    void setEngineId(uint64_t engine_id);
+    void setQuote(bool quote);
+
+    // Maintained by the book holding this order while it rests or is parked
+    // there; meaningless on any other copy. The owner lists are intrusive so
+    // an account's or session's orders can be pulled without searching.
+    enum OwnerList { ACCOUNT_LIST, SESSION_LIST, OWNER_LISTS };
+    struct BookLinks {
+        std::list<std::shared_ptr<Order>>::iterator level; // Position in its price level
+        Order* prev[OWNER_LISTS] = {};
+        Order* next[OWNER_LISTS] = {};
+        bool linked = false;
+        uint64_t ref = 0;      // Public order-level id, assigned when it rests
+        uint64_t priority = 0; // Queue position: lower is ahead at the same price
+    };
+    BookLinks& bookLinks();
+    const BookLinks& bookLinks() const;
+    // Converts a triggered stop into the order it releases
+    void trigger();
+
+    // Iceberg handling, called by the book when the order rests. splitReserve()
+    // hides everything above the display quantity; replenish() refills an
+    // exhausted slice from the reserve and returns false once none is left.
+    void splitReserve();
+    bool replenish();
 
 private:
     std::string order_id_;
@@ -40,4 +93,16 @@ private:
     double price_;
     std::string timestamp_;
     Status status_;
+    std::string account_;
+    SelfTradePrevention stp_ = SelfTradePrevention::CANCEL_TAKER;
+    double display_quantity_ = 0.0;
+    double reserve_quantity_ = 0.0;
+    double stop_price_ = 0.0;
+    TimeInForce tif_ = TimeInForce::GTC;
+    int64_t expire_time_us_ = 0;
+    uint32_t expiry_timer_ = UINT32_MAX;
+    uint64_t session_id_ = 0;
+    uint64_t engine_id_ = 0;
+    bool quote_ = false;
+    BookLinks links_;
 }; 
\ No newline at end of file
@@ -1,71 +1,262 @@
 #include "OrderBook.h"
 #include <algorithm>
+#include <cmath>
 #include <nlohmann/json.hpp>
+#include "../utils/Utils.h"
 
-OrderBook::OrderBook(const std::string& symbol) : symbol_(symbol), best_bid_(0.0), best_ask_(0.0) {}
+namespace {
+    // Erases an order through its recorded position, dropping the level if
+    // it empties; no other order is visited
+    template <typename Levels>
+    std::shared_ptr<Order> eraseFromLevel(Levels& levels, Order& order) {
+        auto level = levels.find(order.getPrice());
+        if (level == levels.end()) return nullptr;
+        std::shared_ptr<Order> found = *order.bookLinks().level;
+        level->second.erase(order.bookLinks().level);
+        if (level->second.empty()) levels.erase(level);
+        return found;
+    }
+
+    void pushOwner(Order*& head, Order& order, int list) {
+        auto& links = order.bookLinks();
+        links.prev[list] = nullptr;
+        links.next[list] = head;
+        if (head) head->bookLinks().prev[list] = &order;
+        head = &order;
+    }
+
+    // Returns true if the list is now empty
+    bool unlinkOwner(Order*& head, Order& order, int list) {
+        auto& links = order.bookLinks();
+        if (links.prev[list]) {
+            links.prev[list]->bookLinks().next[list] = links.next[list];
+        } else {
+            head = links.next[list];
+        }
+        if (links.next[list]) links.next[list]->bookLinks().prev[list] = links.prev[list];
+        links.prev[list] = links.next[list] = nullptr;
+        return head == nullptr;
+    }
+}
+
+OrderBook::OrderBook(const std::string& symbol) : expiries_(Utils::nowMicros()), symbol_(symbol) {}
 
 void OrderBook::addOrder(const std::shared_ptr<Order>& order) {
     std::lock_guard<std::mutex> lock(mtx_);
+    restOrder(order);
+}
+
+void OrderBook::restOrder(const std::shared_ptr<Order>& order) {
+    // Assumes mtx_ is already locked
+    order->splitReserve();
+    auto& links = order->bookLinks();
+    links.ref = links.priority = ++next_priority_;
     if (order->getSide() == Order::Side::BUY) {
-        bids_[order->getPrice()].push(order);
-        if (order->getPrice() > best_bid_ || best_bid_ == 0.0) {
-            best_bid_ = order->getPrice();
-        }
+        links.level = bids_[order->getPrice()].pushBack(order);
     } else {
-        asks_[order->getPrice()].push(order);
-        if (best_ask_ == 0.0 || order->getPrice() < best_ask_) {
-            best_ask_ = order->getPrice();
-        }
+        links.level = asks_[order->getPrice()].pushBack(order);
+    }
+    recordEvent(BookEvent::Type::ADD, *order, order->getQuantity());
+    linkOwners(*order);
+    if (order->isQuote()) {
+        quotes_[order->getAccount()][static_cast<std::size_t>(order->getSide())] = order;
     }
+    if (order->getTimeInForce() == Order::TimeInForce::GTT) {
+        order->setExpiryTimer(expiries_.schedule(order->getExpireTime(), order));
+    } else if (order->getTimeInForce() == Order::TimeInForce::DAY) {
+        order->setExpiryTimer(expiries_.schedule(ExpiryWheel::kSessionEnd, order));
+    }
+    if (order->getTimeInForce() != Order::TimeInForce::GTC) timed_orders_[order->getEngineId()] = order.get();
+    updateBBO();
     notifyChange();
 }
 
-void OrderBook::removeOrder(const std::string& order_id, Order::Side side, double price) {
+std::shared_ptr<Order> OrderBook::removeOrder(const std::string& order_id, Order::Side side, double price) {
     std::lock_guard<std::mutex> lock(mtx_);
-    if (side == Order::Side::BUY) {
-        auto it = bids_.find(price);
-        if (it != bids_.end()) {
-            std::queue<std::shared_ptr<Order>>& q = it->second;
-            std::queue<std::shared_ptr<Order>> new_q;
-            while (!q.empty()) {
-                auto o = q.front();
-                q.pop();
-                if (o->getOrderId() != order_id) {
-                    new_q.push(o);
-                }
-            }
-            if (new_q.empty()) {
-                bids_.erase(it);
-            } else {
-                it->second = std::move(new_q);
-            }
+    std::shared_ptr<Order> found = takeOrder(order_id, side, price);
+    if (found) notifyChange();
+    return found;
+}
+
+std::shared_ptr<Order> OrderBook::takeOrder(const std::string& order_id, Order::Side side, double price) {
+    // Assumes mtx_ is already locked
+    auto take = [&](auto& levels) -> std::shared_ptr<Order> {
+        auto level = levels.find(price);
+        if (level == levels.end()) return nullptr;
+        for (const auto& order : level->second) {
+            if (order->getOrderId() == order_id) return eraseFromLevel(levels, *order);
         }
+        return nullptr;
+    };
+    std::shared_ptr<Order> found = side == Order::Side::BUY ? take(bids_) : take(asks_);
+    if (!found) return nullptr;
+    unlinkOrder(*found);
+    updateBBO();
+    return found;
+}
+
+bool OrderBook::removeResting(const std::shared_ptr<Order>& order) {
+    // Assumes mtx_ is already locked
+    if (!order->bookLinks().linked) return false;
+    auto found = order->getSide() == Order::Side::BUY ? eraseFromLevel(bids_, *order)
+                                                      : eraseFromLevel(asks_, *order);
+    unlinkOrder(*order);
+    return found != nullptr;
+}
+
+void OrderBook::unlinkOrder(Order& order) {
+    // Assumes mtx_ is already locked
+    recordEvent(BookEvent::Type::DELETE, order, order.getQuantity());
+    unlinkOwners(order);
+    if (order.getTimeInForce() != Order::TimeInForce::GTC) timed_orders_.erase(order.getEngineId());
+    if (order.getExpiryTimer() == ExpiryWheel::kNone) return;
+    expiries_.cancel(order.getExpiryTimer());
+    order.setExpiryTimer(ExpiryWheel::kNone);
+}
+
+void OrderBook::takeTimed(const std::vector<uint64_t>& engine_ids, std::vector<std::shared_ptr<Order>>& out) {
+    // Assumes mtx_ is already locked
+    for (uint64_t id : engine_ids) {
+        auto it = timed_orders_.find(id);
+        if (it == timed_orders_.end()) continue;
+        Order& order = *it->second;
+        std::shared_ptr<Order> taken;
+        if (!expiries_.take(order.getExpiryTimer(), taken)) continue;
+        order.setExpiryTimer(ExpiryWheel::kNone);
+        out.push_back(std::move(taken));
+    }
+}
+
+void OrderBook::reduceResting(Order& order, double quantity) {
+    // Assumes mtx_ is already locked
+    if (order.getSide() == Order::Side::BUY) {
+        bids_[order.getPrice()].reduce(order.bookLinks().level, quantity);
     } else {
-        auto it = asks_.find(price);
-        if (it != asks_.end()) {
-            std::queue<std::shared_ptr<Order>>& q = it->second;
-            std::queue<std::shared_ptr<Order>> new_q;
-            while (!q.empty()) {
-                auto o = q.front();
-                q.pop();
-                if (o->getOrderId() != order_id) {
-                    new_q.push(o);
-                }
-            }
-            if (new_q.empty()) {
-                asks_.erase(it);
-            } else {
-                it->second = std::move(new_q);
-            }
+        asks_[order.getPrice()].reduce(order.bookLinks().level, quantity);
+    }
+    recordEvent(BookEvent::Type::MODIFY, order, order.getQuantity());
+}
+
+void OrderBook::executeFront(OrderQueue& queue, double quantity) {
+    // Assumes mtx_ is already locked
+    queue.reduceFront(quantity);
+    recordEvent(BookEvent::Type::EXECUTE, *queue.front(), quantity);
+}
+
+void OrderBook::reduceFront(OrderQueue& queue, double quantity) {
+    // Assumes mtx_ is already locked
+    queue.reduceFront(quantity);
+    recordEvent(BookEvent::Type::MODIFY, *queue.front(), queue.front()->getQuantity());
+}
+
+bool OrderBook::refillFront(OrderQueue& queue) {
+    // Assumes mtx_ is already locked
+    if (!queue.refillFront()) return false;
+    Order& order = *queue.back();
+    order.bookLinks().priority = ++next_priority_;
+    recordEvent(BookEvent::Type::MODIFY, order, order.getQuantity());
+    return true;
+}
+
+std::shared_ptr<Order> OrderBook::quoteSlot(const std::string& account, Order::Side side) const {
+    // Assumes mtx_ is already locked
+    auto it = quotes_.find(account);
+    return it == quotes_.end() ? nullptr : it->second[static_cast<std::size_t>(side)];
+}
+
+void OrderBook::parkStop(const std::shared_ptr<Order>& order) {
+    // Assumes mtx_ is already locked
+    stops_.add(order);
+    linkOwners(*order);
+}
+
+std::shared_ptr<Order> OrderBook::removeStop(uint64_t engine_id) {
+    // Assumes mtx_ is already locked
+    auto found = stops_.remove(engine_id);
+    if (found) unlinkOwners(*found);
+    return found;
+}
+
+std::shared_ptr<Order> OrderBook::removeStop(const std::string& order_id, Order::Side side) {
+    // Assumes mtx_ is already locked
+    auto found = stops_.remove(order_id, side);
+    if (found) unlinkOwners(*found);
+    return found;
+}
+
+void OrderBook::triggerStops(double low, double high, std::vector<std::shared_ptr<Order>>& out) {
+    // Assumes mtx_ is already locked
+    std::size_t first = out.size();
+    stops_.collectTriggered(low, high, out);
+    for (std::size_t i = first; i < out.size(); ++i) unlinkOwners(*out[i]);
+}
+
+void OrderBook::takeAccountOrders(const std::string& account, std::vector<std::shared_ptr<Order>>& out) {
+    // Assumes mtx_ is already locked
+    auto it = account_orders_.find(account);
+    if (it != account_orders_.end()) takeOwned(it->second, Order::ACCOUNT_LIST, out);
+}
+
+void OrderBook::takeSessionOrders(uint64_t session_id, std::vector<std::shared_ptr<Order>>& out) {
+    // Assumes mtx_ is already locked
+    auto it = session_orders_.find(session_id);
+    if (it != session_orders_.end()) takeOwned(it->second, Order::SESSION_LIST, out);
+}
+
+void OrderBook::takeOwned(Order* head, int list, std::vector<std::shared_ptr<Order>>& out) {
+    // Unlinking may erase the list's map entry; only the saved next pointer is used
+    for (Order* order = head; order;) {
+        Order* next = order->bookLinks().next[list];
+        std::shared_ptr<Order> taken;
+        if (order->isStop()) {
+            taken = removeStop(order->getEngineId());
+        } else {
+            taken = order->getSide() == Order::Side::BUY ? eraseFromLevel(bids_, *order)
+                                                         : eraseFromLevel(asks_, *order);
+            unlinkOrder(*order);
         }
+        if (taken) out.push_back(std::move(taken));
+        order = next;
+    }
+}
+
+void OrderBook::linkOwners(Order& order) {
+    order.bookLinks().linked = true;
+    if (!order.getAccount().empty()) pushOwner(account_orders_[order.getAccount()], order, Order::ACCOUNT_LIST);
+    if (order.getSessionId() != 0) pushOwner(session_orders_[order.getSessionId()], order, Order::SESSION_LIST);
+}
+
+void OrderBook::unlinkOwners(Order& order) {
+    if (!order.bookLinks().linked) return;
+    order.bookLinks().linked = false;
+    if (!order.getAccount().empty()) {
+        auto it = account_orders_.find(order.getAccount());
+        if (it != account_orders_.end() && unlinkOwner(it->second, order, Order::ACCOUNT_LIST)) {
+            account_orders_.erase(it);
+        }
+    }
+    if (order.getSessionId() != 0) {
+        auto it = session_orders_.find(order.getSessionId());
+        if (it != session_orders_.end() && unlinkOwner(it->second, order, Order::SESSION_LIST)) {
+            session_orders_.erase(it);
+        }
+    }
+    if (order.isQuote()) {
+        auto it = quotes_.find(order.getAccount());
+        if (it == quotes_.end()) return;
+        auto& slot = it->second[static_cast<std::size_t>(order.getSide())];
+        if (slot.get() == &order) slot.reset();
+        if (!it->second[0] && !it->second[1]) quotes_.erase(it);
     }
-    updateBBO();
-    notifyChange();
 }
 
 std::pair<double, double> OrderBook::getBBO() const {
-    std::lock_guard<std::mutex> lock(mtx_);
-    return {best_bid_, best_ask_};
+    TopOfBook top = bbo_.load();
+    return {top.bid_price, top.ask_price};
+}
+
+TopOfBook OrderBook::getTopOfBook() const {
+    return bbo_.load();
 }
 
 std::vector<std::pair<double, double>> OrderBook::getDepth(Order::Side side, int levels) const {
@@ -76,12 +267,7 @@ std::vector<std::pair<double, double>> OrderBook::getDepth(Order::Side side, int
         for (const auto& entry : bids_) {
             double price = entry.first;
             const auto& queue = entry.second;
-            double qty = 0.0;
-            std::queue<std::shared_ptr<Order>> q = queue;
-            while (!q.empty()) {
-                qty += q.front()->getQuantity();
-                q.pop();
-            }
+            double qty = queue.quantity();
             depth.emplace_back(price, qty);
             if (++count >= levels) break;
         }
@@ -90,12 +276,7 @@ std::vector<std::pair<double, double>> OrderBook::getDepth(Order::Side side, int
         for (const auto& entry : asks_) {
             double price = entry.first;
             const auto& queue = entry.second;
-            double qty = 0.0;
-            std::queue<std::shared_ptr<Order>> q = queue;
-            while (!q.empty()) {
-                qty += q.front()->getQuantity();
-                q.pop();
-            }
+            double qty = queue.quantity();
             depth.emplace_back(price, qty);
             if (++count >= levels) break;
         }
@@ -115,12 +296,7 @@ std::string OrderBook::getMarketDepth(int levels) const {
     for (const auto& entry : asks_) {
         if (count++ >= levels) break;
         double price = entry.first;
-        double qty = 0.0;
-        std::queue<std::shared_ptr<Order>> q = entry.second;
-        while (!q.empty()) {
-            qty += q.front()->getQuantity();
-            q.pop();
-        }
+        double qty = entry.second.quantity();
         j["asks"].push_back({nlohmann::json::array({price, qty})});
     }
     // Bids (price descending)
@@ -128,12 +304,7 @@ std::string OrderBook::getMarketDepth(int levels) const {
     for (const auto& entry : bids_) {
         if (count++ >= levels) break;
         double price = entry.first;
-        double qty = 0.0;
-        std::queue<std::shared_ptr<Order>> q = entry.second;
-        while (!q.empty()) {
-            qty += q.front()->getQuantity();
-            q.pop();
-        }
+        double qty = entry.second.quantity();
         j["bids"].push_back({nlohmann::json::array({price, qty})});
     }
     return j.dump();
@@ -147,36 +318,289 @@ std::string OrderBook::getSnapshot() const {
     j["asks"] = nlohmann::json::array();
     for (const auto& entry : bids_) {
         double price = entry.first;
-        double qty = 0.0;
-        std::queue<std::shared_ptr<Order>> q = entry.second;
-        while (!q.empty()) {
-            qty += q.front()->getQuantity();
-            q.pop();
-        }
+        double qty = entry.second.quantity();
         j["bids"].push_back({nlohmann::json::array({price, qty})});
     }
     for (const auto& entry : asks_) {
         double price = entry.first;
-        double qty = 0.0;
-        std::queue<std::shared_ptr<Order>> q = entry.second;
-        while (!q.empty()) {
-            qty += q.front()->getQuantity();
-            q.pop();
-        }
+        double qty = entry.second.quantity();
         j["asks"].push_back({nlohmann::json::array({price, qty})});
     }
     return j.dump();
 }
 
+std::string OrderBook::getTopOfBookJSON() const {
+    TopOfBook top = bbo_.load();
+    nlohmann::json j;
+    j["symbol"] = symbol_;
+    j["bid_price"] = top.bid_price;
+    j["bid_size"] = top.bid_size;
+    j["ask_price"] = top.ask_price;
+    j["ask_size"] = top.ask_size;
+    j["last_price"] = top.last_price;
+    j["sequence"] = top.sequence;
+    return j.dump();
+}
+
+const TradeTape& OrderBook::getTradeTape() const {
+    return tape_;
+}
+
+std::string OrderBook::getRecentTradesJSON(uint64_t since, std::size_t limit) const {
+    // Read the head first so last_sequence never runs ahead of the entries
+    uint64_t last = tape_.lastSequence();
+    std::string out = "{\"symbol\":" + nlohmann::json(symbol_).dump() + ",\"trades\":[";
+    bool first = true;
+    for (const auto& entry : tape_.since(since, limit)) {
+        if (entry.sequence > last) break;
+        if (!first) out += ',';
+        out += entry.toJSON(symbol_);
+        first = false;
+    }
+    out += "],\"last_sequence\":" + std::to_string(last) + "}";
+    return out;
+}
+
+void OrderBook::recordTrades(std::vector<Trade>& trades, int64_t now_us) {
+    // Assumes mtx_ is already locked, so appends stay in match order
+    for (auto& trade : trades) tape_.append(trade);
+    if (trades.empty()) return;
+    last_trade_price_ = trades.back().price;
+    if (band_.width <= 0.0) return;
+    // Decay the accumulated weight once per batch, then fold each fill in
+    // with weight 1, so the reference is the weighted mean of every fill
+    double keep = std::exp2(-static_cast<double>(now_us - reference_time_us_) / static_cast<double>(band_.half_life_us));
+    double weight = reference_price_ > 0.0 ? reference_weight_ * keep : 0.0;
+    double sum = reference_price_ * weight;
+    for (const auto& trade : trades) {
+        sum += trade.price;
+        weight += 1.0;
+    }
+    reference_price_ = sum / weight;
+    reference_weight_ = weight;
+    reference_time_us_ = now_us;
+    updateBandLimits();
+}
+
+void OrderBook::setPriceBand(const PriceBand& band) {
+    // Assumes mtx_ is already locked
+    band_ = band;
+    if (band_.half_life_us <= 0) band_.half_life_us = 1;
+    updateBandLimits();
+}
+
+bool OrderBook::withinBand(double price) const {
+    return price >= band_low_ && price <= band_high_;
+}
+
+void OrderBook::haltForVolatility(int64_t now_us) {
+    // Assumes mtx_ is already locked
+    if (phase_ == Phase::AUCTION) return;
+    setPhase(Phase::AUCTION);
+    auction_end_us_ = band_.auction_us > 0 ? now_us + band_.auction_us : 0;
+}
+
+int64_t OrderBook::auctionEnd() const {
+    // Assumes mtx_ is already locked
+    return phase_ == Phase::AUCTION ? auction_end_us_ : 0;
+}
+
+void OrderBook::resetReference(double price, int64_t now_us) {
+    // Assumes mtx_ is already locked. Keeps the accumulated weight, so the
+    // new price carries the trades already folded in
+    reference_price_ = price;
+    if (reference_weight_ <= 0.0) reference_weight_ = 1.0;
+    reference_time_us_ = now_us;
+    updateBandLimits();
+}
+
+void OrderBook::updateBandLimits() {
+    if (band_.width <= 0.0 || reference_price_ <= 0.0) {
+        band_low_ = 0.0;
+        band_high_ = std::numeric_limits<double>::max();
+        return;
+    }
+    band_low_ = reference_price_ * (1.0 - band_.width);
+    band_high_ = reference_price_ * (1.0 + band_.width);
+}
+
+const std::string& OrderBook::getSymbol() const {
+    return symbol_;
+}
+
+OrderBook::Stats OrderBook::getStats() const {
+    // Per-node costs are approximations of libstdc++ layouts: an rb-tree node
+    // header per level, and a make_shared control block plus a list node per order.
+    constexpr std::size_t kMapNodeOverhead = 4 * sizeof(void*);
+    constexpr std::size_t kListNode = 2 * sizeof(void*) + sizeof(std::shared_ptr<Order>);
+    constexpr std::size_t kOrderBytes = sizeof(Order) + 2 * sizeof(void*) + kListNode;
+    using Level = std::pair<const double, OrderQueue>;
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    Stats stats;
+    stats.bid_levels = bids_.size();
+    stats.ask_levels = asks_.size();
+    for (const auto& entry : bids_) stats.resting_orders += entry.second.size();
+    for (const auto& entry : asks_) stats.resting_orders += entry.second.size();
+    std::size_t levels = stats.bid_levels + stats.ask_levels;
+    stats.memory_bytes = levels * (sizeof(Level) + kMapNodeOverhead)
+                       + stats.resting_orders * kOrderBytes;
+    return stats;
+}
+
 void OrderBook::setOnOrderBookChange(const std::function<void()>& cb) {
     std::lock_guard<std::mutex> lock(mtx_);
     on_change_cb_ = cb;
 }
 
+void OrderBook::setEventsEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    events_enabled_ = enabled;
+    if (!enabled) events_.clear();
+}
+
+void OrderBook::takeEvents(std::vector<BookEvent>& out, std::vector<L3Order>* snapshot) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    out.insert(out.end(), std::make_move_iterator(events_.begin()), std::make_move_iterator(events_.end()));
+    events_.clear();
+    if (!snapshot) return;
+    auto list = [snapshot](const auto& levels) {
+        for (const auto& level : levels) {
+            for (const auto& order : level.second) {
+                const auto& links = order->bookLinks();
+                snapshot->push_back({links.ref, links.priority, order->getSide(), level.first, order->getQuantity()});
+            }
+        }
+    };
+    list(bids_);
+    list(asks_);
+}
+
+void OrderBook::recordEvent(BookEvent::Type type, const Order& order, double quantity) {
+    // Assumes mtx_ is already locked; one branch when nobody consumes L3
+    if (!events_enabled_) return;
+    const auto& links = order.bookLinks();
+    events_.push_back({type, order.getSide(), links.ref, links.priority, order.getPrice(), quantity, {}, 0});
+    if (type == BookEvent::Type::ADD) {
+        events_.back().order_id = order.getOrderId();
+        events_.back().engine_id = order.getEngineId();
+    }
+}
+
+OrderBook::Phase OrderBook::getPhase() const {
+    // Assumes mtx_ is already locked
+    return phase_;
+}
+
+void OrderBook::setPhase(Phase phase) {
+    // Assumes mtx_ is already locked
+    phase_ = phase;
+    auction_end_us_ = 0; // Set by haltForVolatility when the call is timed
+    publishAuction();
+}
+
+AuctionState OrderBook::equilibrium() const {
+    // Assumes mtx_ is already locked
+    AuctionState state;
+    state.active = phase_ == Phase::AUCTION;
+    if (bids_.empty() || asks_.empty() || bids_.begin()->first < asks_.begin()->first) return state;
+    const double low = asks_.begin()->first;
+    const double high = bids_.begin()->first;
+
+    // Cumulative demand at or above each crossed bid level (walking down) and
+    // supply at or below each crossed ask level (walking up), reserves included
+    std::vector<std::pair<double, double>>& demand = demand_;
+    std::vector<std::pair<double, double>>& supply = supply_;
+    demand.clear();
+    supply.clear();
+    double cumulative = 0.0;
+    for (auto it = bids_.begin(); it != bids_.end() && it->first >= low; ++it) {
+        cumulative += it->second.leavesQuantity();
+        demand.emplace_back(it->first, cumulative);
+    }
+    cumulative = 0.0;
+    for (auto it = asks_.begin(); it != asks_.end() && it->first <= high; ++it) {
+        cumulative += it->second.leavesQuantity();
+        supply.emplace_back(it->first, cumulative);
+    }
+
+    // One merged walk up the candidate prices. Ties go to the least
+    // imbalance, then the price nearest the last trade (or the crossed
+    // range's middle before any trade), then the lower price.
+    const double reference = last_trade_price_ > 0.0 ? last_trade_price_ : (low + high) / 2.0;
+    std::size_t next_ask = 0;
+    std::size_t lowest_bid = demand.size(); // demand[lowest_bid - 1] is the lowest bid still >= price
+    double supply_at = 0.0;
+    while (next_ask < supply.size() || lowest_bid > 0) {
+        double price = lowest_bid == 0 || (next_ask < supply.size() && supply[next_ask].first <= demand[lowest_bid - 1].first)
+            ? supply[next_ask].first : demand[lowest_bid - 1].first;
+        while (next_ask < supply.size() && supply[next_ask].first <= price) supply_at = supply[next_ask++].second;
+        double demand_at = lowest_bid > 0 ? demand[lowest_bid - 1].second : 0.0;
+
+        double volume = std::min(demand_at, supply_at);
+        double imbalance = demand_at - supply_at;
+        bool better = volume > state.volume;
+        if (!better && volume == state.volume && volume > 0.0) {
+            double a = std::abs(imbalance), b = std::abs(state.imbalance);
+            better = a < b || (a == b && std::abs(price - reference) < std::abs(state.price - reference));
+        }
+        if (better) {
+            state.price = price;
+            state.volume = volume;
+            state.imbalance = imbalance;
+        }
+        // Bids at this price take no part in any higher one
+        while (lowest_bid > 0 && demand[lowest_bid - 1].first <= price) --lowest_bid;
+    }
+    return state;
+}
+
+void OrderBook::publishAuction() {
+    // Assumes mtx_ is already locked
+    AuctionState state = phase_ == Phase::AUCTION ? equilibrium() : AuctionState{};
+    if (state.active == auction_.active && state.price == auction_.price &&
+        state.volume == auction_.volume && state.imbalance == auction_.imbalance) {
+        return;
+    }
+    state.sequence = auction_.sequence + 1;
+    auction_ = state;
+    auction_state_.store(state);
+}
+
+AuctionState OrderBook::getAuctionState() const {
+    return auction_state_.load();
+}
+
+std::string OrderBook::getAuctionStateJSON() const {
+    AuctionState state = getAuctionState();
+    nlohmann::json j;
+    j["symbol"] = symbol_;
+    j["phase"] = state.active ? "auction" : "continuous";
+    j["indicative_price"] = state.price;
+    j["indicative_volume"] = state.volume;
+    j["imbalance"] = state.imbalance;
+    j["sequence"] = state.sequence;
+    return j.dump();
+}
+
 void OrderBook::updateBBO() {
     // Assumes mtx_ is already locked
-    best_bid_ = bids_.empty() ? 0.0 : bids_.begin()->first;
-    best_ask_ = asks_.empty() ? 0.0 : asks_.begin()->first;
+    // Once per command, under the lock it already holds; readers stay lock-free
+    if (phase_ == Phase::AUCTION) publishAuction();
+    TopOfBook top = top_;
+    top.bid_price = bids_.empty() ? 0.0 : bids_.begin()->first;
+    top.bid_size = bids_.empty() ? 0.0 : bids_.begin()->second.quantity();
+    top.ask_price = asks_.empty() ? 0.0 : asks_.begin()->first;
+    top.ask_size = asks_.empty() ? 0.0 : asks_.begin()->second.quantity();
+    top.last_price = last_trade_price_;
+    if (top.bid_price == top_.bid_price && top.bid_size == top_.bid_size &&
+        top.ask_price == top_.ask_price && top.ask_size == top_.ask_size &&
+        top.last_price == top_.last_price) {
+        return; // Unchanged; don't wake pollers
+    }
+    ++top.sequence;
+    top_ = top;
+    bbo_.store(top);
 }
 
 void OrderBook::notifyChange() {
@@ -1,37 +1,261 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <list>
 #include <map>
 #include <queue>
+#include <unordered_map>
 #include <memory>
 #include <mutex>
 #include <vector>
 #include <functional>
+#include <limits>
 #include <string>
 #include "Order.h"
+#include "Trade.h"
+#include "TradeTape.h"
+#include "StopBook.h"
+#include "../utils/Seqlock.h"
+#include "../utils/TimerWheel.h"
+
+// FIFO of resting orders at one price. List-backed so an order can leave
+// from anywhere in O(1) through the position recorded in its BookLinks, and
+// iterable for depth views. The level's visible and hidden (iceberg reserve)
+// quantities are kept as running totals, so resting quantities change only
+// through this class.
+class OrderQueue : public std::queue<std::shared_ptr<Order>, std::list<std::shared_ptr<Order>>> {
+public:
+    using iterator = container_type::iterator;
+    using const_iterator = container_type::const_iterator;
+    const_iterator begin() const { return c.begin(); }
+    const_iterator end() const { return c.end(); }
+    double quantity() const { return quantity_; }
+    double leavesQuantity() const { return quantity_ + hidden_; }
+    iterator pushBack(std::shared_ptr<Order> order) {
+        quantity_ += order->getQuantity();
+        hidden_ += order->getReserveQuantity();
+        c.push_back(std::move(order));
+        return std::prev(c.end());
+    }
+    void erase(iterator pos) {
+        quantity_ -= (*pos)->getQuantity();
+        hidden_ -= (*pos)->getReserveQuantity();
+        c.erase(pos);
+    }
+    void pop() { erase(c.begin()); }
+    // Takes qty off an order's visible quantity; it keeps its position
+    void reduce(iterator pos, double qty) {
+        (*pos)->setQuantity((*pos)->getQuantity() - qty);
+        quantity_ -= qty;
+    }
+    void reduceFront(double qty) { reduce(c.begin(), qty); }
+    // Refills an exhausted iceberg from its reserve and moves it to the back
+    // without invalidating positions; false if it has no reserve left
+    bool refillFront() {
+        Order& order = *c.front();
+        double visible = order.getQuantity();
+        if (!order.replenish()) return false;
+        quantity_ += order.getQuantity() - visible;
+        hidden_ -= order.getQuantity() - visible;
+        c.splice(c.end(), c, c.begin());
+        return true;
+    }
+
+private:
+    double quantity_ = 0.0;
+    double hidden_ = 0.0;
+};
+
+// Top of book as published to lock-free readers
+struct TopOfBook {
+    double bid_price = 0.0;
+    double bid_size = 0.0;
+    double ask_price = 0.0;
+    double ask_size = 0.0;
+    double last_price = 0.0; // Last trade price, 0 before the first trade
+    uint64_t sequence = 0; // Bumped each time any of the above changes
+};
+
+// Call auction state as published to lock-free readers. While a call runs,
+// price/volume/imbalance describe the uncross the book would get now.
+struct AuctionState {
+    bool active = false;
+    double price = 0.0;     // Equilibrium price; 0 if the book does not cross
+    double volume = 0.0;    // Quantity that would execute at price
+    double imbalance = 0.0; // Unmatched bid minus ask quantity at price
+    uint64_t sequence = 0;  // Bumped each time any of the above changes
+};
+
+// Volatility circuit breaker. The reference price is an exponentially
+// time-weighted average of trades; a fill more than `width` (a fraction) away
+// from it halts continuous matching and starts a call auction instead.
+struct PriceBand {
+    double width = 0.0;                      // e.g. 0.05; 0 disables the band
+    int64_t half_life_us = 60'000'000;       // Weight of a trade halves over this
+    int64_t auction_us = 0;                  // Volatility auction length; 0 waits for a manual uncross
+};
+
+// Order-level (L3) change to a resting order, recorded as the book mutates.
+// Orders are identified by their public ref, never the client's order id.
+struct BookEvent {
+    enum class Type : uint8_t {
+        ADD,     // quantity: visible quantity; priority: its place in the level
+        MODIFY,  // quantity: new visible quantity; a new priority sends it to the back
+        EXECUTE, // quantity: executed; the order keeps its priority
+        DELETE   // Gone: filled, cancelled or expired. quantity: visible left, 0 once filled
+    };
+    Type type;
+    Order::Side side;
+    uint64_t order_ref;
+    uint64_t priority;
+    double price;
+    double quantity;
+    std::string order_id; // ADD only; internal, never published
+    uint64_t engine_id = 0; // ADD only; internal, never published
+};
+
+// A resting order in an L3 snapshot
+struct L3Order {
+    uint64_t order_ref;
+    uint64_t priority;
+    Order::Side side;
+    double price;
+    double quantity; // Visible; iceberg reserves stay hidden
+};
 
 class OrderBook {
 public:
+    // During AUCTION orders accumulate without matching until the engine uncrosses
+    enum class Phase { CONTINUOUS, AUCTION };
+
+    struct Stats {
+        std::size_t resting_orders = 0;
+        std::size_t bid_levels = 0;
+        std::size_t ask_levels = 0;
+        std::size_t memory_bytes = 0; // Estimate of heap held by levels and orders
+    };
+
     OrderBook(const std::string& symbol);
 
     void addOrder(const std::shared_ptr<Order>& order);
-    void removeOrder(const std::string& order_id, Order::Side side, double price);
-    std::pair<double, double> getBBO() const; // (best_bid, best_ask)
+    // Returns the removed order, or nullptr if it is not resting
+    std::shared_ptr<Order> removeOrder(const std::string& order_id, Order::Side side, double price);
+    std::pair<double, double> getBBO() const; // (best_bid, best_ask), lock-free
+    TopOfBook getTopOfBook() const; // Lock-free; safe to poll from any thread
     std::vector<std::pair<double, double>> getDepth(Order::Side side, int levels) const;
     std::string getMarketDepth(int levels) const; // JSON
     std::string getSnapshot() const; // JSON
+    std::string getTopOfBookJSON() const; // JSON, lock-free
+    // Lock-free; the indicative is republished once per command that changes
+    // the book during a call, so it is never older than the last command
+    AuctionState getAuctionState() const;
+    std::string getAuctionStateJSON() const; // JSON, as getAuctionState()
+    const TradeTape& getTradeTape() const; // Lock-free reads
+    std::string getRecentTradesJSON(uint64_t since, std::size_t limit) const; // JSON, lock-free
+    Stats getStats() const;
+    const std::string& getSymbol() const;
 
     // Register a callback for real-time updates
     void setOnOrderBookChange(const std::function<void()>& cb);
+    // Buffers a BookEvent per resting-order change until taken; off by default
+    void setEventsEnabled(bool enabled);
+    // Moves the buffered events into `out`. With `snapshot`, also lists every
+    // resting order, in queue order, as of the last event taken.
+    void takeEvents(std::vector<BookEvent>& out, std::vector<L3Order>* snapshot = nullptr);
 
     // Expose for MatchingEngine
-    std::map<double, std::queue<std::shared_ptr<Order>>, std::greater<double>> bids_;
-    std::map<double, std::queue<std::shared_ptr<Order>>, std::less<double>> asks_;
+    std::map<double, OrderQueue, std::greater<double>> bids_;
+    std::map<double, OrderQueue, std::less<double>> asks_;
+    StopBook stops_; // Parked stops; change through parkStop/removeStop/triggerStops
+    // Resting GTT and DAY orders by deadline; guarded by mtx_
+    using ExpiryWheel = TimerWheel<std::shared_ptr<Order>>;
+    ExpiryWheel expiries_;
     mutable std::mutex mtx_;
 
+    // For the engine, which already holds mtx_: rest an order / republish
+    // the top of book after editing bids_ or asks_
+    void restOrder(const std::shared_ptr<Order>& order);
+    // Takes a resting order off its level without touching other orders
+    bool removeResting(const std::shared_ptr<Order>& order);
+    // removeOrder() for a caller already holding mtx_
+    std::shared_ptr<Order> takeOrder(const std::string& order_id, Order::Side side, double price);
+    // For an order the engine popped itself: drops its owner links and
+    // expiry timer; O(1)
+    void unlinkOrder(Order& order);
+    // Cancels the expiry timers of these resting orders and moves them into
+    // `out`, as a replica replays the primary's expiries; ids without a
+    // timer are skipped
+    void takeTimed(const std::vector<uint64_t>& engine_ids, std::vector<std::shared_ptr<Order>>& out);
+    void parkStop(const std::shared_ptr<Order>& order);
+    std::shared_ptr<Order> removeStop(uint64_t engine_id);
+    std::shared_ptr<Order> removeStop(const std::string& order_id, Order::Side side);
+    // Moves the stops fired by trades between low and high into `out`
+    void triggerStops(double low, double high, std::vector<std::shared_ptr<Order>>& out);
+    // Shrinks a resting order in place, keeping its time priority
+    void reduceResting(Order& order, double quantity);
+    // Front-of-level changes made while matching: a fill, a shrink that
+    // keeps priority, and an iceberg refill to the back of the level
+    void executeFront(OrderQueue& queue, double quantity);
+    void reduceFront(OrderQueue& queue, double quantity);
+    bool refillFront(OrderQueue& queue);
+    // An account's resting quote side, or nullptr
+    std::shared_ptr<Order> quoteSlot(const std::string& account, Order::Side side) const;
+    // Moves every resting or parked order of an account / session into
+    // `out`, in O(orders taken)
+    void takeAccountOrders(const std::string& account, std::vector<std::shared_ptr<Order>>& out);
+    void takeSessionOrders(uint64_t session_id, std::vector<std::shared_ptr<Order>>& out);
+    void setPriceBand(const PriceBand& band);
+    // O(1): false if a fill at price would breach the band
+    bool withinBand(double price) const;
+    // Halts into a volatility auction; see uncrossDue()
+    void haltForVolatility(int64_t now_us);
+    // When a volatility auction is due to end; 0 for none or manual
+    int64_t auctionEnd() const;
+    // Restarts the reference at a price, e.g. an uncross
+    void resetReference(double price, int64_t now_us);
+    Phase getPhase() const;
+    // Switches phase and republishes the auction state
+    void setPhase(Phase phase);
+    // Volume-maximizing uncross of the current book, from the cumulative
+    // bid and ask curves over the crossed levels only
+    AuctionState equilibrium() const;
+    void updateBBO(); // Also republishes the indicative uncross during a call
+    // Appends to the tape, assigning sequences, and moves the band reference
+    void recordTrades(std::vector<Trade>& trades, int64_t now_us);
+
 private:
     std::string symbol_;
-    double best_bid_ = 0.0;
-    double best_ask_ = 0.0;
+    TopOfBook top_;          // Last published value; written under mtx_
+    double last_trade_price_ = 0.0;
+    alignas(64) Seqlock<TopOfBook> bbo_; // Own cache line, away from writer-only state
+    Phase phase_ = Phase::CONTINUOUS;
+    AuctionState auction_; // Last published value; written under mtx_
+    Seqlock<AuctionState> auction_state_;
+    mutable std::vector<std::pair<double, double>> demand_, supply_; // equilibrium() scratch
+    void publishAuction();
+    PriceBand band_;
+    double reference_price_ = 0.0; // 0 until the first trade
+    double reference_weight_ = 0.0; // Decayed count of trades behind reference_price_
+    int64_t reference_time_us_ = 0;
+    double band_low_ = 0.0;        // Fills allowed in [band_low_, band_high_]
+    double band_high_ = std::numeric_limits<double>::max();
+    int64_t auction_end_us_ = 0;
+    void updateBandLimits();
+    TradeTape tape_;
     std::function<void()> on_change_cb_;
-    void updateBBO();
+    // Heads of the intrusive owner lists threaded through Order::BookLinks
+    std::unordered_map<std::string, Order*> account_orders_;
+    std::unordered_map<uint64_t, Order*> session_orders_;
+    // GTT and DAY orders on expiries_, by engine id
+    std::unordered_map<uint64_t, Order*> timed_orders_;
+    // Resting quote sides per account, indexed by Order::Side
+    std::unordered_map<std::string, std::array<std::shared_ptr<Order>, 2>> quotes_;
+    void linkOwners(Order& order);
+    void unlinkOwners(Order& order);
+    void takeOwned(Order* head, int list, std::vector<std::shared_ptr<Order>>& out);
     void notifyChange();
+    uint64_t next_priority_ = 0;
+    bool events_enabled_ = false;
+    std::vector<BookEvent> events_;
+    void recordEvent(BookEvent::Type type, const Order& order, double quantity);
 }; 
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "OutputBus.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "../utils/Utils.h"
+
+OutputBus::Batch::Batch(OutputBus& bus, std::size_t count) : bus_(bus), first_(bus.claim(count)), count_(count) {}
+
+OutputBus::Batch::~Batch() {
+    if (written_ == 0) bus_.waitForRoom(first_ + count_ - 1);
+    bus_.commit(first_, count_);
+}
+
+OutputEvent& OutputBus::Batch::next(OutputEvent::Type type, const std::string& symbol) {
+    if (written_ == count_) throw std::logic_error("Output batch is full");
+    if (written_ == 0) bus_.waitForRoom(first_ + count_ - 1);
+    uint64_t sequence = first_ + written_++;
+    OutputEvent& event = bus_.slots_[sequence & bus_.mask_].event;
+    event.sequence = sequence;
+    event.type = type;
+    event.symbol = symbol;
+    event.reject = RiskManager::Reject::NONE;
+    return event;
+}
+
+OutputBus::OutputBus(std::size_t capacity) {
+    const std::size_t size = Utils::roundUpToPowerOfTwo(capacity);
+    slots_ = std::vector<Slot>(size);
+    mask_ = size - 1;
+}
+
+OutputBus::~OutputBus() {
+    stop();
+}
+
+std::size_t OutputBus::addConsumer(const Handler& handler, WaitStrategy wait) {
+    if (running_) throw std::logic_error("Consumers must be added before start()");
+    auto consumer = std::make_unique<Consumer>();
+    consumer->cursor.store(claimed_.load());
+    consumer->handler = handler;
+    consumer->wait = wait;
+    consumers_.push_back(std::move(consumer));
+    return consumers_.size() - 1;
+}
+
+void OutputBus::start() {
+    if (running_.exchange(true)) return;
+    for (auto& consumer : consumers_) {
+        Consumer* c = consumer.get();
+        c->thread = std::thread([this, c]() { run(*c); });
+    }
+}
+
+void OutputBus::stop() {
+    if (!running_.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(wait_mtx_);
+    }
+    wait_cv_.notify_all();
+    for (auto& consumer : consumers_) {
+        if (consumer->thread.joinable()) consumer->thread.join();
+    }
+}
+
+uint64_t OutputBus::published() const {
+    return claimed_.load(std::memory_order_acquire);
+}
+
+uint64_t OutputBus::cursor(std::size_t consumer) const {
+    return consumers_.at(consumer)->cursor.load(std::memory_order_acquire);
+}
+
+std::size_t OutputBus::capacity() const {
+    return slots_.size();
+}
+
+uint64_t OutputBus::claim(std::size_t count) {
+    if (count > slots_.size()) throw std::invalid_argument("Output batch larger than the ring");
+    return claimed_.fetch_add(count, std::memory_order_acq_rel) + 1;
+}
+
+void OutputBus::waitForRoom(uint64_t last) {
+    // The slot for `last` is free once every consumer is past last - capacity.
+    // A stopped bus has nobody to wait for.
+    while (last > gate_.load(std::memory_order_acquire) + slots_.size()) {
+        uint64_t slowest = slowestCursor();
+        gate_.store(slowest, std::memory_order_release);
+        if (last <= slowest + slots_.size() || !running_.load(std::memory_order_acquire)) break;
+        std::this_thread::yield();
+    }
+}
+
+void OutputBus::commit(uint64_t first, std::size_t count) {
+    for (uint64_t sequence = first; sequence < first + count; ++sequence) {
+        slots_[sequence & mask_].published.store(sequence, std::memory_order_release);
+    }
+    // Pairs with the sleeper count in run(): either it sees the new events or we see it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(wait_mtx_);
+        wait_cv_.notify_all();
+    }
+}
+
+uint64_t OutputBus::slowestCursor() const {
+    if (consumers_.empty()) return std::numeric_limits<uint64_t>::max() - slots_.size();
+    uint64_t slowest = std::numeric_limits<uint64_t>::max();
+    for (const auto& consumer : consumers_) {
+        slowest = std::min(slowest, consumer->cursor.load(std::memory_order_acquire));
+    }
+    return slowest;
+}
+
+uint64_t OutputBus::available(uint64_t next) const {
+    uint64_t sequence = next;
+    while (slots_[sequence & mask_].published.load(std::memory_order_acquire) == sequence) ++sequence;
+    return sequence - 1;
+}
+
+void OutputBus::run(Consumer& consumer) {
+    uint64_t next = consumer.cursor.load(std::memory_order_relaxed) + 1;
+    for (;;) {
+        uint64_t last = available(next);
+        if (last >= next) {
+            for (uint64_t sequence = next; sequence <= last; ++sequence) {
+                consumer.handler(slots_[sequence & mask_].event, sequence == last);
+            }
+            // One release per batch frees the whole batch for the writers
+            consumer.cursor.store(last, std::memory_order_release);
+            next = last + 1;
+            continue;
+        }
+        if (!running_.load(std::memory_order_acquire)) {
+            // Writers are stopped first, so nothing is left in flight
+            if (available(next) < next) return;
+            continue;
+        }
+        switch (consumer.wait) {
+            case WaitStrategy::BUSY_SPIN:
+                break;
+            case WaitStrategy::YIELD:
+                std::this_thread::yield();
+                break;
+            case WaitStrategy::BLOCKING: {
+                std::unique_lock<std::mutex> lock(wait_mtx_);
+                sleepers_.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wait_cv_.wait(lock, [&]() { return available(next) >= next || !running_.load(); });
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Order.h"
+#include "Trade.h"
+#include "RiskManager.h"
+
+// One engine output, sequenced on the bus. The engine fills a preallocated
+// slot in place; only the fields of its type are meaningful.
+struct OutputEvent {
+    enum class Type {
+        ORDER,       // An order's state after its command: ack, fill, cancel or reject
+        TRADE,       // One execution
+        REDUCED,     // The engine shrank or cancelled a resting order without a trade
+        BOOK_UPDATE  // The symbol's book changed
+    };
+    uint64_t sequence = 0;
+    Type type = Type::BOOK_UPDATE;
+    std::string symbol;
+    Order order{"", "", Order::Type::LIMIT, Order::Side::BUY, 0.0, 0.0, ""}; // ORDER, REDUCED
+    RiskManager::Reject reject = RiskManager::Reject::NONE;                  // ORDER
+    Trade trade{};                                                          // TRADE
+};
+
+// Disruptor-style output ring: matching threads claim slots and write each
+// event once; every consumer runs on its own thread with its own cursor and
+// sees every event in sequence order, in batches. A slow consumer delays
+// only itself until the ring is full, then the writers wait for it.
+class OutputBus {
+public:
+    enum class WaitStrategy {
+        BUSY_SPIN, // Lowest latency; burns a core per consumer
+        YIELD,     // Spins but yields the core
+        BLOCKING   // Sleeps on a condition variable; the writer pays a notify
+    };
+    // end_of_batch is set on the last event currently available, so a
+    // consumer can coalesce work (e.g. one depth push per symbol per batch)
+    using Handler = std::function<void(const OutputEvent& event, bool end_of_batch)>;
+
+    // A claimed run of consecutive slots; published when it goes out of scope.
+    // Claiming only takes the sequence numbers and never waits, so it is done
+    // under the book lock to keep the bus in book order; the first next()
+    // waits for the ring to have room. Fill every slot claimed.
+    class Batch {
+    public:
+        Batch(OutputBus& bus, std::size_t count);
+        ~Batch();
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+        OutputEvent& next(OutputEvent::Type type, const std::string& symbol);
+
+    private:
+        OutputBus& bus_;
+        uint64_t first_;
+        std::size_t count_;
+        std::size_t written_ = 0;
+    };
+
+    // capacity is rounded up to a power of two
+    explicit OutputBus(std::size_t capacity = 1 << 16);
+    ~OutputBus();
+
+    // Consumers are fixed before start(); returns the consumer's index
+    std::size_t addConsumer(const Handler& handler, WaitStrategy wait = WaitStrategy::BLOCKING);
+    // Start before anything is published: writers only wait for consumers
+    // while the bus runs
+    void start();
+    // Consumers finish everything published before returning; stop writers first
+    void stop();
+
+    uint64_t published() const; // Highest sequence claimed so far
+    uint64_t cursor(std::size_t consumer) const; // Last sequence the consumer handled
+    std::size_t capacity() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> published{0}; // Sequence of the event now in the slot
+        OutputEvent event;
+    };
+    struct alignas(64) Consumer {
+        std::atomic<uint64_t> cursor{0};
+        Handler handler;
+        WaitStrategy wait;
+        std::thread thread;
+    };
+
+    std::vector<Slot> slots_;
+    uint64_t mask_;
+    std::vector<std::unique_ptr<Consumer>> consumers_;
+    alignas(64) std::atomic<uint64_t> claimed_{0};
+    alignas(64) std::atomic<uint64_t> gate_{0}; // Cached slowest cursor
+    std::atomic<bool> running_{false};
+
+    // Only BLOCKING consumers use these
+    std::mutex wait_mtx_;
+    std::condition_variable wait_cv_;
+    std::atomic<int> sleepers_{0};
+
+    uint64_t claim(std::size_t count);
+    // Until every consumer is past last - capacity, or the bus stops
+    void waitForRoom(uint64_t last);
+    void commit(uint64_t first, std::size_t count);
+    uint64_t slowestCursor() const;
+    // Highest sequence from next on that is published without a gap
+    uint64_t available(uint64_t next) const;
+    void run(Consumer& consumer);
+};
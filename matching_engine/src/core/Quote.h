@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RiskManager.h"
+
+// One symbol of a mass quote: the maker's desired bid and ask. A side with
+// zero quantity is pulled. The order ids are used only by a side that has
+// to enter the book as a new order.
+struct QuoteEntry {
+    std::string symbol;
+    double bid_price = 0.0;
+    double bid_quantity = 0.0;
+    double ask_price = 0.0;
+    double ask_quantity = 0.0;
+    std::string bid_order_id;
+    std::string ask_order_id;
+    // Set by the engine on the sides it entered, so a replica reuses them
+    uint64_t bid_engine_id = 0;
+    uint64_t ask_engine_id = 0;
+};
+
+// Replaces an account's quotes in every listed symbol
+struct Quote {
+    std::string account;     // Required; owns the quote slots
+    uint64_t session_id = 0; // Gateway session, for cancel-on-disconnect
+    std::string timestamp;
+    std::vector<QuoteEntry> entries;
+};
+
+// Where one side of a quote entry stands after it was applied
+struct QuoteSideResult {
+    std::string order_id;          // Resting order for the side; empty if none
+    std::string replaced_order_id; // Previous order, if it was pulled
+    uint64_t engine_id = 0;        // Of the order entered for the side, if any
+    double leaves_quantity = 0.0;
+    bool priority_kept = false;    // Amended in place at an unchanged price
+    RiskManager::Reject reject = RiskManager::Reject::NONE;
+};
+
+struct QuoteResult {
+    QuoteSideResult bid;
+    QuoteSideResult ask;
+};
@@ -0,0 +1,321 @@
+#include "ReadReplica.h"
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "../utils/Utils.h"
+
+namespace {
+    const char* stateName(ReadReplica::OrderStatus::State state) {
+        switch (state) {
+            case ReadReplica::OrderStatus::State::OPEN: return "open";
+            case ReadReplica::OrderStatus::State::FILLED: return "filled";
+            case ReadReplica::OrderStatus::State::CANCELLED: return "cancelled";
+            case ReadReplica::OrderStatus::State::REJECTED: return "rejected";
+        }
+        return "unknown";
+    }
+
+    const char* liquidityName(ReadReplica::OrderStatus::Liquidity liquidity) {
+        switch (liquidity) {
+            case ReadReplica::OrderStatus::Liquidity::TAKER: return "taker";
+            case ReadReplica::OrderStatus::Liquidity::MAKER: return "maker";
+            case ReadReplica::OrderStatus::Liquidity::AUCTION: return "auction";
+        }
+        return "unknown";
+    }
+}
+
+std::string ReadReplica::OrderStatus::toJSON() const {
+    nlohmann::json j;
+    j["engine_id"] = engine_id;
+    j["order_id"] = order_id;
+    j["symbol"] = symbol;
+    j["side"] = side == Order::Side::BUY ? "buy" : "sell";
+    j["price"] = price;
+    j["leaves_quantity"] = leaves;
+    j["visible_quantity"] = visible;
+    j["filled_quantity"] = filled;
+    j["fills"] = nlohmann::json::array();
+    for (const auto& f : fills) {
+        j["fills"].push_back({{"sequence", f.sequence}, {"price", f.price}, {"quantity", f.quantity},
+                              {"liquidity", liquidityName(f.liquidity)}});
+    }
+    j["status"] = stateName(state);
+    j["order_ref"] = order_ref;
+    return j.dump();
+}
+
+ReadReplica::ReadReplica(std::size_t retain_finished) : retain_finished_(retain_finished) {}
+
+ReadReplica::~ReadReplica() {
+    stop();
+}
+
+void ReadReplica::start() {
+    std::lock_guard<std::mutex> lock(queue_mtx_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void ReadReplica::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mtx_);
+        if (!running_) return;
+        running_ = false;
+    }
+    queue_cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void ReadReplica::onBookEvent(const std::string& symbol, const BookEvent& event) {
+    queue(symbol, event);
+}
+
+void ReadReplica::onOutput(const OutputEvent& event) {
+    if (event.type == OutputEvent::Type::BOOK_UPDATE) return;
+    queue(event.symbol, event);
+}
+
+void ReadReplica::queue(const std::string& symbol, Update update) {
+    std::lock_guard<std::mutex> lock(queue_mtx_);
+    pending_.emplace_back(symbol, std::move(update));
+    ++queued_;
+    // One wakeup per batch: later events just join it
+    if (follower_waiting_) {
+        follower_waiting_ = false;
+        queue_cv_.notify_one();
+    }
+}
+
+void ReadReplica::sync() {
+    std::unique_lock<std::mutex> lock(queue_mtx_);
+    const uint64_t target = queued_;
+    applied_cv_.wait(lock, [this, target]() { return applied_.load() >= target || !running_; });
+}
+
+void ReadReplica::run() {
+    std::vector<std::pair<std::string, Update>> batch;
+    for (;;) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(queue_mtx_);
+            follower_waiting_ = true;
+            queue_cv_.wait(lock, [this]() { return !running_ || !pending_.empty(); });
+            follower_waiting_ = false;
+            batch.swap(pending_);
+            stopping = !running_;
+        }
+        if (!batch.empty()) {
+            // Readers wait for one batch at most, never for matching
+            std::unique_lock<std::shared_mutex> lock(state_mtx_);
+            for (const auto& entry : batch) {
+                if (const auto* event = std::get_if<BookEvent>(&entry.second)) {
+                    apply(entry.first, *event);
+                } else {
+                    apply(std::get<OutputEvent>(entry.second));
+                }
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mtx_);
+            applied_ += batch.size();
+        }
+        applied_cv_.notify_all();
+        batch.clear();
+        if (stopping) return;
+    }
+}
+
+void ReadReplica::apply(const std::string& symbol, const BookEvent& event) {
+    Book& book = books_[symbol];
+    const bool buy = event.side == Order::Side::BUY;
+    auto adjustSide = [&](double quantity, int orders) {
+        if (buy) {
+            adjust(book.bids, event.price, quantity, orders);
+        } else {
+            adjust(book.asks, event.price, quantity, orders);
+        }
+    };
+    if (event.type == BookEvent::Type::ADD) {
+        OrderStatus& status = orders_[event.engine_id];
+        if (status.symbol.empty()) { // New, or only known from its taker fills
+            status.engine_id = event.engine_id;
+            status.order_id = event.order_id;
+            status.symbol = symbol;
+            status.side = event.side;
+            status.price = event.price;
+        }
+        status.visible = event.quantity;
+        status.order_ref = event.order_ref;
+        book.live[event.order_ref] = {event.engine_id, event.quantity, false};
+        adjustSide(event.quantity, 1);
+        return;
+    }
+    auto it = book.live.find(event.order_ref);
+    if (it == book.live.end()) return; // Rested before the replica started
+    Book::Live& live = it->second;
+    auto known = orders_.find(live.engine_id);
+    OrderStatus* status = known == orders_.end() ? nullptr : &known->second;
+    switch (event.type) {
+        case BookEvent::Type::MODIFY:
+            adjustSide(event.quantity - live.visible, 0);
+            live.visible = event.quantity;
+            live.executed = false;
+            break;
+        case BookEvent::Type::EXECUTE:
+            adjustSide(-event.quantity, 0);
+            live.visible -= event.quantity;
+            live.executed = true;
+            break;
+        case BookEvent::Type::DELETE:
+            adjustSide(-live.visible, -1);
+            if (status) {
+                status->visible = 0.0;
+                finish(*status, event.quantity == 0.0 && live.executed ? OrderStatus::State::FILLED
+                                                                        : OrderStatus::State::CANCELLED);
+            }
+            book.live.erase(it);
+            return;
+        default:
+            break;
+    }
+    if (status) status->visible = live.visible;
+}
+
+void ReadReplica::apply(const OutputEvent& event) {
+    using State = OrderStatus::State;
+    if (event.type == OutputEvent::Type::TRADE) {
+        const Trade& trade = event.trade;
+        if (trade.aggressor_side == "none") {
+            // Uncross: both sides were resting
+            fill(trade.taker_engine_id, trade, OrderStatus::Liquidity::AUCTION, false);
+            fill(trade.maker_engine_id, trade, OrderStatus::Liquidity::AUCTION, false);
+        } else {
+            fill(trade.taker_engine_id, trade, OrderStatus::Liquidity::TAKER, true);
+            fill(trade.maker_engine_id, trade, OrderStatus::Liquidity::MAKER, false);
+        }
+        return;
+    }
+    const Order& order = event.order;
+    OrderStatus& status = orders_[order.getEngineId()];
+    if (status.symbol.empty()) { // New, or only known from its taker fills
+        status.engine_id = order.getEngineId();
+        status.order_id = order.getOrderId();
+        status.symbol = event.symbol;
+        status.side = order.getSide();
+        status.price = order.getPrice();
+    }
+    if (status.state != State::OPEN) return;
+    if (event.type == OutputEvent::Type::REDUCED) {
+        status.leaves = order.getLeavesQuantity();
+        if (order.getStatus() == Order::Status::CANCELLED) finish(status, State::CANCELLED);
+        return;
+    }
+    // The order's state once its command completed
+    switch (order.getStatus()) {
+        case Order::Status::REJECTED:
+            finish(status, State::REJECTED);
+            break;
+        case Order::Status::FILLED:
+            finish(status, State::FILLED);
+            break;
+        case Order::Status::CANCELLED:
+            finish(status, State::CANCELLED);
+            break;
+        case Order::Status::NEW:
+        case Order::Status::PARTIALLY_FILLED:
+            if (order.getType() == Order::Type::LIMIT || order.isStop()) {
+                status.leaves = order.getLeavesQuantity();
+            } else {
+                finish(status, State::CANCELLED); // Market, IOC and FOK remainders never rest
+            }
+            break;
+    }
+}
+
+void ReadReplica::fill(uint64_t engine_id, const Trade& trade, OrderStatus::Liquidity liquidity, bool create) {
+    auto it = orders_.find(engine_id);
+    if (it == orders_.end()) {
+        if (!create) return; // Rested before the replica started, or long finished
+        it = orders_.emplace(engine_id, OrderStatus()).first;
+        it->second.engine_id = engine_id;
+    }
+    OrderStatus& status = it->second;
+    status.filled += trade.quantity;
+    status.fills.push_back({trade.sequence, trade.price, trade.quantity, liquidity});
+    // Leaves are set by the order's ORDER event; a taker's own fills come first
+    if (status.state != OrderStatus::State::OPEN || status.leaves <= Utils::kQuantityEpsilon) return;
+    status.leaves -= trade.quantity;
+    if (status.leaves <= Utils::kQuantityEpsilon) finish(status, OrderStatus::State::FILLED);
+}
+
+void ReadReplica::finish(OrderStatus& status, OrderStatus::State state) {
+    if (status.state != OrderStatus::State::OPEN) return;
+    status.state = state;
+    status.leaves = 0.0;
+    finished_.push_back(status.engine_id);
+    while (finished_.size() > retain_finished_) {
+        auto old = orders_.find(finished_.front());
+        if (old != orders_.end() && old->second.state != OrderStatus::State::OPEN) orders_.erase(old);
+        finished_.pop_front();
+    }
+}
+
+template <typename Levels>
+void ReadReplica::adjust(Levels& levels, double price, double quantity, int orders) {
+    Level& level = levels[price];
+    level.quantity += quantity;
+    level.orders += orders;
+    if (level.orders == 0) levels.erase(price);
+}
+
+bool ReadReplica::getOrder(uint64_t engine_id, OrderStatus& out) const {
+    std::shared_lock<std::shared_mutex> lock(state_mtx_);
+    auto it = orders_.find(engine_id);
+    if (it == orders_.end()) return false;
+    out = it->second;
+    return true;
+}
+
+std::string ReadReplica::getMarketDepth(const std::string& symbol, int levels) const {
+    std::shared_lock<std::shared_mutex> lock(state_mtx_);
+    auto it = books_.find(symbol);
+    if (it == books_.end()) return "";
+    nlohmann::json j;
+    j["timestamp"] = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    j["symbol"] = symbol;
+    j["asks"] = nlohmann::json::array();
+    j["bids"] = nlohmann::json::array();
+    int count = 0;
+    for (const auto& entry : it->second.asks) {
+        if (count++ >= levels) break;
+        j["asks"].push_back({nlohmann::json::array({entry.first, entry.second.quantity})});
+    }
+    count = 0;
+    for (const auto& entry : it->second.bids) {
+        if (count++ >= levels) break;
+        j["bids"].push_back({nlohmann::json::array({entry.first, entry.second.quantity})});
+    }
+    return j.dump();
+}
+
+std::string ReadReplica::getSnapshot(const std::string& symbol) const {
+    std::shared_lock<std::shared_mutex> lock(state_mtx_);
+    auto it = books_.find(symbol);
+    if (it == books_.end()) return "";
+    nlohmann::json j;
+    j["symbol"] = symbol;
+    j["bids"] = nlohmann::json::array();
+    j["asks"] = nlohmann::json::array();
+    for (const auto& entry : it->second.bids) {
+        j["bids"].push_back({nlohmann::json::array({entry.first, entry.second.quantity})});
+    }
+    for (const auto& entry : it->second.asks) {
+        j["asks"].push_back({nlohmann::json::array({entry.first, entry.second.quantity})});
+    }
+    return j.dump();
+}
+
+uint64_t ReadReplica::appliedEvents() const {
+    return applied_.load(std::memory_order_relaxed);
+}
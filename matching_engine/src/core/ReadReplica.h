@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "OrderBook.h"
+#include "OutputBus.h"
+
+// Query-side copies of the books. A follower thread applies the L3 event
+// stream (see BookEvent) to its own depth tables, and the engine's order and
+// trade outputs to an order-status table keyed by engine id, so depth,
+// snapshot and order lookups never take a book lock and can be served from
+// any number of threads. Reads trail matching by the follower's lag.
+class ReadReplica {
+public:
+    struct OrderStatus {
+        // OPEN while resting or parked; the others are final
+        enum class State { OPEN, FILLED, CANCELLED, REJECTED };
+        enum class Liquidity { TAKER, MAKER, AUCTION };
+        struct Fill {
+            uint64_t sequence; // On the symbol's trade tape
+            double price;
+            double quantity;
+            Liquidity liquidity;
+        };
+        uint64_t engine_id = 0;
+        std::string order_id; // As the gateway named it; not unique
+        std::string symbol;
+        Order::Side side = Order::Side::BUY;
+        double price = 0.0;
+        double leaves = 0.0;  // Still working, iceberg reserve included
+        double visible = 0.0; // Shown on the book
+        double filled = 0.0;
+        std::vector<Fill> fills; // Oldest first, as taker and as maker
+        State state = State::OPEN;
+        uint64_t order_ref = 0; // Public L3 id once it rests
+
+        std::string toJSON() const;
+    };
+
+    // Keeps the status of up to retain_finished filled or cancelled orders,
+    // forgetting the oldest first
+    explicit ReadReplica(std::size_t retain_finished = 1 << 20);
+    ~ReadReplica();
+
+    void start();
+    void stop(); // Applies what is queued first
+
+    // A MarketDataBus event sink: queues only, in the order given
+    void onBookEvent(const std::string& symbol, const BookEvent& event);
+    // An OutputBus consumer: queues ORDER, TRADE and REDUCED events
+    void onOutput(const OutputEvent& event);
+    // Returns once everything queued before the call has been applied
+    void sync();
+
+    // Every order the engine accepted or rejected, by engine id
+    bool getOrder(uint64_t engine_id, OrderStatus& out) const;
+    // Same JSON as the OrderBook methods; empty for an unknown symbol
+    std::string getMarketDepth(const std::string& symbol, int levels) const;
+    std::string getSnapshot(const std::string& symbol) const;
+    uint64_t appliedEvents() const;
+
+private:
+    struct Level {
+        double quantity = 0.0;
+        std::size_t orders = 0;
+    };
+    struct Book {
+        std::map<double, Level, std::greater<double>> bids;
+        std::map<double, Level, std::less<double>> asks;
+        struct Live {
+            uint64_t engine_id;
+            double visible;
+            bool executed; // Last change was a fill: a DELETE now means FILLED
+        };
+        std::unordered_map<uint64_t, Live> live; // By order_ref
+    };
+    // Either stream may run ahead of the other for an order, so each update
+    // only moves its own fields, and a final state is never reopened
+    using Update = std::variant<BookEvent, OutputEvent>;
+
+    std::size_t retain_finished_;
+
+    // Producer side
+    std::mutex queue_mtx_;
+    std::condition_variable queue_cv_;
+    std::condition_variable applied_cv_;
+    std::vector<std::pair<std::string, Update>> pending_;
+    uint64_t queued_ = 0;
+    bool running_ = false;
+    bool follower_waiting_ = false;
+    std::thread thread_;
+
+    // Written by the follower only; readers share the lock
+    mutable std::shared_mutex state_mtx_;
+    std::unordered_map<std::string, Book> books_;
+    std::unordered_map<uint64_t, OrderStatus> orders_; // By engine id
+    std::deque<uint64_t> finished_;                    // Oldest first
+    std::atomic<uint64_t> applied_{0};
+
+    void run();
+    void queue(const std::string& symbol, Update update);
+    void apply(const std::string& symbol, const BookEvent& event);
+    void apply(const OutputEvent& event);
+    // A taker fill may come before the order's own ORDER event; anything
+    // else only updates an order already known
+    void fill(uint64_t engine_id, const Trade& trade, OrderStatus::Liquidity liquidity, bool create);
+    void finish(OrderStatus& status, OrderStatus::State state);
+    template <typename Levels>
+    void adjust(Levels& levels, double price, double quantity, int orders);
+};
@@ -0,0 +1,236 @@
+#include "RiskManager.h"
+#include <cmath>
+#include <functional>
+#include "../utils/Utils.h"
+
+namespace {
+    double referencePrice(const TopOfBook& top) {
+        if (top.last_price > 0.0) return top.last_price;
+        if (top.bid_price > 0.0 && top.ask_price > 0.0) return (top.bid_price + top.ask_price) / 2.0;
+        return 0.0;
+    }
+}
+
+void RiskManager::setDefaultLimits(const RiskLimits& limits) {
+    std::lock_guard<std::mutex> lock(defaults_mtx_);
+    default_limits_ = limits;
+}
+
+void RiskManager::setLimits(const std::string& account, const RiskLimits& limits) {
+    Shard& shard = shardFor(account);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    accountLocked(shard, account).limits = limits;
+}
+
+RiskLimits RiskManager::getLimits(const std::string& account) const {
+    {
+        const Shard& shard = shardFor(account);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.accounts.find(account);
+        if (it != shard.accounts.end()) return it->second.limits;
+    }
+    std::lock_guard<std::mutex> lock(defaults_mtx_);
+    return default_limits_;
+}
+
+RiskManager::Shard& RiskManager::shardFor(const std::string& account) {
+    return shards_[std::hash<std::string>()(account) % kShards];
+}
+
+const RiskManager::Shard& RiskManager::shardFor(const std::string& account) const {
+    return shards_[std::hash<std::string>()(account) % kShards];
+}
+
+RiskManager::Account& RiskManager::accountLocked(Shard& shard, const std::string& account) {
+    auto it = shard.accounts.find(account);
+    if (it == shard.accounts.end()) {
+        // New accounts start from the defaults in force when first seen
+        Account fresh;
+        {
+            std::lock_guard<std::mutex> lock(defaults_mtx_);
+            fresh.limits = default_limits_;
+        }
+        it = shard.accounts.emplace(account, std::move(fresh)).first;
+    }
+    return it->second;
+}
+
+RiskManager::Reject RiskManager::reserve(const Order& order, const TopOfBook& top, bool enforce) {
+    static const RiskLimits kNoLimits;
+    const bool priced = order.getType() != Order::Type::MARKET && order.getType() != Order::Type::STOP;
+    const bool buy = order.getSide() == Order::Side::BUY;
+    const double qty = order.getQuantity();
+    const double ref = referencePrice(top);
+    // A market order can sweep far past the touch; only its protection price
+    // bounds what it pays
+    const double px = order.getPrice() > 0.0 ? order.getPrice() : ref;
+
+    Shard& shard = shardFor(order.getAccount());
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    Account& account = accountLocked(shard, order.getAccount());
+    const RiskLimits& limits = enforce ? account.limits : kNoLimits;
+
+    if (limits.max_order_quantity > 0.0 && qty > limits.max_order_quantity) {
+        return Reject::ORDER_QUANTITY;
+    }
+    if (limits.max_order_notional > 0.0) {
+        if (!priced && order.getPrice() <= 0.0) return Reject::NO_PROTECTION_PRICE;
+        if (px <= 0.0) return Reject::NO_REFERENCE_PRICE;
+        if (qty * px > limits.max_order_notional) return Reject::ORDER_NOTIONAL;
+    }
+    if (limits.price_band > 0.0 && priced && ref > 0.0 && std::fabs(px - ref) > limits.price_band * ref) {
+        return Reject::PRICE_BAND;
+    }
+    // Parked stops count as open orders until they trigger
+    const bool may_rest = order.getType() == Order::Type::LIMIT || order.isStop();
+    if (may_rest && limits.max_open_orders > 0 && account.open_orders >= limits.max_open_orders) {
+        return Reject::OPEN_ORDERS;
+    }
+    Exposure& exposure = account.symbols[order.getSymbol()];
+    if (limits.max_position > 0.0) {
+        double worst = buy ? exposure.position + exposure.open_buy + qty
+                           : -exposure.position + exposure.open_sell + qty;
+        if (worst > limits.max_position) return Reject::POSITION;
+    }
+
+    (buy ? exposure.open_buy : exposure.open_sell) += qty;
+    if (may_rest) {
+        ++account.open_orders;
+        account.open[order.getEngineId()] = qty;
+    } else {
+        account.taking[order.getEngineId()] += qty;
+    }
+    return Reject::NONE;
+}
+
+void RiskManager::settle(const Order& taker, const std::vector<Trade>& trades) {
+    const bool buy = taker.getSide() == Order::Side::BUY;
+    const bool limit = taker.getType() == Order::Type::LIMIT;
+    const bool resting = limit && (taker.getStatus() == Order::Status::NEW ||
+                                   taker.getStatus() == Order::Status::PARTIALLY_FILLED);
+    double filled = 0.0;
+    for (const auto& trade : trades) filled += trade.quantity;
+
+    {
+        Shard& shard = shardFor(taker.getAccount());
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        Account& account = accountLocked(shard, taker.getAccount());
+        Exposure& exposure = account.symbols[taker.getSymbol()];
+        exposure.position += buy ? filled : -filled;
+        auto it = account.open.find(taker.getEngineId());
+        if (it != account.open.end()) {
+            double& open = buy ? exposure.open_buy : exposure.open_sell;
+            open -= it->second;
+            if (resting) {
+                open += taker.getQuantity();
+                it->second = taker.getQuantity();
+            } else {
+                account.open.erase(it);
+                --account.open_orders;
+            }
+        }
+        // Whatever a market, IOC or FOK order did not fill is gone with it
+        auto taking = account.taking.find(taker.getEngineId());
+        if (taking != account.taking.end()) {
+            (buy ? exposure.open_buy : exposure.open_sell) -= taking->second;
+            account.taking.erase(taking);
+        }
+    }
+
+    // One maker shard at a time, never nested, so shards cannot deadlock
+    const Order::Side maker_side = buy ? Order::Side::SELL : Order::Side::BUY;
+    for (const auto& trade : trades) {
+        Shard& shard = shardFor(trade.maker_account);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        applyMakerFill(accountLocked(shard, trade.maker_account), taker.getSymbol(),
+                       trade.maker_engine_id, maker_side, trade.quantity);
+    }
+}
+
+void RiskManager::settleAuction(const std::vector<Trade>& trades) {
+    // One shard at a time, never nested, as in settle()
+    for (const auto& trade : trades) {
+        {
+            Shard& shard = shardFor(trade.taker_account);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            applyMakerFill(accountLocked(shard, trade.taker_account), trade.symbol,
+                           trade.taker_engine_id, Order::Side::BUY, trade.quantity);
+        }
+        Shard& shard = shardFor(trade.maker_account);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        applyMakerFill(accountLocked(shard, trade.maker_account), trade.symbol,
+                       trade.maker_engine_id, Order::Side::SELL, trade.quantity);
+    }
+}
+
+void RiskManager::applyMakerFill(Account& account, const std::string& symbol, uint64_t engine_id,
+                                 Order::Side side, double quantity) {
+    Exposure& exposure = account.symbols[symbol];
+    const bool buy = side == Order::Side::BUY;
+    exposure.position += buy ? quantity : -quantity;
+    auto it = account.open.find(engine_id);
+    if (it == account.open.end()) return; // Rested before risk was enabled
+    (buy ? exposure.open_buy : exposure.open_sell) -= quantity;
+    it->second -= quantity;
+    if (it->second <= Utils::kQuantityEpsilon) {
+        account.open.erase(it);
+        --account.open_orders;
+    }
+}
+
+void RiskManager::onCancel(const Order& order) {
+    Shard& shard = shardFor(order.getAccount());
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    Account& account = accountLocked(shard, order.getAccount());
+    auto it = account.open.find(order.getEngineId());
+    if (it == account.open.end()) return;
+    Exposure& exposure = account.symbols[order.getSymbol()];
+    (order.getSide() == Order::Side::BUY ? exposure.open_buy : exposure.open_sell) -= it->second;
+    account.open.erase(it);
+    --account.open_orders;
+}
+
+void RiskManager::release(const Order& order, double quantity) {
+    if (order.getStatus() == Order::Status::CANCELLED) {
+        onCancel(order);
+        return;
+    }
+    Shard& shard = shardFor(order.getAccount());
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    Account& account = accountLocked(shard, order.getAccount());
+    auto it = account.open.find(order.getEngineId());
+    if (it == account.open.end()) return;
+    Exposure& exposure = account.symbols[order.getSymbol()];
+    (order.getSide() == Order::Side::BUY ? exposure.open_buy : exposure.open_sell) -= quantity;
+    it->second -= quantity;
+}
+
+double RiskManager::getPosition(const std::string& account, const std::string& symbol) const {
+    const Shard& shard = shardFor(account);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    auto it = shard.accounts.find(account);
+    if (it == shard.accounts.end()) return 0.0;
+    auto sym = it->second.symbols.find(symbol);
+    return sym == it->second.symbols.end() ? 0.0 : sym->second.position;
+}
+
+uint32_t RiskManager::getOpenOrders(const std::string& account) const {
+    const Shard& shard = shardFor(account);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    auto it = shard.accounts.find(account);
+    return it == shard.accounts.end() ? 0 : it->second.open_orders;
+}
+
+const char* RiskManager::rejectMessage(Reject reason) {
+    switch (reason) {
+        case Reject::NONE:                return "";
+        case Reject::ORDER_QUANTITY:      return "Order quantity exceeds account limit";
+        case Reject::ORDER_NOTIONAL:      return "Order notional exceeds account limit";
+        case Reject::OPEN_ORDERS:         return "Too many open orders for account";
+        case Reject::POSITION:            return "Order would exceed account position limit";
+        case Reject::PRICE_BAND:          return "Price outside allowed band around reference price";
+        case Reject::NO_REFERENCE_PRICE:  return "No reference price to value order";
+        case Reject::NO_PROTECTION_PRICE: return "Market order needs a protection price under a notional limit";
+    }
+    return "Risk check failed";
+}
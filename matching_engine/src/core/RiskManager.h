@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Order.h"
+#include "OrderBook.h"
+#include "Trade.h"
+
+// Per-account limits. Zero disables a limit.
+struct RiskLimits {
+    double max_order_quantity = 0.0;
+    double max_order_notional = 0.0;
+    uint32_t max_open_orders = 0;
+    double max_position = 0.0;    // Worst case |net position| per symbol, counting open orders
+    double price_band = 0.0;      // Max fractional distance from the reference price, e.g. 0.05
+};
+
+// Pre-trade risk. Exposure is kept per account and updated incrementally from
+// accepts, fills and cancels, so a check never scans orders or trades.
+// Accounts are spread over independently locked shards; an order only ever
+// touches its own account's shard.
+class RiskManager {
+public:
+    enum class Reject {
+        NONE,
+        ORDER_QUANTITY,
+        ORDER_NOTIONAL,
+        OPEN_ORDERS,
+        POSITION,
+        PRICE_BAND,
+        NO_REFERENCE_PRICE,
+        NO_PROTECTION_PRICE
+    };
+
+    void setDefaultLimits(const RiskLimits& limits);
+    void setLimits(const std::string& account, const RiskLimits& limits);
+    // An account's limits; the defaults for one not seen yet
+    RiskLimits getLimits(const std::string& account) const;
+
+    // Checks an incoming order and, if it passes, reserves its open quantity
+    // against the account. `top` supplies the band reference: the last trade,
+    // else the BBO mid. Market and stop orders are valued at their protection
+    // price, the worst they may fill at; under a notional limit they must carry
+    // one. A replica passes enforce = false: the primary already checked the
+    // order, and only its exposure is mirrored.
+    Reject reserve(const Order& order, const TopOfBook& top, bool enforce = true);
+
+    // Called under the book lock once matching is done, with the taker in its
+    // post-match state. Swaps the taker's reservation for what still rests
+    // and applies the fills to both sides' positions.
+    void settle(const Order& taker, const std::vector<Trade>& trades);
+
+    // Uncross fills, where both sides were resting; taker fields name the buyer
+    void settleAuction(const std::vector<Trade>& trades);
+
+    // A resting order left the book without trading
+    void onCancel(const Order& order);
+    // A resting order shrank by `quantity` without trading; a CANCELLED
+    // order is released in full
+    void release(const Order& order, double quantity);
+
+    double getPosition(const std::string& account, const std::string& symbol) const;
+    uint32_t getOpenOrders(const std::string& account) const;
+
+    static const char* rejectMessage(Reject reason);
+
+private:
+    struct Exposure {
+        double position = 0.0;
+        double open_buy = 0.0;
+        double open_sell = 0.0;
+    };
+
+    struct Account {
+        RiskLimits limits;
+        uint32_t open_orders = 0;
+        std::unordered_map<std::string, Exposure> symbols;
+        std::unordered_map<uint64_t, double> open; // Reserved engine id -> open quantity
+        std::unordered_map<uint64_t, double> taking; // Same, for orders that cannot rest, until settled
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mtx;
+        std::unordered_map<std::string, Account> accounts;
+    };
+
+    static constexpr std::size_t kShards = 64;
+    std::array<Shard, kShards> shards_;
+
+    mutable std::mutex defaults_mtx_;
+    RiskLimits default_limits_;
+
+    Shard& shardFor(const std::string& account);
+    const Shard& shardFor(const std::string& account) const;
+    Account& accountLocked(Shard& shard, const std::string& account);
+    void applyMakerFill(Account& account, const std::string& symbol, uint64_t engine_id,
+                        Order::Side side, double quantity);
+};
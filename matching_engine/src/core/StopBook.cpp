@@ -0,0 +1,75 @@
+#include "StopBook.h"
+#include <algorithm>
+
+void StopBook::add(const std::shared_ptr<Order>& order) {
+    const double stop = order->getStopPrice();
+    Entry entry{++next_sequence_, order};
+    if (order->getSide() == Order::Side::BUY) {
+        buy_stops_[stop].push_back(std::move(entry));
+    } else {
+        sell_stops_[stop].push_back(std::move(entry));
+    }
+    index_[order->getEngineId()] = {order->getSide(), stop};
+}
+
+std::shared_ptr<Order> StopBook::remove(uint64_t engine_id) {
+    auto indexed = index_.find(engine_id);
+    if (indexed == index_.end()) return nullptr;
+    const Order::Side side = indexed->second.first;
+    const double stop = indexed->second.second;
+    index_.erase(indexed);
+
+    auto take = [&](auto& levels) -> std::shared_ptr<Order> {
+        auto level = levels.find(stop);
+        if (level == levels.end()) return nullptr;
+        auto& entries = level->second;
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [&](const Entry& e) { return e.order->getEngineId() == engine_id; });
+        if (it == entries.end()) return nullptr;
+        auto order = std::move(it->order);
+        entries.erase(it);
+        if (entries.empty()) levels.erase(level);
+        return order;
+    };
+    return side == Order::Side::BUY ? take(buy_stops_) : take(sell_stops_);
+}
+
+std::shared_ptr<Order> StopBook::remove(const std::string& order_id, Order::Side side) {
+    auto find = [&](const auto& levels) -> uint64_t {
+        for (const auto& level : levels) {
+            for (const auto& entry : level.second) {
+                if (entry.order->getOrderId() == order_id) return entry.order->getEngineId();
+            }
+        }
+        return 0;
+    };
+    const uint64_t engine_id = side == Order::Side::BUY ? find(buy_stops_) : find(sell_stops_);
+    return engine_id == 0 ? nullptr : remove(engine_id);
+}
+
+template <typename Compare>
+void StopBook::collect(Levels<Compare>& levels, double price, std::vector<Entry>& out) {
+    auto end = levels.upper_bound(price);
+    for (auto it = levels.begin(); it != end; ++it) {
+        std::move(it->second.begin(), it->second.end(), std::back_inserter(out));
+    }
+    levels.erase(levels.begin(), end);
+}
+
+void StopBook::collectTriggered(double low, double high, std::vector<std::shared_ptr<Order>>& out) {
+    if (index_.empty()) return;
+    std::vector<Entry> fired;
+    collect(buy_stops_, high, fired);
+    collect(sell_stops_, low, fired);
+    if (fired.empty()) return;
+    std::sort(fired.begin(), fired.end(),
+              [](const Entry& a, const Entry& b) { return a.sequence < b.sequence; });
+    for (auto& entry : fired) {
+        index_.erase(entry.order->getEngineId());
+        out.push_back(std::move(entry.order));
+    }
+}
+
+std::size_t StopBook::size() const {
+    return index_.size();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Order.h"
+
+// Parked stop and stop-limit orders of one symbol, indexed by trigger price.
+// A trade only visits the prices it crossed: O(log n + k) for k triggered
+// stops. Not thread-safe; the owning book's mutex guards it.
+class StopBook {
+public:
+    void add(const std::shared_ptr<Order>& order);
+    // Returns the parked order, or nullptr if it is not (or no longer) here
+    std::shared_ptr<Order> remove(uint64_t engine_id);
+    // By client id, which need not be unique: the first match on that side
+    // in trigger order. O(stops parked on the side).
+    std::shared_ptr<Order> remove(const std::string& order_id, Order::Side side);
+
+    // Removes every stop crossed by trades between low and high and appends
+    // them to `out` in the order they were parked
+    void collectTriggered(double low, double high, std::vector<std::shared_ptr<Order>>& out);
+
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        uint64_t sequence;
+        std::shared_ptr<Order> order;
+    };
+    template <typename Compare>
+    using Levels = std::map<double, std::vector<Entry>, Compare>;
+
+    template <typename Compare>
+    static void collect(Levels<Compare>& levels, double price, std::vector<Entry>& out);
+
+    // Buy stops fire at or above their price, sell stops at or below, so the
+    // crossed range is always a prefix of the map
+    Levels<std::less<double>> buy_stops_;
+    Levels<std::greater<double>> sell_stops_;
+    std::unordered_map<uint64_t, std::pair<Order::Side, double>> index_; // engine id -> (side, stop price)
+    uint64_t next_sequence_ = 0;
+};
@@ -10,7 +10,8 @@ std::string Trade::toJSON() const {
         {"quantity", quantity},
         {"aggressor_side", aggressor_side},
         {"maker_order_id", maker_order_id},
-        {"taker_order_id", taker_order_id}
+        {"taker_order_id", taker_order_id},
+        {"sequence", sequence}
     };
     return j.dump();
 } 
\ No newline at end of file
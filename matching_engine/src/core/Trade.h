@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 struct Trade {
@@ -7,9 +8,16 @@ struct Trade {
     std::string symbol;
     double price;
     double quantity;
-    std::string aggressor_side; // "buy" or "sell"
+    std::string aggressor_side; // "buy" or "sell"; "none" for an auction uncross
+    // In an uncross neither side aggressed: taker is the buy order, maker the sell
     std::string maker_order_id;
     std::string taker_order_id;
+    uint64_t sequence = 0; // Position on the symbol's trade tape
+    // Owning accounts; internal only, never serialized to market data
+    std::string maker_account;
+    std::string taker_account;
+    uint64_t maker_engine_id = 0;
+    uint64_t taker_engine_id = 0;
 
     std::string toJSON() const;
 }; 
\ No newline at end of file
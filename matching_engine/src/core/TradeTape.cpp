@@ -0,0 +1,68 @@
+#include "TradeTape.h"
+#include <algorithm>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include "../utils/Utils.h"
+
+namespace {
+    constexpr uint64_t kMask = TradeTape::kCapacity - 1;
+    static_assert((TradeTape::kCapacity & kMask) == 0, "TradeTape capacity must be a power of two");
+}
+
+std::string TapeEntry::toJSON(const std::string& symbol) const {
+    nlohmann::json j = {
+        {"sequence", sequence},
+        {"trade_id", std::string(trade_id)},
+        {"timestamp", Utils::formatTimestamp(timestamp_us)},
+        {"symbol", symbol},
+        {"price", price},
+        {"quantity", quantity},
+        {"aggressor_side", auction ? "none" : aggressor_buy ? "buy" : "sell"}
+    };
+    return j.dump();
+}
+
+TradeTape::TradeTape() : slots_(new Seqlock<TapeEntry>[kCapacity]) {}
+
+void TradeTape::append(Trade& trade) {
+    uint64_t sequence = last_sequence_.load(std::memory_order_relaxed) + 1;
+    trade.sequence = sequence;
+
+    TapeEntry entry;
+    entry.sequence = sequence;
+    if (!Utils::parseTimestamp(trade.timestamp, entry.timestamp_us)) {
+        entry.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    entry.price = trade.price;
+    entry.quantity = trade.quantity;
+    std::strncpy(entry.trade_id, trade.trade_id.c_str(), sizeof(entry.trade_id) - 1);
+    entry.aggressor_buy = trade.aggressor_side == "buy";
+    entry.auction = trade.aggressor_side == "none";
+
+    slots_[sequence & kMask].store(entry);
+    last_sequence_.store(sequence, std::memory_order_release);
+}
+
+std::vector<TapeEntry> TradeTape::since(uint64_t since, std::size_t max_entries) const {
+    std::vector<TapeEntry> out;
+    uint64_t last = last_sequence_.load(std::memory_order_acquire);
+    if (last <= since || max_entries == 0) return out;
+
+    uint64_t oldest = last >= kCapacity ? last - kCapacity + 1 : 1;
+    uint64_t first = std::max(since + 1, oldest);
+    if (last - first + 1 > max_entries) first = last - max_entries + 1;
+
+    out.reserve(static_cast<std::size_t>(last - first + 1));
+    for (uint64_t seq = first; seq <= last; ++seq) {
+        TapeEntry entry = slots_[seq & kMask].load();
+        // A lapping writer already replaced this slot with a newer trade
+        if (entry.sequence != seq) continue;
+        out.push_back(entry);
+    }
+    return out;
+}
+
+uint64_t TradeTape::lastSequence() const {
+    return last_sequence_.load(std::memory_order_acquire);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Trade.h"
+#include "../utils/Seqlock.h"
+
+// One trade as retained on the tape: fixed size, no heap. Order ids are not
+// kept; the tape is public market data.
+struct TapeEntry {
+    uint64_t sequence = 0;     // Per-symbol, starts at 1, no gaps
+    int64_t timestamp_us = 0;  // Microseconds since the epoch
+    double price = 0.0;
+    double quantity = 0.0;
+    char trade_id[23] = {};
+    uint8_t aggressor_buy = 0;  // 1 if the aggressor bought
+    uint8_t auction = 0;        // 1 for an uncross, which has no aggressor
+
+    std::string toJSON(const std::string& symbol) const;
+};
+
+// Fixed-capacity ring of the most recent trades for one symbol. A single
+// writer (the matching path, under the book mutex) appends; any number of
+// readers copy entries out without locking, retrying slots being rewritten.
+class TradeTape {
+public:
+    static constexpr std::size_t kCapacity = 4096; // Power of two
+
+    TradeTape();
+
+    // Assigns trade.sequence. Callers must serialize appends.
+    void append(Trade& trade);
+
+    // Entries with sequence > since, oldest first, at most max_entries (the
+    // newest are kept when truncating). Entries already overwritten are skipped.
+    std::vector<TapeEntry> since(uint64_t since, std::size_t max_entries = kCapacity) const;
+
+    uint64_t lastSequence() const;
+
+private:
+    std::unique_ptr<Seqlock<TapeEntry>[]> slots_;
+    std::atomic<uint64_t> last_sequence_{0};
+};
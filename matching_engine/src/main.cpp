@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <memory>
@@ -6,17 +7,30 @@
 #include <atomic>
 #include <condition_variable>
 #include "utils/Logger.h"
+#include "utils/Utils.h"
 #include "core/MatchingEngine.h"
+#include "core/ReadReplica.h"
+#include "core/OutputBus.h"
 #include "api/RestServer.h"
 #include "api/WebSocketServer.h"
+#include "api/Replication.h"
+#include "api/MarketDataBus.h"
+#include "api/UdpFeed.h"
 
 std::shared_ptr<MatchingEngine> engine;
 std::shared_ptr<RestServer> rest_server;
 std::shared_ptr<WebSocketServer> ws_server;
+std::shared_ptr<BarAggregator> bars;
+std::shared_ptr<ReplicationPrimary> replication;
+std::shared_ptr<MarketDataBus> md_bus;
+std::shared_ptr<UdpFeedPublisher> udp_feed;
+std::shared_ptr<ReadReplica> read_replica;
+std::shared_ptr<OutputBus> output_bus;
 std::atomic<bool> running(true);
 std::condition_variable cv;
 std::mutex cv_mutex;
 bool servers_ready = false;
+bool primary_lost = false;
 
 void signal_handler(int signal) {
     Logger::info("Received signal " + std::to_string(signal) + ", shutting down...");
@@ -24,7 +38,7 @@ void signal_handler(int signal) {
     cv.notify_all();
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         // Set up signal handling
         std::signal(SIGINT, signal_handler);
@@ -34,11 +48,188 @@ int main() {
         Logger::setLevel(Logger::Level::INFO);
         Logger::info("Matching Engine starting up...");
 
+        // Replication: --replicate-port streams the command journal to hot
+        // standbys; --backup-of host:port runs as one until that primary is lost
+        int replicate_port = 0;
+        std::string primary_address;
+        int64_t failover_timeout_us = 500'000;
+        // UDP market data: --feed-a/--feed-b address:port lines, gap fills on --feed-retransmit-port
+        std::vector<FeedLine> feed_lines;
+        int feed_retransmit_port = 0;
+        // Pre-trade risk: --risk-* set the limits every account starts with
+        // (0 = off); --admin-token enables per-account changes over REST
+        RiskLimits risk_defaults;
+        std::string admin_token;
+        // Volatility circuit breaker, off unless --price-band-pct is given: a
+        // fill that far from the recent trade average halts the symbol into a
+        // call auction of --band-auction-ms (0 waits for a manual uncross)
+        PriceBand band;
+        band.auction_us = 120'000'000;
+        for (int i = 1; i < argc; ++i) {
+            std::string flag = argv[i];
+            if (i + 1 >= argc) {
+                Logger::err("Missing value for " + flag);
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (flag == "--replicate-port") {
+                replicate_port = std::stoi(value);
+            } else if (flag == "--backup-of") {
+                primary_address = value;
+            } else if (flag == "--failover-timeout-ms") {
+                failover_timeout_us = std::stoll(value) * 1000;
+            } else if (flag == "--feed-a" || flag == "--feed-b") {
+                auto colon = value.rfind(':');
+                if (colon == std::string::npos) {
+                    Logger::err(flag + " expects address:port");
+                    return 1;
+                }
+                feed_lines.push_back({value.substr(0, colon), std::stoi(value.substr(colon + 1))});
+            } else if (flag == "--feed-retransmit-port") {
+                feed_retransmit_port = std::stoi(value);
+            } else if (flag == "--risk-max-order-qty") {
+                risk_defaults.max_order_quantity = std::stod(value);
+            } else if (flag == "--risk-max-order-notional") {
+                risk_defaults.max_order_notional = std::stod(value);
+            } else if (flag == "--risk-max-open-orders") {
+                risk_defaults.max_open_orders = static_cast<uint32_t>(std::stoul(value));
+            } else if (flag == "--risk-max-position") {
+                risk_defaults.max_position = std::stod(value);
+            } else if (flag == "--risk-price-band") {
+                risk_defaults.price_band = std::stod(value);
+            } else if (flag == "--admin-token") {
+                admin_token = value;
+            } else if (flag == "--price-band-pct") {
+                band.width = std::stod(value) / 100.0;
+            } else if (flag == "--band-half-life-ms") {
+                band.half_life_us = std::stoll(value) * 1000;
+            } else if (flag == "--band-auction-ms") {
+                band.auction_us = std::stoll(value) * 1000;
+            } else {
+                Logger::err("Unknown option " + flag);
+                return 1;
+            }
+        }
+
         // Create matching engine instance
         engine = std::make_shared<MatchingEngine>();
 
+        // Pre-trade risk: positions and open orders are tracked from the
+        // start, whether or not any limit is set
+        auto risk = std::make_shared<RiskManager>();
+        risk->setDefaultLimits(risk_defaults);
+        engine->setRiskManager(risk);
+
+        if (band.width > 0.0) {
+            engine->setDefaultPriceBand(band);
+            Logger::info("Volatility price band " + std::to_string(band.width * 100.0) + "% on every symbol");
+        }
+
+        // Hot standby: replay the primary's journal until it goes quiet, then
+        // carry on as the primary with warm books
+        if (!primary_address.empty()) {
+            auto colon = primary_address.rfind(':');
+            if (colon == std::string::npos) {
+                Logger::err("--backup-of expects host:port");
+                return 1;
+            }
+            ReplicationBackup backup(engine, primary_address.substr(0, colon),
+                                     std::stoi(primary_address.substr(colon + 1)), failover_timeout_us);
+            backup.setOnFailover([]() {
+                std::lock_guard<std::mutex> lock(cv_mutex);
+                primary_lost = true;
+                cv.notify_all();
+            });
+            backup.start();
+            Logger::info("Standing by for primary " + primary_address);
+            {
+                std::unique_lock<std::mutex> lock(cv_mutex);
+                cv.wait(lock, []() { return primary_lost || !running; });
+            }
+            backup.stop();
+            if (!running) return 0;
+            Logger::info("Taking over from " + primary_address + " at sequence " +
+                         std::to_string(backup.appliedSequence()));
+        }
+        if (replicate_port > 0) {
+            replication = std::make_shared<ReplicationPrimary>(engine, replicate_port);
+            replication->start();
+            Logger::info("Streaming the command journal to backups on port " + std::to_string(replicate_port));
+        }
+
+        // Create WebSocket server on port 9002 and stream engine events to it
+        ws_server = std::make_shared<WebSocketServer>(engine, 9002);
+        bars = std::make_shared<BarAggregator>();
+        ws_server->setBarAggregator(bars);
+        // Local consumers read the same feed from shared memory; optional
+        try {
+            md_bus = std::make_shared<MarketDataBus>(engine);
+            Logger::info("Publishing market data to shared memory " + std::string(MarketDataRing::kDefaultName));
+        } catch (const std::exception& e) {
+            Logger::warn("Shared-memory market data disabled: " + std::string(e.what()));
+            md_bus = std::make_shared<MarketDataBus>(engine, "");
+        }
+        md_bus->enableL3();
+        // REST order status, depth and snapshot queries, and WebSocket depth
+        // images, are served from copies
+        read_replica = std::make_shared<ReadReplica>();
+        read_replica->start();
+        ws_server->setReadReplica(read_replica);
+        md_bus->addEventSink([](const std::string& symbol, const BookEvent& event) {
+            read_replica->onBookEvent(symbol, event);
+        });
+        if (!feed_lines.empty()) {
+            udp_feed = std::make_shared<UdpFeedPublisher>(feed_lines, feed_retransmit_port);
+            udp_feed->start();
+            md_bus->addSink([](uint64_t sequence, const MarketDataMessage& message) {
+                udp_feed->publish(sequence, message);
+            });
+            Logger::info("Publishing UDP market data on " + std::to_string(feed_lines.size()) +
+                         " line(s), retransmits on port " + std::to_string(udp_feed->retransmitPort()));
+        }
+        // Order entry sessions learn their fills and engine cancels before
+        // processOrder returns, so their acks carry the true leaves
+        engine->setOnTrade([](const Trade& trade) { ws_server->routeFills(trade); });
+        engine->setOnOrderReduced([](const Order& order) { ws_server->onOrderReduced(order); });
+        // Other engine outputs go through one sequenced ring; each consumer
+        // reads it on its own thread, so none of them is on the matching path
+        output_bus = std::make_shared<OutputBus>();
+        output_bus->addConsumer([](const OutputEvent& event, bool) {
+            // Ahead of the L3 events the book update releases
+            read_replica->onOutput(event);
+            if (event.type == OutputEvent::Type::TRADE) {
+                md_bus->onTrade(event.trade);
+            } else if (event.type == OutputEvent::Type::BOOK_UPDATE) {
+                md_bus->onBookUpdate(event.symbol);
+            }
+        });
+        // Depth pushes are whole snapshots: one per symbol per batch is enough
+        std::vector<std::string> depth_dirty;
+        output_bus->addConsumer([depth_dirty](const OutputEvent& event, bool end_of_batch) mutable {
+            if (event.type == OutputEvent::Type::TRADE) {
+                bars->onTrade(event.trade);
+                ws_server->broadcastTrade(event.trade);
+                ws_server->broadcastBars(event.symbol);
+            } else if (event.type == OutputEvent::Type::BOOK_UPDATE &&
+                       std::find(depth_dirty.begin(), depth_dirty.end(), event.symbol) == depth_dirty.end()) {
+                depth_dirty.push_back(event.symbol);
+            }
+            if (end_of_batch) {
+                for (const auto& symbol : depth_dirty) ws_server->broadcastMarketData(symbol);
+                depth_dirty.clear();
+            }
+        });
+        output_bus->start();
+        engine->setOutputBus(output_bus);
+
         // Start REST server on port 8080
-        rest_server = std::make_shared<RestServer>(engine, 8080);
+        RestServerConfig rest_config;
+        rest_config.admin_token = admin_token;
+        rest_server = std::make_shared<RestServer>(engine, 8080, rest_config);
+        rest_server->setRiskManager(risk);
+        rest_server->setBarAggregator(bars);
+        rest_server->setMarketDataBus(md_bus);
+        rest_server->setReadReplica(read_replica);
         std::thread rest_thread([&]() {
             try {
                 Logger::info("Starting REST server on port 8080...");
@@ -50,8 +241,7 @@ int main() {
             }
         });
 
-        // Start WebSocket server on port 9002
-        ws_server = std::make_shared<WebSocketServer>(engine, 9002);
+        // Start WebSocket server
         std::thread ws_thread([&]() {
             try {
                 Logger::info("Starting WebSocket server on port 9002...");
@@ -81,15 +271,27 @@ int main() {
             return 1;
         }
 
-        // Main loop
+        // Main loop: drives GTT expiry and volatility auction ends at a 10ms granularity
         Logger::info("Matching Engine is running. Press Ctrl+C to stop.");
         while (running) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            int64_t now = Utils::nowMicros();
+            engine->expireOrders(now);
+            engine->uncrossDue(now);
         }
 
+        // Session end: DAY orders expire while clients can still be told
+        std::size_t expired = engine->endSession();
+        Logger::info("Session ended, " + std::to_string(expired) + " DAY orders expired");
+
         // Cleanup
         Logger::info("Shutting down servers...");
+        if (rest_server) rest_server->stop();
+        if (output_bus) output_bus->stop();
         if (ws_server) ws_server->stop();
+        if (replication) replication->stop();
+        if (udp_feed) udp_feed->stop();
+        if (read_replica) read_replica->stop();
 
         // Wait for server threads to finish
         if (rest_thread.joinable()) rest_thread.join();
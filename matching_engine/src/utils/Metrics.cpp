@@ -0,0 +1,131 @@
+#include "Metrics.h"
+#include <sstream>
+
+std::array<Metrics::Shard, Metrics::kShards> Metrics::shards_;
+std::array<std::atomic<int64_t>, static_cast<std::size_t>(Metrics::Gauge::COUNT)> Metrics::gauges_{};
+std::atomic<std::size_t> Metrics::next_shard_{0};
+
+namespace {
+    const char* rejectReasonLabel(Metrics::RejectReason reason) {
+        switch (reason) {
+            case Metrics::RejectReason::INVALID_SYMBOL:     return "invalid_symbol";
+            case Metrics::RejectReason::INVALID_ORDER_TYPE: return "invalid_order_type";
+            case Metrics::RejectReason::INVALID_SIDE:       return "invalid_side";
+            case Metrics::RejectReason::INVALID_QUANTITY:   return "invalid_quantity";
+            case Metrics::RejectReason::INVALID_PRICE:      return "invalid_price";
+            case Metrics::RejectReason::MALFORMED:          return "malformed";
+            case Metrics::RejectReason::RISK_LIMIT:         return "risk_limit";
+            default:                                        return "unknown";
+        }
+    }
+
+    void writeHeader(std::ostringstream& out, const char* name, const char* help, const char* type) {
+        out << "# HELP " << name << ' ' << help << '\n';
+        out << "# TYPE " << name << ' ' << type << '\n';
+    }
+}
+
+Metrics::Shard& Metrics::localShard() {
+    thread_local std::size_t index = next_shard_.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shards_[index];
+}
+
+uint64_t Metrics::sum(std::size_t index) {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.values[index].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Metrics::increment(Counter counter, uint64_t n) {
+    localShard().values[static_cast<std::size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+}
+
+void Metrics::reject(RejectReason reason) {
+    std::size_t index = static_cast<std::size_t>(Counter::COUNT) + static_cast<std::size_t>(reason);
+    localShard().values[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::setGauge(Gauge gauge, int64_t value) {
+    gauges_[static_cast<std::size_t>(gauge)].store(value, std::memory_order_relaxed);
+}
+
+void Metrics::addGauge(Gauge gauge, int64_t delta) {
+    gauges_[static_cast<std::size_t>(gauge)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+uint64_t Metrics::get(Counter counter) {
+    return sum(static_cast<std::size_t>(counter));
+}
+
+uint64_t Metrics::getRejected(RejectReason reason) {
+    return sum(static_cast<std::size_t>(Counter::COUNT) + static_cast<std::size_t>(reason));
+}
+
+int64_t Metrics::getGauge(Gauge gauge) {
+    return gauges_[static_cast<std::size_t>(gauge)].load(std::memory_order_relaxed);
+}
+
+void Metrics::reset() {
+    for (auto& shard : shards_) {
+        for (auto& value : shard.values) value.store(0, std::memory_order_relaxed);
+    }
+    for (auto& gauge : gauges_) gauge.store(0, std::memory_order_relaxed);
+}
+
+std::string Metrics::render(const std::vector<BookSample>& books) {
+    std::ostringstream out;
+
+    writeHeader(out, "matching_engine_orders_received_total", "Orders received by the gateways.", "counter");
+    out << "matching_engine_orders_received_total " << get(Counter::ORDERS_RECEIVED) << '\n';
+
+    writeHeader(out, "matching_engine_orders_shed_total", "Orders refused with 503 because the gateway was saturated.", "counter");
+    out << "matching_engine_orders_shed_total " << get(Counter::ORDERS_SHED) << '\n';
+    writeHeader(out, "matching_engine_orders_expired_total", "Resting GTT and DAY orders cancelled on expiry.", "counter");
+    out << "matching_engine_orders_expired_total " << get(Counter::ORDERS_EXPIRED) << '\n';
+    writeHeader(out, "matching_engine_quotes_received_total", "Mass quote messages received by the gateways.", "counter");
+    out << "matching_engine_quotes_received_total " << get(Counter::QUOTES_RECEIVED) << '\n';
+    writeHeader(out, "matching_engine_volatility_halts_total", "Times a price band breach moved a symbol into a volatility auction.", "counter");
+    out << "matching_engine_volatility_halts_total " << get(Counter::VOLATILITY_HALTS) << '\n';
+
+    writeHeader(out, "matching_engine_orders_rejected_total", "Orders rejected by validation or pre-trade risk.", "counter");
+    for (std::size_t i = 0; i < static_cast<std::size_t>(RejectReason::COUNT); ++i) {
+        auto reason = static_cast<RejectReason>(i);
+        out << "matching_engine_orders_rejected_total{reason=\"" << rejectReasonLabel(reason) << "\"} "
+            << getRejected(reason) << '\n';
+    }
+
+    writeHeader(out, "matching_engine_trades_total", "Trades executed.", "counter");
+    out << "matching_engine_trades_total " << get(Counter::TRADES) << '\n';
+
+    writeHeader(out, "matching_engine_book_resting_orders", "Resting orders per symbol.", "gauge");
+    for (const auto& b : books) {
+        out << "matching_engine_book_resting_orders{symbol=\"" << b.symbol << "\"} " << b.resting_orders << '\n';
+    }
+
+    writeHeader(out, "matching_engine_book_levels", "Price levels per symbol and side.", "gauge");
+    for (const auto& b : books) {
+        out << "matching_engine_book_levels{symbol=\"" << b.symbol << "\",side=\"bid\"} " << b.bid_levels << '\n';
+        out << "matching_engine_book_levels{symbol=\"" << b.symbol << "\",side=\"ask\"} " << b.ask_levels << '\n';
+    }
+
+    writeHeader(out, "matching_engine_book_memory_bytes", "Estimated memory held by each order book.", "gauge");
+    for (const auto& b : books) {
+        out << "matching_engine_book_memory_bytes{symbol=\"" << b.symbol << "\"} " << b.memory_bytes << '\n';
+    }
+
+    writeHeader(out, "matching_engine_ws_connections", "Open WebSocket connections.", "gauge");
+    out << "matching_engine_ws_connections " << getGauge(Gauge::WS_CONNECTIONS) << '\n';
+
+    writeHeader(out, "matching_engine_ws_subscribers", "Active WebSocket symbol subscriptions.", "gauge");
+    out << "matching_engine_ws_subscribers " << getGauge(Gauge::WS_SUBSCRIBERS) << '\n';
+
+    writeHeader(out, "matching_engine_ws_send_queue_bytes", "Bytes buffered for sending across WebSocket connections.", "gauge");
+    out << "matching_engine_ws_send_queue_bytes " << getGauge(Gauge::WS_SEND_QUEUE_BYTES) << '\n';
+
+    writeHeader(out, "matching_engine_market_data_dropped_total", "Market data messages dropped for slow or failed connections.", "counter");
+    out << "matching_engine_market_data_dropped_total " << get(Counter::MARKET_DATA_DROPPED) << '\n';
+
+    return out.str();
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Process-wide counters and gauges exposed in Prometheus text format.
+// Counters are sharded so the hot path is a single relaxed fetch_add on a
+// cache line few other threads write to: threads take shards round-robin,
+// and only share one once there are more threads than shards.
+class Metrics {
+public:
+    enum class Counter {
+        ORDERS_RECEIVED,
+        ORDERS_SHED,
+        ORDERS_EXPIRED,
+        QUOTES_RECEIVED,
+        VOLATILITY_HALTS,
+        TRADES,
+        MARKET_DATA_DROPPED,
+        COUNT
+    };
+
+    enum class RejectReason {
+        INVALID_SYMBOL,
+        INVALID_ORDER_TYPE,
+        INVALID_SIDE,
+        INVALID_QUANTITY,
+        INVALID_PRICE,
+        MALFORMED,
+        RISK_LIMIT,
+        COUNT
+    };
+
+    enum class Gauge {
+        WS_CONNECTIONS,
+        WS_SUBSCRIBERS,
+        WS_SEND_QUEUE_BYTES,
+        COUNT
+    };
+
+    // Per-symbol book gauges, sampled at scrape time
+    struct BookSample {
+        std::string symbol;
+        std::size_t resting_orders;
+        std::size_t bid_levels;
+        std::size_t ask_levels;
+        std::size_t memory_bytes;
+    };
+
+    static void increment(Counter counter, uint64_t n = 1);
+    static void reject(RejectReason reason);
+    static void setGauge(Gauge gauge, int64_t value);
+    static void addGauge(Gauge gauge, int64_t delta);
+
+    static uint64_t get(Counter counter);
+    static uint64_t getRejected(RejectReason reason);
+    static int64_t getGauge(Gauge gauge);
+
+    static std::string render(const std::vector<BookSample>& books);
+    static void reset();
+
+private:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kCounters =
+        static_cast<std::size_t>(Counter::COUNT) + static_cast<std::size_t>(RejectReason::COUNT);
+
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, kCounters> values{};
+    };
+
+    static std::array<Shard, kShards> shards_;
+    static std::array<std::atomic<int64_t>, static_cast<std::size_t>(Gauge::COUNT)> gauges_;
+    static std::atomic<std::size_t> next_shard_;
+
+    // This thread's shard, assigned round-robin on first use
+    static Shard& localShard();
+    static uint64_t sum(std::size_t index);
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock. The writer never blocks and readers never take
+// a lock: they retry while a write is in progress or if one overlapped the read.
+// The payload is copied through relaxed atomic words so torn reads are
+// detected rather than being undefined behaviour.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+
+public:
+    Seqlock() {
+        store(T{});
+    }
+
+    // Writers must be serialized externally (e.g. by the owning book's mutex)
+    void store(const T& value) {
+        std::array<uint64_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        std::array<uint64_t, kWords> words;
+        uint64_t before, after;
+        do {
+            before = seq_.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq_.load(std::memory_order_relaxed);
+        } while (before != after || (before & 1));
+
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    // Number of completed writes
+    uint64_t version() const {
+        return seq_.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> seq_{0};
+    std::array<std::atomic<uint64_t>, kWords> data_{};
+};
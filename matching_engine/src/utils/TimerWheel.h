@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Hierarchical timer wheel: four levels of 64 slots over a fixed tick, so
+// 64^4 ticks (about 4.6 hours at 1ms) are covered directly; later deadlines
+// wait in an overflow list that is re-examined once per top-level turn.
+// Schedule and cancel are O(1) through the returned handle, and advancing
+// only visits the slots that came due. Deadlines round up to a tick, so an
+// entry never fires early and at most a tick late. Entries scheduled with
+// kSessionEnd never fire on time and are only released by expireSession().
+// Not thread-safe; the owner serializes access.
+template <typename T>
+class TimerWheel {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle kNone = std::numeric_limits<Handle>::max();
+    static constexpr int64_t kSessionEnd = std::numeric_limits<int64_t>::max();
+
+    explicit TimerWheel(int64_t now_us, int64_t tick_us = 1000)
+        : tick_us_(tick_us), current_tick_(now_us / tick_us) {
+        heads_.fill(kNone);
+    }
+
+    Handle schedule(int64_t deadline_us, T value) {
+        Handle h = allocate();
+        Node& node = nodes_[h];
+        node.value = std::move(value);
+        if (deadline_us == kSessionEnd) {
+            node.tick = kSessionEnd;
+            link(h, kSessionList);
+        } else {
+            // Round up so nothing fires before its deadline; already due
+            // fires on the next advance
+            node.tick = std::max((deadline_us + tick_us_ - 1) / tick_us_, current_tick_ + 1);
+            place(h);
+            ++timed_;
+        }
+        return h;
+    }
+
+    // False if the handle already fired or was cancelled
+    bool cancel(Handle h) {
+        if (h >= nodes_.size() || nodes_[h].list == kFree) return false;
+        if (nodes_[h].tick != kSessionEnd) --timed_;
+        unlink(h);
+        release(h);
+        return true;
+    }
+
+    // cancel() that hands the value back
+    bool take(Handle h, T& out) {
+        if (h >= nodes_.size() || nodes_[h].list == kFree) return false;
+        out = std::move(nodes_[h].value);
+        return cancel(h);
+    }
+
+    // Appends every value whose deadline is at or before now_us
+    void advance(int64_t now_us, std::vector<T>& expired) {
+        const int64_t target = now_us / tick_us_;
+        if (timed_ == 0) {
+            current_tick_ = std::max(current_tick_, target);
+            return;
+        }
+        while (current_tick_ < target && timed_ > 0) {
+            ++current_tick_;
+            if ((current_tick_ & (kTopSpan - 1)) == 0) cascade(kOverflowList);
+            for (int level = kLevels - 1; level > 0; --level) {
+                if ((current_tick_ & ((int64_t{1} << (kSlotBits * level)) - 1)) == 0) {
+                    cascade(listFor(level, current_tick_));
+                }
+            }
+            fire(listFor(0, current_tick_), expired);
+        }
+        current_tick_ = std::max(current_tick_, target);
+    }
+
+    // Releases every kSessionEnd entry
+    void expireSession(std::vector<T>& expired) {
+        fire(kSessionList, expired);
+    }
+
+    std::size_t size() const { return nodes_.size() - free_count_; }
+
+private:
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr int kLevels = 4;
+    static constexpr int64_t kTopSpan = int64_t{1} << (kSlotBits * kLevels);
+    static constexpr uint32_t kOverflowList = kLevels * kSlots;
+    static constexpr uint32_t kSessionList = kOverflowList + 1;
+    static constexpr uint32_t kFree = kSessionList + 1;
+
+    struct Node {
+        int64_t tick = 0;
+        Handle prev = kNone;
+        Handle next = kNone;
+        uint32_t list = kFree;
+        T value{};
+    };
+
+    static uint32_t listFor(int level, int64_t tick) {
+        return static_cast<uint32_t>(level * kSlots + ((tick >> (kSlotBits * level)) & (kSlots - 1)));
+    }
+
+    // Lowest level whose current block also holds the deadline
+    void place(Handle h) {
+        const int64_t tick = nodes_[h].tick;
+        for (int level = 0; level < kLevels; ++level) {
+            if ((tick >> (kSlotBits * (level + 1))) == (current_tick_ >> (kSlotBits * (level + 1)))) {
+                link(h, listFor(level, tick));
+                return;
+            }
+        }
+        link(h, kOverflowList);
+    }
+
+    void cascade(uint32_t list) {
+        Handle h = heads_[list];
+        heads_[list] = kNone;
+        while (h != kNone) {
+            Handle next = nodes_[h].next;
+            place(h);
+            h = next;
+        }
+    }
+
+    void fire(uint32_t list, std::vector<T>& expired) {
+        Handle h = heads_[list];
+        heads_[list] = kNone;
+        while (h != kNone) {
+            Handle next = nodes_[h].next;
+            if (nodes_[h].tick != kSessionEnd) --timed_;
+            expired.push_back(std::move(nodes_[h].value));
+            release(h);
+            h = next;
+        }
+    }
+
+    void link(Handle h, uint32_t list) {
+        Node& node = nodes_[h];
+        node.list = list;
+        node.prev = kNone;
+        node.next = heads_[list];
+        if (node.next != kNone) nodes_[node.next].prev = h;
+        heads_[list] = h;
+    }
+
+    void unlink(Handle h) {
+        Node& node = nodes_[h];
+        if (node.prev != kNone) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.list] = node.next;
+        }
+        if (node.next != kNone) nodes_[node.next].prev = node.prev;
+    }
+
+    // Nodes are pooled; handles are indices and stay valid until released
+    Handle allocate() {
+        if (free_head_ != kNone) {
+            Handle h = free_head_;
+            free_head_ = nodes_[h].next;
+            --free_count_;
+            return h;
+        }
+        nodes_.emplace_back();
+        return static_cast<Handle>(nodes_.size() - 1);
+    }
+
+    void release(Handle h) {
+        Node& node = nodes_[h];
+        node.value = T{};
+        node.list = kFree;
+        node.prev = kNone;
+        node.next = free_head_;
+        free_head_ = h;
+        ++free_count_;
+    }
+
+    int64_t tick_us_;
+    int64_t current_tick_;
+    std::size_t timed_ = 0;
+    std::vector<Node> nodes_;
+    Handle free_head_ = kNone;
+    std::size_t free_count_ = 0;
+    std::array<Handle, kSessionList + 1> heads_;
+};
@@ -2,19 +2,64 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <ctime>
 
 namespace Utils {
     std::string getCurrentTimestamp() {
+        return formatTimestamp(nowMicros());
+    }
+
+    int64_t nowMicros() {
         using namespace std::chrono;
-        auto now = system_clock::now();
-        auto t = system_clock::to_time_t(now);
-        auto us = duration_cast<microseconds>(now.time_since_epoch()) % 1000000;
+        return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+    }
+
+    std::string formatTimestamp(int64_t micros_since_epoch) {
+        std::time_t t = static_cast<std::time_t>(micros_since_epoch / 1000000);
+        int64_t us = micros_since_epoch % 1000000;
+        std::tm tm{};
+        // Reentrant: called from matching and gateway threads at once
+#if defined(_WIN32)
+        gmtime_s(&tm, &t);
+#else
+        gmtime_r(&t, &tm);
+#endif
         std::ostringstream oss;
-        oss << std::put_time(std::gmtime(&t), "%Y-%m-%dT%H:%M:%S");
-        oss << '.' << std::setfill('0') << std::setw(6) << us.count() << "Z";
+        oss << std::put_time(&tm, "%Y-%m-%dT%H:%M:%S");
+        oss << '.' << std::setfill('0') << std::setw(6) << us << "Z";
         return oss.str();
     }
 
+    bool parseTimestamp(const std::string& ts, int64_t& micros_since_epoch) {
+        // Fixed layout: YYYY-MM-DDTHH:MM:SS.ffffffZ
+        if (ts.size() != 27 || ts[4] != '-' || ts[7] != '-' || ts[10] != 'T' || ts[13] != ':' ||
+            ts[16] != ':' || ts[19] != '.' || ts[26] != 'Z') {
+            return false;
+        }
+        auto digits = [&ts](std::size_t pos, std::size_t len, int64_t& out) {
+            out = 0;
+            for (std::size_t i = pos; i < pos + len; ++i) {
+                if (ts[i] < '0' || ts[i] > '9') return false;
+                out = out * 10 + (ts[i] - '0');
+            }
+            return true;
+        };
+        int64_t y, m, d, hh, mm, ss, us;
+        if (!digits(0, 4, y) || !digits(5, 2, m) || !digits(8, 2, d) || !digits(11, 2, hh) ||
+            !digits(14, 2, mm) || !digits(17, 2, ss) || !digits(20, 6, us)) {
+            return false;
+        }
+        // Days from civil date (proleptic Gregorian), avoiding timegm
+        y -= m <= 2;
+        int64_t era = (y >= 0 ? y : y - 399) / 400;
+        int64_t yoe = y - era * 400;
+        int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        int64_t days = era * 146097 + doe - 719468;
+        micros_since_epoch = ((days * 24 + hh) * 60 + mm) * 60 * 1000000 + ss * 1000000 + us;
+        return true;
+    }
+
     std::string toUpper(const std::string& str) {
         std::string out = str;
         std::transform(out.begin(), out.end(), out.begin(), ::toupper);
@@ -26,4 +71,10 @@ namespace Utils {
         std::transform(out.begin(), out.end(), out.begin(), ::tolower);
         return out;
     }
+
+    std::size_t roundUpToPowerOfTwo(std::size_t n) {
+        std::size_t capacity = 1;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
 } 
\ No newline at end of file
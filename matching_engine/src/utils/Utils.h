@@ -1,9 +1,21 @@
 #pragma once
 #include <string>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 
 namespace Utils {
+    // Quantities are doubles; dust left by repeated subtraction counts as zero
+    inline constexpr double kQuantityEpsilon = 1e-9;
+
     std::string getCurrentTimestamp();
+    int64_t nowMicros(); // Wall clock, microseconds since the epoch
+    // ISO-8601 UTC with microseconds, e.g. 2025-06-14T10:00:00.000000Z
+    std::string formatTimestamp(int64_t micros_since_epoch);
+    // Inverse of formatTimestamp; false if the string is not in that format
+    bool parseTimestamp(const std::string& ts, int64_t& micros_since_epoch);
     std::string toUpper(const std::string& str);
     std::string toLower(const std::string& str);
+    // Smallest power of two >= n, for ring capacities indexed by mask
+    std::size_t roundUpToPowerOfTwo(std::size_t n);
 } 
\ No newline at end of file
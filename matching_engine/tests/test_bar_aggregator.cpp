@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "../src/core/BarAggregator.h"
+
+namespace {
+    Trade makeTrade(const std::string& timestamp, double price, double quantity) {
+        Trade t;
+        t.timestamp = timestamp;
+        t.symbol = "BTC-USDT";
+        t.price = price;
+        t.quantity = quantity;
+        t.aggressor_side = "buy";
+        return t;
+    }
+}
+
+TEST(BarAggregatorTest, BuildsOhlcvAndVwapPerInterval) {
+    BarAggregator bars;
+    bars.onTrade(makeTrade("2025-06-14T10:00:00.100000Z", 100.0, 1.0));
+    bars.onTrade(makeTrade("2025-06-14T10:00:00.500000Z", 105.0, 2.0));
+    bars.onTrade(makeTrade("2025-06-14T10:00:00.900000Z", 95.0, 1.0));
+    bars.onTrade(makeTrade("2025-06-14T10:00:01.200000Z", 101.0, 1.0));
+
+    auto secs = bars.getBars("BTC-USDT", BarAggregator::Interval::SEC_1);
+    ASSERT_EQ(secs.size(), 2u);
+    EXPECT_DOUBLE_EQ(secs[0].open, 100.0);
+    EXPECT_DOUBLE_EQ(secs[0].high, 105.0);
+    EXPECT_DOUBLE_EQ(secs[0].low, 95.0);
+    EXPECT_DOUBLE_EQ(secs[0].close, 95.0);
+    EXPECT_DOUBLE_EQ(secs[0].volume, 4.0);
+    EXPECT_DOUBLE_EQ(secs[0].vwap(), 101.25);
+    EXPECT_EQ(secs[0].trades, 3u);
+    EXPECT_EQ(secs[1].trades, 1u);
+
+    auto mins = bars.getBars("BTC-USDT", BarAggregator::Interval::MIN_1);
+    ASSERT_EQ(mins.size(), 1u);
+    EXPECT_EQ(mins[0].trades, 4u);
+    EXPECT_DOUBLE_EQ(mins[0].close, 101.0);
+}
+
+TEST(BarAggregatorTest, LateTradesLandInTheirOwnBar) {
+    BarAggregator bars;
+    bars.onTrade(makeTrade("2025-06-14T10:00:05.000000Z", 100.0, 1.0));
+    bars.onTrade(makeTrade("2025-06-14T10:00:03.000000Z", 90.0, 1.0));
+    auto secs = bars.getBars("BTC-USDT", BarAggregator::Interval::SEC_1);
+    ASSERT_EQ(secs.size(), 2u);
+    EXPECT_DOUBLE_EQ(secs[0].open, 90.0);
+    EXPECT_DOUBLE_EQ(secs[1].open, 100.0);
+
+    // Older than the retained window: dropped rather than overwriting a live bar
+    bars.onTrade(makeTrade("2025-06-14T09:00:00.000000Z", 80.0, 1.0));
+    EXPECT_EQ(bars.getDroppedTrades(), 1u);
+    EXPECT_EQ(bars.getBars("BTC-USDT", BarAggregator::Interval::SEC_1).size(), 2u);
+}
+
+TEST(BarAggregatorTest, RingKeepsOnlyTheRetainedWindow) {
+    BarAggregator bars;
+    for (std::size_t i = 0; i < BarAggregator::kHistory + 5; ++i) {
+        char ts[32];
+        std::snprintf(ts, sizeof(ts), "2025-06-14T10:%02zu:%02zu.000000Z", i / 60, i % 60);
+        bars.onTrade(makeTrade(ts, 100.0 + i, 1.0));
+    }
+    auto secs = bars.getBars("BTC-USDT", BarAggregator::Interval::SEC_1);
+    ASSERT_EQ(secs.size(), BarAggregator::kHistory);
+    EXPECT_DOUBLE_EQ(secs.front().open, 105.0);
+    EXPECT_EQ(bars.getBars("BTC-USDT", BarAggregator::Interval::SEC_1, 10).size(), 10u);
+    EXPECT_TRUE(bars.getBars("ETH-USDT", BarAggregator::Interval::SEC_1).empty());
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "../src/api/MarketDataBus.h"
+#include "../src/core/MatchingEngine.h"
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    Order order(const std::string& id, Order::Type type, Order::Side side, double qty, double price) {
+        return Order(id, "BTC-USDT", type, side, qty, price, "2025-06-14T10:00:00.000000Z");
+    }
+
+    std::string ringName(const std::string& test) {
+        return "/me_test_" + test + "_" + std::to_string(getpid());
+    }
+
+    std::vector<MarketDataMessage> drain(MarketDataReader& reader) {
+        std::vector<MarketDataMessage> messages;
+        MarketDataMessage m;
+        while (reader.poll(m)) messages.push_back(m);
+        return messages;
+    }
+
+    // Feeds the bus the way main() does
+    void wire(MatchingEngine& engine, MarketDataBus& bus) {
+        engine.setOnTrade([&bus](const Trade& trade) { bus.onTrade(trade); });
+        engine.setOnBookUpdate([&bus](const std::string& symbol) { bus.onBookUpdate(symbol); });
+    }
+}
+
+TEST(MarketDataBusTest, ReaderSeesTradesBboAndLevelDeltasInOrder) {
+    auto engine = std::make_shared<MatchingEngine>();
+    MarketDataBus bus(engine, ringName("order"), 64, 5);
+    wire(*engine, bus);
+    MarketDataReader reader(ringName("order"));
+
+    engine->processOrder(order("a1", Order::Type::LIMIT, Order::Side::SELL, 2.0, 101.0));
+    auto messages = drain(reader);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].type, MarketDataMessage::Type::BBO);
+    EXPECT_EQ(messages[0].getSymbol(), "BTC-USDT");
+    EXPECT_DOUBLE_EQ(messages[0].top.ask_price, 101.0);
+    EXPECT_DOUBLE_EQ(messages[0].top.bid_price, 0.0);
+    EXPECT_EQ(messages[1].type, MarketDataMessage::Type::LEVEL);
+    EXPECT_EQ(messages[1].side, 1);
+    EXPECT_DOUBLE_EQ(messages[1].level.price, 101.0);
+    EXPECT_DOUBLE_EQ(messages[1].level.quantity, 2.0);
+
+    // Takes the whole level: trade first, then the book catches up
+    engine->processOrder(order("b1", Order::Type::LIMIT, Order::Side::BUY, 2.0, 101.0));
+    messages = drain(reader);
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0].type, MarketDataMessage::Type::TRADE);
+    EXPECT_EQ(messages[0].side, 0);
+    EXPECT_DOUBLE_EQ(messages[0].trade.price, 101.0);
+    EXPECT_DOUBLE_EQ(messages[0].trade.quantity, 2.0);
+    EXPECT_EQ(messages[0].trade.sequence, 1u);
+    EXPECT_GT(messages[0].trade.timestamp_us, 0);
+    EXPECT_EQ(messages[1].type, MarketDataMessage::Type::BBO);
+    EXPECT_DOUBLE_EQ(messages[1].top.ask_price, 0.0);
+    EXPECT_EQ(messages[2].type, MarketDataMessage::Type::LEVEL);
+    EXPECT_DOUBLE_EQ(messages[2].level.price, 101.0);
+    EXPECT_DOUBLE_EQ(messages[2].level.quantity, 0.0);
+
+    EXPECT_EQ(reader.position(), bus.published() + 1);
+    EXPECT_EQ(reader.lost(), 0u);
+}
+
+TEST(MarketDataBusTest, LappedReaderCountsLossAndResumes) {
+    auto engine = std::make_shared<MatchingEngine>();
+    MarketDataBus bus(engine, ringName("lap"), 8, 50);
+    wire(*engine, bus);
+    MarketDataReader reader(ringName("lap"));
+
+    // Each new level is a BBO change or a LEVEL delta: well over 8 messages
+    for (int i = 0; i < 10; ++i) {
+        engine->processOrder(order("a" + std::to_string(i), Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0 - i));
+    }
+    const uint64_t published = bus.published();
+    ASSERT_GT(published, 8u);
+
+    auto messages = drain(reader);
+    EXPECT_GT(reader.lost(), 0u);
+    EXPECT_EQ(messages.size() + reader.lost(), published);
+    EXPECT_EQ(reader.position(), published + 1);
+    // What survives is the newest part of the stream
+    ASSERT_FALSE(messages.empty());
+    EXPECT_EQ(messages.back().type, MarketDataMessage::Type::LEVEL);
+    EXPECT_DOUBLE_EQ(messages.back().level.price, 91.0);
+}
+
+TEST(MarketDataBusTest, ReaderNeedsAnExistingRing) {
+    EXPECT_THROW(MarketDataReader(ringName("missing")), std::runtime_error);
+}
+
+TEST(MarketDataBusTest, L3SnapshotLinesUpWithOrderMessages) {
+    auto engine = std::make_shared<MatchingEngine>();
+    MarketDataBus bus(engine, ringName("l3"), 64, 5);
+    bus.enableL3();
+    wire(*engine, bus);
+    MarketDataReader reader(ringName("l3"));
+
+    engine->processOrder(order("a1", Order::Type::LIMIT, Order::Side::SELL, 2.0, 101.0));
+    std::vector<L3Order> snapshot;
+    const uint64_t as_of = bus.l3Snapshot("BTC-USDT", snapshot);
+    ASSERT_EQ(snapshot.size(), 1u);
+    EXPECT_EQ(snapshot[0].side, Order::Side::SELL);
+    const uint64_t ref = snapshot[0].order_ref;
+
+    engine->processOrder(order("b1", Order::Type::LIMIT, Order::Side::BUY, 0.5, 101.0));
+    std::vector<std::pair<uint64_t, MarketDataMessage>> l3;
+    MarketDataMessage m;
+    for (uint64_t sequence = reader.position(); reader.poll(m); sequence = reader.position()) {
+        if (m.type >= MarketDataMessage::Type::ORDER_ADD) l3.emplace_back(sequence, m);
+    }
+    // The ADD is already in the snapshot; only the execution follows it
+    ASSERT_EQ(l3.size(), 2u);
+    EXPECT_EQ(l3[0].second.type, MarketDataMessage::Type::ORDER_ADD);
+    EXPECT_LE(l3[0].first, as_of);
+    EXPECT_GT(l3[1].first, as_of);
+    EXPECT_EQ(l3[1].second.type, MarketDataMessage::Type::ORDER_EXECUTE);
+    EXPECT_EQ(l3[1].second.side, 1);
+    EXPECT_EQ(l3[1].second.order.order_ref, ref);
+    EXPECT_DOUBLE_EQ(l3[1].second.order.quantity, 0.5);
+    EXPECT_EQ(bus.getL3SnapshotJSON("BTC-USDT"),
+              "{\"asks\":[[" + std::to_string(ref) + "," + std::to_string(snapshot[0].priority) +
+              ",101.0,1.5]],\"bids\":[],\"sequence\":" + std::to_string(bus.published()) + ",\"symbol\":\"BTC-USDT\"}");
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "../src/core/MatchingEngine.h"
 #include "../src/core/Order.h"
+#include "../src/utils/Utils.h"
 
 // --- LIMIT ORDER MATCHING ---
 TEST(MatchingEngineTest, LimitOrder_MatchAndAddRemainder) {
@@ -121,4 +122,673 @@ TEST(MatchingEngineTest, PartialFill_MultipleLevels) {
     EXPECT_EQ(trades[1].price, 50100.0);
     EXPECT_EQ(trades[1].quantity, 1.5);
     EXPECT_EQ(buy.getStatus(), Order::Status::FILLED);
-} 
\ No newline at end of file
+} 
+
+// --- CANCEL ---
+TEST(MatchingEngineTest, CancelRestingOrder) {
+    MatchingEngine engine;
+    engine.processOrder(Order("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z"));
+    EXPECT_TRUE(engine.cancelOrder("BTC-USDT", "s1", Order::Side::SELL, 50000.0));
+    EXPECT_FALSE(engine.cancelOrder("BTC-USDT", "s1", Order::Side::SELL, 50000.0));
+    EXPECT_FALSE(engine.cancelOrder("ETH-USDT", "s1", Order::Side::SELL, 50000.0));
+    // Nothing left to match
+    Order buy("b1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 1.0, 50000.0, "2025-06-14T10:01:00.000000Z");
+    EXPECT_TRUE(engine.processOrder(buy).empty());
+}
+
+TEST(MatchingEngineTest, TopOfBookUpdatedAfterMatching) {
+    MatchingEngine engine;
+    Order sell1("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    Order sell2("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 2.0, 50100.0, "2025-06-14T10:00:01.000000Z");
+    engine.processOrder(sell1);
+    engine.processOrder(sell2);
+    Order buy("b1", "BTC-USDT", Order::Type::MARKET, Order::Side::BUY, 1.5, 0.0, "2025-06-14T10:00:02.000000Z");
+    engine.processOrder(buy);
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.ask_price, 50100.0);
+    EXPECT_DOUBLE_EQ(top.ask_size, 1.5);
+    EXPECT_DOUBLE_EQ(top.bid_price, 0.0);
+}
+
+// --- SELF-TRADE PREVENTION ---
+namespace {
+    Order accountOrder(const std::string& id, Order::Type type, Order::Side side, double qty, double price,
+                       const std::string& account, Order::SelfTradePrevention stp = Order::SelfTradePrevention::CANCEL_TAKER) {
+        Order order(id, "BTC-USDT", type, side, qty, price, "2025-06-14T10:00:00.000000Z");
+        order.setAccount(account);
+        order.setSelfTradePrevention(stp);
+        return order;
+    }
+}
+
+TEST(MatchingEngineTest, SelfTrade_CancelTakerKeepsMaker) {
+    MatchingEngine engine;
+    engine.processOrder(accountOrder("s1", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "A"));
+    Order buy = accountOrder("b1", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0, "A");
+    EXPECT_TRUE(engine.processOrder(buy).empty());
+    EXPECT_EQ(buy.getStatus(), Order::Status::CANCELLED);
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.ask_size, 1.0);
+    EXPECT_DOUBLE_EQ(top.bid_price, 0.0); // Taker did not rest
+}
+
+TEST(MatchingEngineTest, SelfTrade_CancelMakerTradesThrough) {
+    MatchingEngine engine;
+    std::vector<std::string> reduced;
+    engine.setOnOrderReduced([&](const Order& o) {
+        EXPECT_EQ(o.getStatus(), Order::Status::CANCELLED);
+        reduced.push_back(o.getOrderId());
+    });
+    engine.processOrder(accountOrder("s1", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "A"));
+    engine.processOrder(accountOrder("s2", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "B"));
+    Order buy = accountOrder("b1", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0, "A",
+                             Order::SelfTradePrevention::CANCEL_MAKER);
+    auto trades = engine.processOrder(buy);
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].maker_order_id, "s2");
+    EXPECT_EQ(buy.getStatus(), Order::Status::FILLED);
+    EXPECT_EQ(reduced, std::vector<std::string>{"s1"});
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_price, 0.0);
+}
+
+TEST(MatchingEngineTest, SelfTrade_CancelBothStopsAfterEarlierFills) {
+    MatchingEngine engine;
+    engine.processOrder(accountOrder("s1", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "B"));
+    engine.processOrder(accountOrder("s2", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50100.0, "A"));
+    engine.processOrder(accountOrder("s3", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50200.0, "B"));
+    Order buy = accountOrder("b1", Order::Type::LIMIT, Order::Side::BUY, 3.0, 50200.0, "A",
+                             Order::SelfTradePrevention::CANCEL_BOTH);
+    auto trades = engine.processOrder(buy);
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].maker_order_id, "s1");
+    EXPECT_EQ(buy.getStatus(), Order::Status::CANCELLED);
+    EXPECT_DOUBLE_EQ(buy.getQuantity(), 2.0);
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.ask_price, 50200.0); // s2 cancelled, s3 untouched
+    EXPECT_DOUBLE_EQ(top.bid_price, 0.0);
+}
+
+TEST(MatchingEngineTest, SelfTrade_DecrementShrinksBothWithoutTrade) {
+    MatchingEngine engine;
+    auto risk = std::make_shared<RiskManager>();
+    engine.setRiskManager(risk);
+    engine.processOrder(accountOrder("s1", Order::Type::LIMIT, Order::Side::SELL, 3.0, 50000.0, "A"));
+    Order buy = accountOrder("b1", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0, "A",
+                             Order::SelfTradePrevention::DECREMENT);
+    EXPECT_TRUE(engine.processOrder(buy).empty());
+    EXPECT_EQ(buy.getStatus(), Order::Status::CANCELLED);
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_size, 2.0);
+    EXPECT_DOUBLE_EQ(risk->getPosition("A", "BTC-USDT"), 0.0);
+    EXPECT_EQ(risk->getOpenOrders("A"), 1);
+    // The shrunken maker still trades with other accounts
+    Order other = accountOrder("b2", Order::Type::IOC, Order::Side::BUY, 5.0, 50000.0, "B");
+    auto trades = engine.processOrder(other);
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_DOUBLE_EQ(trades[0].quantity, 2.0);
+}
+
+TEST(MatchingEngineTest, SelfTrade_FOKCountsOnlyReachableLiquidity) {
+    MatchingEngine engine;
+    engine.processOrder(accountOrder("s1", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "A"));
+    engine.processOrder(accountOrder("s2", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "B"));
+    Order fok = accountOrder("b1", Order::Type::FOK, Order::Side::BUY, 1.0, 50000.0, "A");
+    EXPECT_TRUE(engine.processOrder(fok).empty());
+    EXPECT_EQ(fok.getStatus(), Order::Status::CANCELLED);
+    Order skip = accountOrder("b2", Order::Type::FOK, Order::Side::BUY, 1.0, 50000.0, "A",
+                              Order::SelfTradePrevention::CANCEL_MAKER);
+    auto trades = engine.processOrder(skip);
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].maker_order_id, "s2");
+    EXPECT_EQ(skip.getStatus(), Order::Status::FILLED);
+}
+
+// --- ICEBERG ORDERS ---
+TEST(MatchingEngineTest, Iceberg_ShowsOnlyDisplayQuantity) {
+    MatchingEngine engine;
+    Order sell("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 10.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    sell.setDisplayQuantity(2.0);
+    engine.processOrder(sell);
+    EXPECT_DOUBLE_EQ(sell.getQuantity(), 10.0); // Caller's copy keeps the full leaves
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_size, 2.0);
+}
+
+TEST(MatchingEngineTest, Iceberg_RefillRequeuesAtLevelTail) {
+    MatchingEngine engine;
+    Order iceberg("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 5.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    iceberg.setDisplayQuantity(2.0);
+    engine.processOrder(iceberg);
+    engine.processOrder(Order("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:01.000000Z"));
+    // Exhausts the first slice; the refill goes behind s2
+    Order buy("b1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 3.0, 50000.0, "2025-06-14T10:01:00.000000Z");
+    auto trades = engine.processOrder(buy);
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].maker_order_id, "s1");
+    EXPECT_DOUBLE_EQ(trades[0].quantity, 2.0);
+    EXPECT_EQ(trades[1].maker_order_id, "s2");
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_size, 2.0);
+    // A large taker drains the rest, refilling as it goes
+    Order sweep("b2", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 10.0, 50000.0, "2025-06-14T10:02:00.000000Z");
+    trades = engine.processOrder(sweep);
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_DOUBLE_EQ(trades[0].quantity, 2.0);
+    EXPECT_DOUBLE_EQ(trades[1].quantity, 1.0);
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_price, 0.0);
+}
+
+TEST(MatchingEngineTest, Iceberg_FOKCountsReserve) {
+    MatchingEngine engine;
+    Order iceberg("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 5.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    iceberg.setDisplayQuantity(1.0);
+    engine.processOrder(iceberg);
+    Order fok("b1", "BTC-USDT", Order::Type::FOK, Order::Side::BUY, 4.0, 50000.0, "2025-06-14T10:01:00.000000Z");
+    auto trades = engine.processOrder(fok);
+    EXPECT_EQ(trades.size(), 4);
+    EXPECT_EQ(fok.getStatus(), Order::Status::FILLED);
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_size, 1.0);
+}
+
+TEST(MatchingEngineTest, LevelSizeFollowsFillsRefillsAndCancels) {
+    MatchingEngine engine;
+    Order iceberg("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 4.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    iceberg.setDisplayQuantity(1.5);
+    engine.processOrder(iceberg);
+    engine.processOrder(Order("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 2.0, 50000.0, "2025-06-14T10:00:01.000000Z"));
+    engine.processOrder(Order("s3", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 0.5, 50000.0, "2025-06-14T10:00:02.000000Z"));
+    auto book = engine.getBook("BTC-USDT");
+    EXPECT_DOUBLE_EQ(book->getTopOfBook().ask_size, 4.0);
+    // Drains s1's slice (refilled behind s3) and part of s2
+    engine.processOrder(Order("b1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 2.0, 50000.0, "2025-06-14T10:01:00.000000Z"));
+    EXPECT_DOUBLE_EQ(book->getTopOfBook().ask_size, 3.5);
+    EXPECT_TRUE(engine.cancelOrder("BTC-USDT", "s3", Order::Side::SELL, 50000.0));
+    EXPECT_DOUBLE_EQ(book->getTopOfBook().ask_size, 3.0);
+}
+
+// --- STOP ORDERS ---
+TEST(MatchingEngineTest, Stop_ParksUntilTradeReachesTrigger) {
+    MatchingEngine engine;
+    engine.processOrder(Order("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z"));
+    engine.processOrder(Order("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 2.0, 50100.0, "2025-06-14T10:00:01.000000Z"));
+    Order stop("st1", "BTC-USDT", Order::Type::STOP, Order::Side::BUY, 1.0, 0.0, "2025-06-14T10:00:02.000000Z");
+    stop.setStopPrice(50000.0);
+    EXPECT_TRUE(engine.processOrder(stop).empty());
+    EXPECT_EQ(stop.getStatus(), Order::Status::NEW);
+    EXPECT_EQ(engine.getBook("BTC-USDT")->stops_.size(), 1u);
+
+    // Trade at 50000 fires the stop in the same pass; it buys at 50100
+    Order buy("b1", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0, "2025-06-14T10:01:00.000000Z");
+    auto trades = engine.processOrder(buy);
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].taker_order_id, "b1");
+    EXPECT_EQ(trades[1].taker_order_id, "st1");
+    EXPECT_DOUBLE_EQ(trades[1].price, 50100.0);
+    EXPECT_LT(trades[0].sequence, trades[1].sequence);
+    // Both fills happened now, whenever the stop was parked
+    EXPECT_EQ(trades[1].timestamp, trades[0].timestamp);
+    EXPECT_NE(trades[1].timestamp, stop.getTimestamp());
+    EXPECT_EQ(engine.getBook("BTC-USDT")->stops_.size(), 0u);
+}
+
+TEST(MatchingEngineTest, Stop_CascadeAndStopLimitRests) {
+    MatchingEngine engine;
+    engine.processOrder(Order("b1", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z"));
+    engine.processOrder(Order("b2", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 1.0, 49900.0, "2025-06-14T10:00:01.000000Z"));
+    Order first("st1", "BTC-USDT", Order::Type::STOP, Order::Side::SELL, 1.0, 0.0, "2025-06-14T10:00:02.000000Z");
+    first.setStopPrice(50000.0);
+    engine.processOrder(first);
+    // Fired by st1's trade at 49900, then rests at its limit
+    Order second("st2", "BTC-USDT", Order::Type::STOP_LIMIT, Order::Side::SELL, 1.0, 49950.0, "2025-06-14T10:00:03.000000Z");
+    second.setStopPrice(49900.0);
+    engine.processOrder(second);
+
+    Order sell("s1", "BTC-USDT", Order::Type::IOC, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:01:00.000000Z");
+    auto trades = engine.processOrder(sell);
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[1].taker_order_id, "st1");
+    EXPECT_DOUBLE_EQ(trades[1].price, 49900.0);
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.ask_price, 49950.0);
+    EXPECT_TRUE(engine.cancelOrder("BTC-USDT", "st2", Order::Side::SELL, 49950.0));
+}
+
+TEST(MatchingEngineTest, Stop_CancelWhileParked) {
+    MatchingEngine engine;
+    Order stop("st1", "BTC-USDT", Order::Type::STOP, Order::Side::SELL, 1.0, 0.0, "2025-06-14T10:00:00.000000Z");
+    stop.setStopPrice(49000.0);
+    engine.processOrder(stop);
+    EXPECT_TRUE(engine.cancelOrder("BTC-USDT", "st1", Order::Side::SELL, 0.0));
+    EXPECT_FALSE(engine.cancelOrder("BTC-USDT", "st1", Order::Side::SELL, 0.0));
+}
+
+// --- EXPIRY ---
+TEST(MatchingEngineTest, Expiry_GTTCancelsRestingOrder) {
+    MatchingEngine engine;
+    std::vector<std::string> expired;
+    engine.setOnOrderReduced([&](const Order& o) {
+        EXPECT_EQ(o.getStatus(), Order::Status::CANCELLED);
+        expired.push_back(o.getOrderId());
+    });
+    // On a millisecond, where the wheel's tick ends
+    const int64_t deadline = (Utils::nowMicros() / 1000 + 60'000) * 1000;
+    Order gtt("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    gtt.setTimeInForce(Order::TimeInForce::GTT, deadline);
+    engine.processOrder(gtt);
+    engine.processOrder(Order("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50100.0, "2025-06-14T10:00:01.000000Z"));
+
+    EXPECT_EQ(engine.expireOrders(deadline - 1000), 0u);
+    EXPECT_EQ(engine.expireOrders(deadline), 1u);
+    EXPECT_EQ(expired, std::vector<std::string>{"s1"});
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_price, 50100.0);
+}
+
+TEST(MatchingEngineTest, Expiry_FilledOrderDropsItsTimer) {
+    MatchingEngine engine;
+    const int64_t deadline = Utils::nowMicros() + 60'000'000;
+    Order gtt("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    gtt.setTimeInForce(Order::TimeInForce::GTT, deadline);
+    engine.processOrder(gtt);
+    engine.processOrder(Order("b1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 1.0, 50000.0, "2025-06-14T10:01:00.000000Z"));
+    EXPECT_EQ(engine.getBook("BTC-USDT")->expiries_.size(), 0u);
+    EXPECT_EQ(engine.expireOrders(deadline), 0u);
+}
+
+TEST(MatchingEngineTest, Expiry_SessionEndCancelsDayOrdersOnly) {
+    MatchingEngine engine;
+    Order day("b1", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 1.0, 49000.0, "2025-06-14T10:00:00.000000Z");
+    day.setTimeInForce(Order::TimeInForce::DAY);
+    engine.processOrder(day);
+    engine.processOrder(Order("b2", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 1.0, 48000.0, "2025-06-14T10:00:01.000000Z"));
+    EXPECT_EQ(engine.expireOrders(Utils::nowMicros() + 3'600'000'000), 0u);
+    EXPECT_EQ(engine.endSession(), 1u);
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().bid_price, 48000.0);
+    EXPECT_FALSE(engine.cancelOrder("BTC-USDT", "b1", Order::Side::BUY, 49000.0));
+}
+
+// --- MASS CANCEL ---
+namespace {
+    Order ownedOrder(const std::string& id, const std::string& symbol, Order::Side side, double price,
+                     const std::string& account, uint64_t session) {
+        Order order(id, symbol, Order::Type::LIMIT, side, 1.0, price, "2025-06-14T10:00:00.000000Z");
+        order.setAccount(account);
+        order.setSessionId(session);
+        return order;
+    }
+}
+
+TEST(MatchingEngineTest, MassCancel_ByAccountAndSymbol) {
+    MatchingEngine engine;
+    auto risk = std::make_shared<RiskManager>();
+    engine.setRiskManager(risk);
+    engine.processOrder(ownedOrder("a1", "BTC-USDT", Order::Side::BUY, 49000.0, "A", 0));
+    engine.processOrder(ownedOrder("a2", "BTC-USDT", Order::Side::SELL, 51000.0, "A", 0));
+    engine.processOrder(ownedOrder("a3", "ETH-USDT", Order::Side::BUY, 3000.0, "A", 0));
+    engine.processOrder(ownedOrder("b1", "BTC-USDT", Order::Side::BUY, 49000.0, "B", 0));
+    Order stop("a4", "BTC-USDT", Order::Type::STOP, Order::Side::SELL, 1.0, 0.0, "2025-06-14T10:00:00.000000Z");
+    stop.setAccount("A");
+    stop.setStopPrice(48000.0);
+    engine.processOrder(stop);
+    EXPECT_EQ(risk->getOpenOrders("A"), 4u);
+
+    std::vector<std::string> cancelled;
+    engine.setOnOrderReduced([&](const Order& o) { cancelled.push_back(o.getOrderId()); });
+    EXPECT_EQ(engine.cancelAllForAccount("A", "BTC-USDT"), 3u);
+    EXPECT_EQ(cancelled.size(), 3u);
+    EXPECT_EQ(risk->getOpenOrders("A"), 1u);
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.bid_size, 1.0); // b1 untouched
+    EXPECT_DOUBLE_EQ(top.ask_price, 0.0);
+    EXPECT_EQ(engine.getBook("BTC-USDT")->stops_.size(), 0u);
+
+    EXPECT_EQ(engine.cancelAllForAccount("A"), 1u);
+    EXPECT_EQ(engine.cancelAllForAccount("A"), 0u);
+}
+
+TEST(MatchingEngineTest, MassCancel_BySessionSkipsFilledOrders) {
+    MatchingEngine engine;
+    engine.processOrder(ownedOrder("s1", "BTC-USDT", Order::Side::SELL, 50000.0, "", 7));
+    engine.processOrder(ownedOrder("s2", "BTC-USDT", Order::Side::SELL, 50100.0, "", 7));
+    engine.processOrder(ownedOrder("s3", "BTC-USDT", Order::Side::SELL, 50100.0, "", 8));
+    // s1 fills and must leave the session's list
+    engine.processOrder(Order("b1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 1.0, 50000.0, "2025-06-14T10:01:00.000000Z"));
+
+    EXPECT_EQ(engine.cancelAllForSession(7), 1u);
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.ask_price, 50100.0);
+    EXPECT_DOUBLE_EQ(top.ask_size, 1.0);
+    EXPECT_FALSE(engine.cancelOrder("BTC-USDT", "s2", Order::Side::SELL, 50100.0));
+    EXPECT_TRUE(engine.cancelOrder("BTC-USDT", "s3", Order::Side::SELL, 50100.0));
+}
+
+// --- MASS QUOTES ---
+namespace {
+    Quote makeQuote(const std::string& account, double bid, double bid_qty, double ask, double ask_qty,
+                    const std::string& id_prefix) {
+        Quote quote;
+        quote.account = account;
+        quote.timestamp = "2025-06-14T10:00:00.000000Z";
+        QuoteEntry entry;
+        entry.symbol = "BTC-USDT";
+        entry.bid_price = bid;
+        entry.bid_quantity = bid_qty;
+        entry.ask_price = ask;
+        entry.ask_quantity = ask_qty;
+        entry.bid_order_id = id_prefix + "b";
+        entry.ask_order_id = id_prefix + "a";
+        quote.entries.push_back(entry);
+        return quote;
+    }
+}
+
+TEST(MatchingEngineTest, Quote_RestsBothSidesAndAmendsInPlace) {
+    MatchingEngine engine;
+    auto risk = std::make_shared<RiskManager>();
+    engine.setRiskManager(risk);
+    std::vector<QuoteResult> results;
+    engine.processQuote(makeQuote("mm", 49990.0, 2.0, 50010.0, 2.0, "q1"), results);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].bid.order_id, "q1b");
+    EXPECT_EQ(results[0].ask.order_id, "q1a");
+    EXPECT_EQ(risk->getOpenOrders("mm"), 2u);
+    engine.processOrder(Order("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50010.0, "2025-06-14T10:00:01.000000Z"));
+
+    // Same prices, smaller ask: amended in place ahead of s2
+    engine.processQuote(makeQuote("mm", 49990.0, 2.0, 50010.0, 1.5, "q2"), results);
+    EXPECT_TRUE(results[0].ask.priority_kept);
+    EXPECT_EQ(results[0].ask.order_id, "q1a");
+    EXPECT_TRUE(results[0].bid.priority_kept);
+    EXPECT_TRUE(results[0].ask.replaced_order_id.empty());
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_size, 2.5);
+    auto trades = engine.processOrder(Order("t1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 1.0, 50010.0, "2025-06-14T10:01:00.000000Z"));
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].maker_order_id, "q1a");
+    EXPECT_EQ(risk->getOpenOrders("mm"), 2u);
+}
+
+TEST(MatchingEngineTest, Quote_PriceChangeOrSizeUpLosesPriority) {
+    MatchingEngine engine;
+    std::vector<QuoteResult> results;
+    engine.processQuote(makeQuote("mm", 49990.0, 1.0, 50010.0, 1.0, "q1"), results);
+    engine.processOrder(Order("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50010.0, "2025-06-14T10:00:01.000000Z"));
+    engine.processQuote(makeQuote("mm", 49980.0, 1.0, 50010.0, 3.0, "q2"), results);
+    EXPECT_EQ(results[0].bid.order_id, "q2b");
+    EXPECT_EQ(results[0].bid.replaced_order_id, "q1b");
+    EXPECT_EQ(results[0].ask.order_id, "q2a");
+    EXPECT_FALSE(results[0].ask.priority_kept);
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.bid_price, 49980.0);
+    EXPECT_DOUBLE_EQ(top.ask_size, 4.0);
+    auto trades = engine.processOrder(Order("t1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 1.0, 50010.0, "2025-06-14T10:01:00.000000Z"));
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].maker_order_id, "s2");
+}
+
+TEST(MatchingEngineTest, Quote_ZeroPullsSideAndFilledSideIsReentered) {
+    MatchingEngine engine;
+    std::vector<QuoteResult> results;
+    engine.processQuote(makeQuote("mm", 49990.0, 1.0, 50010.0, 1.0, "q1"), results);
+    engine.processOrder(Order("t1", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 1.0, 50010.0, "2025-06-14T10:01:00.000000Z"));
+    // The ask filled, so the same quote enters a new ask; the bid is pulled
+    engine.processQuote(makeQuote("mm", 49990.0, 0.0, 50010.0, 1.0, "q2"), results);
+    EXPECT_TRUE(results[0].bid.order_id.empty());
+    EXPECT_EQ(results[0].bid.replaced_order_id, "q1b");
+    EXPECT_EQ(results[0].ask.order_id, "q2a");
+    EXPECT_TRUE(results[0].ask.replaced_order_id.empty());
+    auto top = engine.getBook("BTC-USDT")->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.bid_price, 0.0);
+    EXPECT_DOUBLE_EQ(top.ask_size, 1.0);
+    // Quote sides are ordinary orders for session and account mass cancel
+    EXPECT_EQ(engine.cancelAllForAccount("mm"), 1u);
+    engine.processQuote(makeQuote("mm", 49990.0, 1.0, 50010.0, 1.0, "q3"), results);
+    EXPECT_EQ(results[0].ask.order_id, "q3a");
+}
+
+TEST(MatchingEngineTest, Quote_CrossingSideTrades) {
+    MatchingEngine engine;
+    engine.processOrder(Order("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z"));
+    std::vector<QuoteResult> results;
+    auto trades = engine.processQuote(makeQuote("mm", 50000.0, 3.0, 50020.0, 1.0, "q1"), results);
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].taker_order_id, "q1b");
+    EXPECT_EQ(results[0].bid.order_id, "q1b");
+    EXPECT_DOUBLE_EQ(results[0].bid.leaves_quantity, 2.0);
+}
+
+// --- CALL AUCTION ---
+namespace {
+    Order limit(const std::string& id, Order::Side side, double qty, double price, const std::string& account = "") {
+        Order order(id, "BTC-USDT", Order::Type::LIMIT, side, qty, price, "2025-06-14T10:00:00.000000Z");
+        order.setAccount(account);
+        return order;
+    }
+}
+
+TEST(MatchingEngineTest, Auction_AccumulatesWithoutMatching) {
+    MatchingEngine engine;
+    engine.startAuction("BTC-USDT");
+    EXPECT_TRUE(engine.processOrder(limit("s1", Order::Side::SELL, 1.0, 100.0)).empty());
+    Order bid = limit("b1", Order::Side::BUY, 2.0, 101.0);
+    EXPECT_TRUE(engine.processOrder(bid).empty());
+    EXPECT_EQ(bid.getStatus(), Order::Status::NEW);
+    Order ioc("b2", "BTC-USDT", Order::Type::IOC, Order::Side::BUY, 1.0, 101.0, "2025-06-14T10:00:00.000000Z");
+    EXPECT_TRUE(engine.processOrder(ioc).empty());
+    EXPECT_EQ(ioc.getStatus(), Order::Status::CANCELLED);
+
+    auto state = engine.getBook("BTC-USDT")->getAuctionState();
+    EXPECT_TRUE(state.active);
+    EXPECT_DOUBLE_EQ(state.volume, 1.0);
+    EXPECT_DOUBLE_EQ(state.imbalance, 1.0);
+    // Equal volume and imbalance at 100 and 101; no trade yet, so the
+    // range's middle is the reference and the lower price wins the tie
+    EXPECT_DOUBLE_EQ(state.price, 100.0);
+}
+
+TEST(MatchingEngineTest, Auction_IndicativeIsCurrentWhileTheBookIsBusy) {
+    MatchingEngine engine;
+    engine.startAuction("BTC-USDT");
+    auto book = engine.getBook("BTC-USDT");
+    uint64_t sequence = book->getAuctionState().sequence;
+    for (int i = 0; i < 5; ++i) {
+        engine.processOrder(limit("b" + std::to_string(i), Order::Side::BUY, 1.0, 100.0 + i));
+        engine.processOrder(limit("s" + std::to_string(i), Order::Side::SELL, 1.0, 100.0 + i));
+        // Published by the command itself: a reader needs no lock, even
+        // while a writer holds it
+        std::lock_guard<std::mutex> lock(book->mtx_);
+        AuctionState state = book->getAuctionState();
+        AuctionState fresh = book->equilibrium();
+        EXPECT_GT(state.sequence, sequence);
+        EXPECT_DOUBLE_EQ(state.price, fresh.price);
+        EXPECT_DOUBLE_EQ(state.volume, fresh.volume);
+        EXPECT_DOUBLE_EQ(state.imbalance, fresh.imbalance);
+        sequence = state.sequence;
+    }
+}
+
+TEST(MatchingEngineTest, Auction_UncrossesAtVolumeMaximizingPrice) {
+    MatchingEngine engine;
+    auto risk = std::make_shared<RiskManager>();
+    engine.setRiskManager(risk);
+    engine.startAuction("BTC-USDT");
+    engine.processOrder(limit("b1", Order::Side::BUY, 5.0, 101.0, "A"));
+    engine.processOrder(limit("b2", Order::Side::BUY, 3.0, 100.0, "A"));
+    engine.processOrder(limit("b3", Order::Side::BUY, 2.0, 99.0, "A"));
+    engine.processOrder(limit("s1", Order::Side::SELL, 4.0, 98.0, "B"));
+    engine.processOrder(limit("s2", Order::Side::SELL, 3.0, 100.0, "B"));
+    engine.processOrder(limit("s3", Order::Side::SELL, 5.0, 102.0, "B"));
+    // Executable: 4 at 98/99, 7 at 100, 5 at 101
+    auto book = engine.getBook("BTC-USDT");
+    auto state = book->getAuctionState();
+    EXPECT_DOUBLE_EQ(state.price, 100.0);
+    EXPECT_DOUBLE_EQ(state.volume, 7.0);
+    EXPECT_DOUBLE_EQ(state.imbalance, 1.0);
+
+    auto trades = engine.uncross("BTC-USDT");
+    double volume = 0.0;
+    for (const auto& t : trades) {
+        EXPECT_DOUBLE_EQ(t.price, 100.0);
+        EXPECT_EQ(t.aggressor_side, "none");
+        volume += t.quantity;
+    }
+    EXPECT_DOUBLE_EQ(volume, 7.0);
+    EXPECT_EQ(trades.front().taker_order_id, "b1");
+    EXPECT_EQ(trades.front().maker_order_id, "s1");
+    EXPECT_DOUBLE_EQ(risk->getPosition("A", "BTC-USDT"), 7.0);
+    EXPECT_DOUBLE_EQ(risk->getPosition("B", "BTC-USDT"), -7.0);
+
+    // What is left does not cross, and matching is continuous again
+    auto top = book->getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.bid_price, 100.0);
+    EXPECT_DOUBLE_EQ(top.bid_size, 1.0);
+    EXPECT_DOUBLE_EQ(top.ask_price, 102.0);
+    EXPECT_DOUBLE_EQ(top.last_price, 100.0);
+    EXPECT_FALSE(book->getAuctionState().active);
+    EXPECT_EQ(engine.processOrder(limit("s4", Order::Side::SELL, 1.0, 100.0)).size(), 1u);
+    EXPECT_TRUE(engine.uncross("BTC-USDT").empty());
+}
+
+TEST(MatchingEngineTest, Auction_CountsIcebergReserveAndPrefersLastTrade) {
+    MatchingEngine engine;
+    engine.processOrder(limit("s0", Order::Side::SELL, 1.0, 101.0));
+    engine.processOrder(limit("b0", Order::Side::BUY, 1.0, 101.0)); // Last trade 101
+    engine.startAuction("BTC-USDT");
+    Order iceberg = limit("s1", Order::Side::SELL, 6.0, 100.0);
+    iceberg.setDisplayQuantity(1.0);
+    engine.processOrder(iceberg);
+    engine.processOrder(limit("b1", Order::Side::BUY, 5.0, 101.0));
+    // 5 trades at 100 or 101 with the same imbalance; 101 is the last trade
+    auto state = engine.getBook("BTC-USDT")->getAuctionState();
+    EXPECT_DOUBLE_EQ(state.volume, 5.0);
+    EXPECT_DOUBLE_EQ(state.price, 101.0);
+    auto trades = engine.uncross("BTC-USDT");
+    EXPECT_EQ(trades.size(), 5u);
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_size, 1.0);
+}
+
+namespace {
+    // Seeds a 10% band around 100 with one trade
+    void seedBand(MatchingEngine& engine, int64_t auction_us) {
+        PriceBand band;
+        band.width = 0.10;
+        band.auction_us = auction_us;
+        engine.setPriceBand("BTC-USDT", band);
+        engine.processOrder(limit("s0", Order::Side::SELL, 1.0, 100.0));
+        engine.processOrder(limit("b0", Order::Side::BUY, 1.0, 100.0));
+        engine.processOrder(limit("s1", Order::Side::SELL, 1.0, 105.0));
+        engine.processOrder(limit("s2", Order::Side::SELL, 1.0, 120.0));
+    }
+}
+
+TEST(MatchingEngineTest, Band_BreachStopsSweepAndStartsAuction) {
+    MatchingEngine engine;
+    seedBand(engine, 0);
+    Order buy("m1", "BTC-USDT", Order::Type::MARKET, Order::Side::BUY, 2.0, 0.0, "2025-06-14T10:00:00.000000Z");
+    auto trades = engine.processOrder(buy);
+    // Fills at 105, stops before 120
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_DOUBLE_EQ(trades[0].price, 105.0);
+    auto book = engine.getBook("BTC-USDT");
+    EXPECT_EQ(book->getPhase(), OrderBook::Phase::AUCTION);
+    EXPECT_TRUE(book->getAuctionState().active);
+    // Orders now accumulate; the uncross reopens at the auction price
+    EXPECT_TRUE(engine.processOrder(limit("b1", Order::Side::BUY, 1.0, 121.0)).empty());
+    trades = engine.uncross("BTC-USDT");
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_DOUBLE_EQ(trades[0].price, 120.0);
+    EXPECT_EQ(book->getPhase(), OrderBook::Phase::CONTINUOUS);
+    // 120 is the new reference, so 130 is in band
+    engine.processOrder(limit("s3", Order::Side::SELL, 1.0, 130.0));
+    EXPECT_EQ(engine.processOrder(limit("b2", Order::Side::BUY, 1.0, 130.0)).size(), 1u);
+    EXPECT_EQ(book->getPhase(), OrderBook::Phase::CONTINUOUS);
+}
+
+TEST(MatchingEngineTest, Band_FOKIsKilledInsteadOfHalting) {
+    MatchingEngine engine;
+    seedBand(engine, 0);
+    Order fok("f1", "BTC-USDT", Order::Type::FOK, Order::Side::BUY, 2.0, 120.0, "2025-06-14T10:00:00.000000Z");
+    EXPECT_TRUE(engine.processOrder(fok).empty());
+    EXPECT_EQ(fok.getStatus(), Order::Status::CANCELLED);
+    EXPECT_EQ(engine.getBook("BTC-USDT")->getPhase(), OrderBook::Phase::CONTINUOUS);
+}
+
+TEST(MatchingEngineTest, Band_TimedAuctionUncrossesWhenDue) {
+    MatchingEngine engine;
+    seedBand(engine, 1'000'000);
+    engine.processOrder(limit("b1", Order::Side::BUY, 2.0, 125.0));
+    auto book = engine.getBook("BTC-USDT");
+    ASSERT_EQ(book->getPhase(), OrderBook::Phase::AUCTION);
+    int64_t now = Utils::nowMicros();
+    EXPECT_EQ(engine.uncrossDue(now), 0u);
+    EXPECT_EQ(engine.uncrossDue(now + 2'000'000), 1u);
+    EXPECT_EQ(book->getPhase(), OrderBook::Phase::CONTINUOUS);
+    EXPECT_DOUBLE_EQ(book->getTopOfBook().last_price, 120.0);
+}
+
+TEST(MatchingEngineTest, Band_EdgePrintsMoveReferenceByTheirWeight) {
+    MatchingEngine engine;
+    PriceBand band;
+    band.width = 0.10;
+    engine.setPriceBand("BTC-USDT", band);
+    auto print = [&](const std::string& id, double price) {
+        engine.processOrder(limit("s" + id, Order::Side::SELL, 1.0, price));
+        return engine.processOrder(limit("b" + id, Order::Side::BUY, 1.0, price)).size();
+    };
+    // Nine prints at 100, then three at the band edge well within a half-life
+    for (int i = 0; i < 9; ++i) ASSERT_EQ(print(std::to_string(i), 100.0), 1u);
+    ASSERT_EQ(print("e1", 109.9), 1u);
+    ASSERT_EQ(print("e2", 111.0), 1u);
+    ASSERT_EQ(print("e3", 112.0), 1u);
+    // The reference is about (900 + 332.9) / 12 = 102.7, so 115 breaches
+    EXPECT_EQ(print("x", 115.0), 0u);
+    EXPECT_EQ(engine.getBook("BTC-USDT")->getPhase(), OrderBook::Phase::AUCTION);
+}
+
+// --- ORDER-LEVEL (L3) EVENTS ---
+TEST(MatchingEngineTest, BookEvents_FollowRestingOrdersThroughMatching) {
+    MatchingEngine engine;
+    engine.setBookEventsEnabled(true);
+    Order iceberg = limit("s1", Order::Side::SELL, 3.0, 101.0);
+    iceberg.setDisplayQuantity(1.0);
+    engine.processOrder(iceberg);
+    engine.processOrder(limit("s2", Order::Side::SELL, 2.0, 101.0));
+    // Fills the iceberg's slice, which refills behind s2, then part of s2
+    engine.processOrder(limit("b1", Order::Side::BUY, 1.5, 101.0));
+    engine.cancelOrder("BTC-USDT", "s2", Order::Side::SELL, 101.0);
+
+    auto book = engine.getBook("BTC-USDT");
+    std::vector<BookEvent> events;
+    std::vector<L3Order> snapshot;
+    book->takeEvents(events, &snapshot);
+    using T = BookEvent::Type;
+    ASSERT_EQ(events.size(), 6u);
+    EXPECT_EQ(events[0].type, T::ADD);
+    EXPECT_EQ(events[0].order_ref, 1u);
+    EXPECT_DOUBLE_EQ(events[0].quantity, 1.0); // Visible only
+    EXPECT_EQ(events[1].type, T::ADD);
+    EXPECT_EQ(events[1].order_ref, 2u);
+    EXPECT_EQ(events[2].type, T::EXECUTE);
+    EXPECT_EQ(events[2].order_ref, 1u);
+    EXPECT_DOUBLE_EQ(events[2].quantity, 1.0);
+    EXPECT_EQ(events[3].type, T::MODIFY);
+    EXPECT_EQ(events[3].order_ref, 1u);
+    EXPECT_GT(events[3].priority, events[1].priority); // Now behind s2
+    EXPECT_DOUBLE_EQ(events[3].quantity, 1.0);
+    EXPECT_EQ(events[4].type, T::EXECUTE);
+    EXPECT_EQ(events[4].order_ref, 2u);
+    EXPECT_DOUBLE_EQ(events[4].quantity, 0.5);
+    EXPECT_EQ(events[5].type, T::DELETE);
+    EXPECT_EQ(events[5].order_ref, 2u);
+
+    ASSERT_EQ(snapshot.size(), 1u);
+    EXPECT_EQ(snapshot[0].order_ref, 1u);
+    EXPECT_EQ(snapshot[0].priority, events[3].priority);
+    EXPECT_DOUBLE_EQ(snapshot[0].quantity, 1.0);
+    events.clear();
+    book->takeEvents(events);
+    EXPECT_TRUE(events.empty());
+}
+
+TEST(MatchingEngineTest, BookEvents_OffByDefault) {
+    MatchingEngine engine;
+    engine.processOrder(limit("s1", Order::Side::SELL, 1.0, 101.0));
+    std::vector<BookEvent> events;
+    engine.getBook("BTC-USDT")->takeEvents(events);
+    EXPECT_TRUE(events.empty());
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include "../src/utils/Metrics.h"
+#include "../src/core/MatchingEngine.h"
+#include <thread>
+#include <vector>
+
+TEST(MetricsTest, CountersSumAcrossThreads) {
+    Metrics::reset();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 1000; ++i) Metrics::increment(Metrics::Counter::ORDERS_RECEIVED);
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(Metrics::get(Metrics::Counter::ORDERS_RECEIVED), 4000u);
+}
+
+TEST(MetricsTest, RenderIncludesRejectReasonsAndBooks) {
+    Metrics::reset();
+    Metrics::reject(Metrics::RejectReason::INVALID_SIDE);
+    Metrics::setGauge(Metrics::Gauge::WS_CONNECTIONS, 3);
+    std::string text = Metrics::render({{"BTC-USDT", 2, 1, 1, 1024}});
+    EXPECT_NE(text.find("matching_engine_orders_rejected_total{reason=\"invalid_side\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("matching_engine_book_resting_orders{symbol=\"BTC-USDT\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("matching_engine_ws_connections 3"), std::string::npos);
+}
+
+TEST(MetricsTest, EngineCountsTradesAndBookStats) {
+    Metrics::reset();
+    MatchingEngine engine;
+    engine.processOrder(Order("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z"));
+    engine.processOrder(Order("s2", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50100.0, "2025-06-14T10:00:01.000000Z"));
+    engine.processOrder(Order("b1", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0, "2025-06-14T10:01:00.000000Z"));
+    EXPECT_EQ(Metrics::get(Metrics::Counter::TRADES), 1u);
+    auto stats = engine.getBookStats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].first, "BTC-USDT");
+    EXPECT_EQ(stats[0].second.resting_orders, 1u);
+    EXPECT_EQ(stats[0].second.ask_levels, 1u);
+    EXPECT_EQ(stats[0].second.bid_levels, 0u);
+    EXPECT_GT(stats[0].second.memory_bytes, 0u);
+}
@@ -19,4 +19,18 @@ TEST(OrderTest, Setters) {
     EXPECT_EQ(order.getStatus(), Order::Status::PARTIALLY_FILLED);
     order.setQuantity(1.0);
     EXPECT_DOUBLE_EQ(order.getQuantity(), 1.0);
-} 
\ No newline at end of file
+} 
+TEST(OrderTest, IcebergSplitAndReplenish) {
+    Order order("id3", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 5.0, 50000.0, "2025-06-14T10:32:00.000000Z");
+    order.setDisplayQuantity(2.0);
+    order.splitReserve();
+    EXPECT_DOUBLE_EQ(order.getQuantity(), 2.0);
+    EXPECT_DOUBLE_EQ(order.getReserveQuantity(), 3.0);
+    order.setQuantity(0.0);
+    EXPECT_TRUE(order.replenish());
+    order.setQuantity(0.0);
+    EXPECT_TRUE(order.replenish());
+    EXPECT_DOUBLE_EQ(order.getQuantity(), 1.0); // Last slice is what is left
+    EXPECT_DOUBLE_EQ(order.getLeavesQuantity(), 1.0);
+    EXPECT_FALSE(order.replenish());
+}
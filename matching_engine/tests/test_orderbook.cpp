@@ -3,6 +3,7 @@
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <atomic>
+#include <thread>
 
 TEST(OrderBookTest, AddAndBBO) {
     OrderBook ob("BTC-USDT");
@@ -102,4 +103,41 @@ TEST(OrderBookTest, EdgeCases_EmptyBookAndSingleOrder) {
     bbo = ob.getBBO();
     EXPECT_DOUBLE_EQ(bbo.first, 50000.0);
     EXPECT_DOUBLE_EQ(bbo.second, 0.0);
-} 
\ No newline at end of file
+} 
+TEST(OrderBookTest, TopOfBookTracksSizeAndSequence) {
+    OrderBook ob("BTC-USDT");
+    ob.addOrder(std::make_shared<Order>("b1", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0, "2025-06-14T10:00:00.000000Z"));
+    ob.addOrder(std::make_shared<Order>("b2", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 2.5, 50000.0, "2025-06-14T10:00:01.000000Z"));
+    // Below the best bid: top of book is unchanged, so no new sequence
+    ob.addOrder(std::make_shared<Order>("b3", "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, 9.0, 49990.0, "2025-06-14T10:00:02.000000Z"));
+    auto top = ob.getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.bid_price, 50000.0);
+    EXPECT_DOUBLE_EQ(top.bid_size, 3.5);
+    EXPECT_DOUBLE_EQ(top.ask_size, 0.0);
+    EXPECT_EQ(top.sequence, 2u);
+    ob.removeOrder("b1", Order::Side::BUY, 50000.0);
+    top = ob.getTopOfBook();
+    EXPECT_DOUBLE_EQ(top.bid_size, 2.5);
+    EXPECT_EQ(top.sequence, 3u);
+}
+
+TEST(OrderBookTest, TopOfBookReadsAreNeverTorn) {
+    OrderBook ob("BTC-USDT");
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::thread reader([&]() {
+        while (!done) {
+            // The writer always keeps bid size equal to bid price / 1000
+            auto top = ob.getTopOfBook();
+            if (top.bid_price != 0.0 && top.bid_size != top.bid_price / 1000.0) ++torn;
+        }
+    });
+    for (int i = 1; i <= 5000; ++i) {
+        double price = 50000.0 + i;
+        ob.addOrder(std::make_shared<Order>("b" + std::to_string(i), "BTC-USDT", Order::Type::LIMIT, Order::Side::BUY, price / 1000.0, price, "2025-06-14T10:00:00.000000Z"));
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(ob.getTopOfBook().sequence, 5000u);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "../src/core/MatchingEngine.h"
+#include "../src/core/OutputBus.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+    Order order(const std::string& id, Order::Type type, Order::Side side, double qty, double price) {
+        Order o(id, "BTC-USDT", type, side, qty, price, "2025-06-14T10:00:00.000000Z");
+        o.setAccount(side == Order::Side::BUY ? "buyer" : "seller");
+        return o;
+    }
+
+    // What one consumer saw; only its own thread writes while the bus runs
+    struct Seen {
+        std::vector<uint64_t> sequences;
+        std::vector<OutputEvent::Type> types;
+        std::vector<Order::Status> statuses;
+        std::size_t batches = 0;
+        bool last_ended_batch = false;
+
+        OutputBus::Handler handler() {
+            return [this](const OutputEvent& event, bool end_of_batch) {
+                sequences.push_back(event.sequence);
+                types.push_back(event.type);
+                if (event.type == OutputEvent::Type::ORDER) statuses.push_back(event.order.getStatus());
+                if (end_of_batch) ++batches;
+                last_ended_batch = end_of_batch;
+            };
+        }
+    };
+}
+
+TEST(OutputBusTest, EveryConsumerSeesEngineOutputsInSequence) {
+    using T = OutputEvent::Type;
+    auto engine = std::make_shared<MatchingEngine>();
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_order_quantity = 10.0;
+    risk->setDefaultLimits(limits);
+    engine->setRiskManager(risk);
+    auto bus = std::make_shared<OutputBus>(64);
+    Seen blocking, yielding;
+    bus->addConsumer(blocking.handler(), OutputBus::WaitStrategy::BLOCKING);
+    bus->addConsumer(yielding.handler(), OutputBus::WaitStrategy::YIELD);
+    bus->start();
+    engine->setOutputBus(bus);
+
+    engine->processOrder(order("a1", Order::Type::LIMIT, Order::Side::SELL, 2.0, 101.0));
+    engine->processOrder(order("b1", Order::Type::LIMIT, Order::Side::BUY, 0.5, 101.0));
+    EXPECT_TRUE(engine->cancelOrder("BTC-USDT", "a1", Order::Side::SELL, 101.0));
+    RiskManager::Reject reject = RiskManager::Reject::NONE;
+    engine->processOrder(order("b2", Order::Type::LIMIT, Order::Side::BUY, 50.0, 100.0), &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::ORDER_QUANTITY);
+    bus->stop();
+
+    std::vector<T> expected = {T::ORDER, T::BOOK_UPDATE,               // a1 rests
+                               T::TRADE, T::ORDER, T::BOOK_UPDATE,     // b1 fills
+                               T::ORDER, T::BOOK_UPDATE,               // a1 cancelled
+                               T::ORDER};                              // b2 rejected
+    EXPECT_EQ(blocking.types, expected);
+    EXPECT_EQ(yielding.types, expected);
+    EXPECT_EQ(blocking.statuses, (std::vector<Order::Status>{Order::Status::NEW, Order::Status::FILLED,
+                                                             Order::Status::CANCELLED, Order::Status::REJECTED}));
+    for (std::size_t i = 0; i < blocking.sequences.size(); ++i) EXPECT_EQ(blocking.sequences[i], i + 1);
+    EXPECT_EQ(yielding.sequences, blocking.sequences);
+    EXPECT_EQ(bus->published(), expected.size());
+    EXPECT_EQ(bus->cursor(0), expected.size());
+    EXPECT_EQ(bus->cursor(1), expected.size());
+    EXPECT_GE(blocking.batches, 1u);
+    EXPECT_TRUE(blocking.last_ended_batch);
+}
+
+TEST(OutputBusTest, SlowConsumerHoldsWritersOnlyOnceTheRingIsFull) {
+    OutputBus bus(8);
+    std::atomic<bool> release{false};
+    std::vector<uint64_t> seen;
+    bus.addConsumer([&](const OutputEvent& event, bool) {
+        while (!release.load()) std::this_thread::yield();
+        seen.push_back(event.sequence);
+    });
+    bus.start();
+
+    std::atomic<int> written{0};
+    std::thread writer([&]() {
+        for (int i = 0; i < 20; ++i) {
+            {
+                OutputBus::Batch batch(bus, 1);
+                batch.next(OutputEvent::Type::BOOK_UPDATE, "BTC-USDT");
+            }
+            ++written;
+        }
+    });
+    // The consumer is stuck on the first event, so eight slots fill and the ninth waits
+    for (int i = 0; i < 500 && written.load() < 8; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(written.load(), 8);
+
+    release = true;
+    writer.join();
+    bus.stop();
+    ASSERT_EQ(seen.size(), 20u);
+    for (std::size_t i = 0; i < seen.size(); ++i) EXPECT_EQ(seen[i], i + 1);
+}
+
+TEST(OutputBusTest, ConcurrentCommandsReachTheBusInBookOrder) {
+    auto engine = std::make_shared<MatchingEngine>();
+    auto bus = std::make_shared<OutputBus>(256);
+    std::vector<uint64_t> tape;
+    bus->addConsumer([&](const OutputEvent& event, bool) {
+        if (event.type == OutputEvent::Type::TRADE) tape.push_back(event.trade.sequence);
+    }, OutputBus::WaitStrategy::YIELD);
+    bus->start();
+    engine->setOutputBus(bus);
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 4; ++w) {
+        writers.emplace_back([&engine, w]() {
+            for (int i = 0; i < 500; ++i) {
+                const std::string id = std::to_string(w) + "-" + std::to_string(i);
+                engine->processOrder(order("s" + id, Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0));
+                engine->processOrder(order("b" + id, Order::Type::LIMIT, Order::Side::BUY, 1.0, 100.0));
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    bus->stop();
+
+    // Tape sequences are assigned under the book lock, so the bus must carry them in order
+    ASSERT_EQ(tape.size(), 2000u);
+    for (std::size_t i = 0; i < tape.size(); ++i) EXPECT_EQ(tape[i], i + 1);
+}
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include "../src/api/MarketDataBus.h"
+#include "../src/core/MatchingEngine.h"
+#include "../src/core/OutputBus.h"
+#include "../src/core/ReadReplica.h"
+#include <set>
+#include <thread>
+
+namespace {
+    using State = ReadReplica::OrderStatus::State;
+
+    Order order(const std::string& id, Order::Type type, Order::Side side, double qty, double price) {
+        Order o(id, "BTC-USDT", type, side, qty, price, "2025-06-14T10:00:00.000000Z");
+        o.setAccount(side == Order::Side::BUY ? "buyer" : "seller");
+        return o;
+    }
+
+    // Feeds the replica the way main() does
+    struct Fixture {
+        std::shared_ptr<MatchingEngine> engine = std::make_shared<MatchingEngine>();
+        std::shared_ptr<OutputBus> outputs = std::make_shared<OutputBus>(1024);
+        MarketDataBus bus{engine, ""};
+        ReadReplica replica;
+
+        Fixture() {
+            bus.enableL3();
+            bus.addEventSink([this](const std::string& symbol, const BookEvent& event) {
+                replica.onBookEvent(symbol, event);
+            });
+            outputs->addConsumer([this](const OutputEvent& event, bool) {
+                replica.onOutput(event);
+                if (event.type == OutputEvent::Type::TRADE) {
+                    bus.onTrade(event.trade);
+                } else if (event.type == OutputEvent::Type::BOOK_UPDATE) {
+                    bus.onBookUpdate(event.symbol);
+                }
+            });
+            outputs->start();
+            engine->setOutputBus(outputs);
+            replica.start();
+        }
+        ~Fixture() { outputs->stop(); }
+
+        uint64_t submit(Order o) {
+            engine->processOrder(o);
+            return o.getEngineId();
+        }
+        void sync() {
+            while (outputs->cursor(0) < outputs->published()) std::this_thread::yield();
+            replica.sync();
+        }
+    };
+}
+
+TEST(ReadReplicaTest, TracksOrderStatusFromRestingToDone) {
+    Fixture f;
+    uint64_t a1 = f.submit(order("a1", Order::Type::LIMIT, Order::Side::SELL, 2.0, 101.0));
+    f.submit(order("a2", Order::Type::LIMIT, Order::Side::SELL, 1.0, 102.0));
+    uint64_t b1 = f.submit(order("b1", Order::Type::LIMIT, Order::Side::BUY, 0.5, 99.0));
+    f.sync();
+
+    ReadReplica::OrderStatus status;
+    ASSERT_TRUE(f.replica.getOrder(a1, status));
+    EXPECT_EQ(status.order_id, "a1");
+    EXPECT_EQ(status.state, State::OPEN);
+    EXPECT_EQ(status.side, Order::Side::SELL);
+    EXPECT_DOUBLE_EQ(status.visible, 2.0);
+    EXPECT_DOUBLE_EQ(status.leaves, 2.0);
+    EXPECT_DOUBLE_EQ(status.filled, 0.0);
+
+    // Fills a1 partly, then completely
+    f.submit(order("t1", Order::Type::MARKET, Order::Side::BUY, 0.5, 0.0));
+    f.sync();
+    ASSERT_TRUE(f.replica.getOrder(a1, status));
+    EXPECT_EQ(status.state, State::OPEN);
+    EXPECT_DOUBLE_EQ(status.visible, 1.5);
+    EXPECT_DOUBLE_EQ(status.leaves, 1.5);
+    EXPECT_DOUBLE_EQ(status.filled, 0.5);
+
+    f.submit(order("t2", Order::Type::MARKET, Order::Side::BUY, 1.5, 0.0));
+    EXPECT_TRUE(f.engine->cancelOrder("BTC-USDT", "b1", Order::Side::BUY, 99.0));
+    f.sync();
+    ASSERT_TRUE(f.replica.getOrder(a1, status));
+    EXPECT_EQ(status.state, State::FILLED);
+    EXPECT_DOUBLE_EQ(status.filled, 2.0);
+    EXPECT_DOUBLE_EQ(status.visible, 0.0);
+    ASSERT_EQ(status.fills.size(), 2u);
+    EXPECT_EQ(status.fills[1].liquidity, ReadReplica::OrderStatus::Liquidity::MAKER);
+    EXPECT_DOUBLE_EQ(status.fills[1].quantity, 1.5);
+    ASSERT_TRUE(f.replica.getOrder(b1, status));
+    EXPECT_EQ(status.state, State::CANCELLED);
+    EXPECT_DOUBLE_EQ(status.filled, 0.0);
+    EXPECT_NE(status.toJSON().find("\"status\":\"cancelled\""), std::string::npos);
+}
+
+TEST(ReadReplicaTest, EveryAcceptedOrderIsQueryableWithItsFills) {
+    Fixture f;
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_order_quantity = 10.0;
+    risk->setDefaultLimits(limits);
+    f.engine->setRiskManager(risk);
+    f.submit(order("a", Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0));
+    f.submit(order("a", Order::Type::LIMIT, Order::Side::SELL, 1.0, 101.0));
+    f.submit(order("a", Order::Type::LIMIT, Order::Side::SELL, 2.0, 102.0));
+
+    // Same client id every time: each order still has its own entry
+    uint64_t market = f.submit(order("t", Order::Type::MARKET, Order::Side::BUY, 1.0, 0.0));
+    uint64_t ioc = f.submit(order("t", Order::Type::IOC, Order::Side::BUY, 3.0, 101.0));
+    uint64_t fok = f.submit(order("t", Order::Type::FOK, Order::Side::BUY, 5.0, 102.0));
+    uint64_t rested = f.submit(order("t", Order::Type::LIMIT, Order::Side::BUY, 3.0, 102.0));
+    uint64_t rejected = f.submit(order("t", Order::Type::LIMIT, Order::Side::BUY, 50.0, 90.0));
+    f.sync();
+    EXPECT_EQ(std::set<uint64_t>({market, ioc, fok, rested, rejected}).size(), 5u);
+
+    ReadReplica::OrderStatus status;
+    ASSERT_TRUE(f.replica.getOrder(market, status));
+    EXPECT_EQ(status.state, State::FILLED);
+    EXPECT_DOUBLE_EQ(status.filled, 1.0);
+    ASSERT_EQ(status.fills.size(), 1u);
+    EXPECT_EQ(status.fills[0].liquidity, ReadReplica::OrderStatus::Liquidity::TAKER);
+    EXPECT_DOUBLE_EQ(status.fills[0].price, 100.0);
+
+    ASSERT_TRUE(f.replica.getOrder(ioc, status));
+    EXPECT_EQ(status.state, State::CANCELLED);
+    EXPECT_DOUBLE_EQ(status.filled, 1.0);
+    EXPECT_DOUBLE_EQ(status.leaves, 0.0);
+
+    ASSERT_TRUE(f.replica.getOrder(fok, status));
+    EXPECT_EQ(status.state, State::CANCELLED);
+    EXPECT_TRUE(status.fills.empty());
+
+    // Takes the 2 at 102 on entry and rests the rest
+    ASSERT_TRUE(f.replica.getOrder(rested, status));
+    EXPECT_EQ(status.state, State::OPEN);
+    EXPECT_DOUBLE_EQ(status.filled, 2.0);
+    EXPECT_DOUBLE_EQ(status.leaves, 1.0);
+    EXPECT_DOUBLE_EQ(status.visible, 1.0);
+
+    ASSERT_TRUE(f.replica.getOrder(rejected, status));
+    EXPECT_EQ(status.state, State::REJECTED);
+    EXPECT_NE(status.toJSON().find("\"status\":\"rejected\""), std::string::npos);
+    EXPECT_FALSE(f.replica.getOrder(rejected + 100, status));
+}
+
+TEST(ReadReplicaTest, CrossingTakersKeepTheirIdentity) {
+    Fixture f;
+    f.submit(order("a1", Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0));
+    f.submit(order("a2", Order::Type::LIMIT, Order::Side::SELL, 2.0, 101.0));
+
+    // Each taker's first fill reaches the replica before its ORDER event
+    uint64_t market = f.submit(order("m1", Order::Type::MARKET, Order::Side::BUY, 0.5, 0.0));
+    uint64_t ioc = f.submit(order("i1", Order::Type::IOC, Order::Side::BUY, 0.5, 100.0));
+    uint64_t limit = f.submit(order("l1", Order::Type::LIMIT, Order::Side::BUY, 3.0, 101.0));
+    f.sync();
+
+    struct Expected {
+        uint64_t engine_id;
+        const char* order_id;
+        double price;
+    };
+    for (const Expected& e : {Expected{market, "m1", 0.0}, Expected{ioc, "i1", 100.0}, Expected{limit, "l1", 101.0}}) {
+        ReadReplica::OrderStatus status;
+        ASSERT_TRUE(f.replica.getOrder(e.engine_id, status));
+        EXPECT_EQ(status.order_id, e.order_id);
+        EXPECT_EQ(status.symbol, "BTC-USDT");
+        EXPECT_EQ(status.side, Order::Side::BUY);
+        EXPECT_DOUBLE_EQ(status.price, e.price);
+        EXPECT_FALSE(status.fills.empty());
+    }
+
+    // Rests its remainder: the L3 ADD must not clobber what the fills set
+    ReadReplica::OrderStatus status;
+    ASSERT_TRUE(f.replica.getOrder(limit, status));
+    EXPECT_EQ(status.state, State::OPEN);
+    EXPECT_DOUBLE_EQ(status.filled, 2.0);
+    EXPECT_DOUBLE_EQ(status.leaves, 1.0);
+    EXPECT_NE(status.toJSON().find("\"order_id\":\"l1\""), std::string::npos);
+}
+
+TEST(ReadReplicaTest, QuoteAmendedInPlaceUpdatesLeaves) {
+    Fixture f;
+    Quote quote;
+    quote.account = "mm";
+    quote.entries.push_back({"BTC-USDT", 99.0, 2.0, 101.0, 2.0, "qb", "qa"});
+    std::vector<QuoteResult> results;
+    f.engine->processQuote(quote, results);
+    ASSERT_EQ(results.size(), 1u);
+    const uint64_t ask = results[0].ask.engine_id;
+
+    // Same price, smaller size: shrinks in place
+    quote.entries[0].ask_quantity = 0.5;
+    f.engine->processQuote(quote, results);
+    EXPECT_TRUE(results[0].ask.priority_kept);
+    f.sync();
+
+    ReadReplica::OrderStatus status;
+    ASSERT_TRUE(f.replica.getOrder(ask, status));
+    EXPECT_EQ(status.state, State::OPEN);
+    EXPECT_DOUBLE_EQ(status.visible, 0.5);
+    EXPECT_DOUBLE_EQ(status.leaves, 0.5);
+}
+
+TEST(ReadReplicaTest, BooksMatchTheLiveBook) {
+    Fixture f;
+    for (int i = 0; i < 5; ++i) {
+        f.engine->processOrder(order("a" + std::to_string(i), Order::Type::LIMIT, Order::Side::SELL, 1.0 + i, 100.0 + i));
+        f.engine->processOrder(order("s" + std::to_string(i), Order::Type::LIMIT, Order::Side::SELL, 0.5, 100.0 + i));
+        f.engine->processOrder(order("b" + std::to_string(i), Order::Type::LIMIT, Order::Side::BUY, 1.0, 98.0 - i));
+    }
+    f.engine->processOrder(order("t1", Order::Type::LIMIT, Order::Side::BUY, 2.0, 101.0));
+    f.engine->cancelOrder("BTC-USDT", "s3", Order::Side::SELL, 103.0);
+    f.engine->cancelOrder("BTC-USDT", "b4", Order::Side::BUY, 94.0);
+    f.sync();
+
+    auto book = f.engine->getBook("BTC-USDT");
+    ASSERT_TRUE(book);
+    EXPECT_EQ(f.replica.getSnapshot("BTC-USDT"), book->getSnapshot());
+    // Depth carries a wall-clock timestamp; compare the levels only
+    auto levels = [](const std::string& depth) { return depth.substr(0, depth.find("\"symbol\"")); };
+    EXPECT_EQ(levels(f.replica.getMarketDepth("BTC-USDT", 3)), levels(book->getMarketDepth(3)));
+    EXPECT_EQ(f.replica.getSnapshot("ETH-USDT"), "");
+    EXPECT_GT(f.replica.appliedEvents(), 0u);
+}
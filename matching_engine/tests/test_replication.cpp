@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+#include "../src/api/Replication.h"
+#include "../src/core/Command.h"
+#include "../src/core/MatchingEngine.h"
+#include "../src/utils/Utils.h"
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+namespace {
+    Order order(const std::string& id, Order::Type type, Order::Side side, double qty, double price,
+                const std::string& symbol = "BTC-USDT") {
+        Order o(id, symbol, type, side, qty, price, "2025-06-14T10:00:00.000000Z");
+        o.setAccount(id.substr(0, 1));
+        return o;
+    }
+
+    // Every resting order, level by level, in queue order
+    std::string dump(MatchingEngine& engine, const std::string& symbol) {
+        auto book = engine.getBook(symbol);
+        if (!book) return "";
+        std::lock_guard<std::mutex> lock(book->mtx_);
+        std::ostringstream out;
+        for (const auto& level : book->bids_) {
+            out << "B" << level.first << ":";
+            for (const auto& o : level.second) out << o->getOrderId() << "#" << o->getEngineId() << "/" << o->getLeavesQuantity() << ",";
+        }
+        for (const auto& level : book->asks_) {
+            out << "A" << level.first << ":";
+            for (const auto& o : level.second) out << o->getOrderId() << "#" << o->getEngineId() << "/" << o->getLeavesQuantity() << ",";
+        }
+        out << "T" << book->getTradeTape().lastSequence() << "P" << static_cast<int>(book->getPhase());
+        return out.str();
+    }
+
+    template <typename Predicate>
+    bool waitFor(Predicate done) {
+        for (int i = 0; i < 500 && !done(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return done();
+    }
+}
+
+TEST(ReplicationTest, CommandRoundTrip) {
+    Order o = order("a1", Order::Type::STOP_LIMIT, Order::Side::SELL, 5.0, 99.5);
+    o.setStopPrice(100.0);
+    o.setDisplayQuantity(1.0);
+    o.setTimeInForce(Order::TimeInForce::GTT, 1'750'000'000'000'000);
+    o.setSelfTradePrevention(Order::SelfTradePrevention::DECREMENT);
+    o.setSessionId(7);
+    o.setEngineId(31);
+    Command command;
+    command.type = Command::Type::ORDER;
+    command.sequence = 42;
+    command.time_us = 123;
+    command.symbol = "BTC-USDT";
+    command.order = o;
+    std::string bytes;
+    encodeCommand(command, bytes);
+
+    Command decoded;
+    ASSERT_TRUE(decodeCommand(bytes.data(), bytes.size(), decoded));
+    EXPECT_EQ(decoded.sequence, 42u);
+    EXPECT_EQ(decoded.time_us, 123);
+    ASSERT_TRUE(decoded.order);
+    EXPECT_EQ(decoded.order->getOrderId(), "a1");
+    EXPECT_EQ(decoded.order->getType(), Order::Type::STOP_LIMIT);
+    EXPECT_DOUBLE_EQ(decoded.order->getStopPrice(), 100.0);
+    EXPECT_DOUBLE_EQ(decoded.order->getDisplayQuantity(), 1.0);
+    EXPECT_EQ(decoded.order->getExpireTime(), 1'750'000'000'000'000);
+    EXPECT_EQ(decoded.order->getSelfTradePrevention(), Order::SelfTradePrevention::DECREMENT);
+    EXPECT_EQ(decoded.order->getSessionId(), 7u);
+    EXPECT_EQ(decoded.order->getEngineId(), 31u);
+    EXPECT_EQ(decoded.order->getAccount(), "a");
+    EXPECT_FALSE(decodeCommand(bytes.data(), bytes.size() - 1, decoded));
+
+    Command expire;
+    expire.type = Command::Type::EXPIRE;
+    expire.symbol = "BTC-USDT";
+    expire.engine_ids = {5, 9};
+    bytes.clear();
+    encodeCommand(expire, bytes);
+    ASSERT_TRUE(decodeCommand(bytes.data(), bytes.size(), decoded));
+    EXPECT_EQ(decoded.engine_ids, (std::vector<uint64_t>{5, 9}));
+    EXPECT_FALSE(decodeCommand(bytes.data(), bytes.size() - 1, decoded));
+}
+
+TEST(ReplicationTest, LateBackupMirrorsPrimaryBooks) {
+    auto primary = std::make_shared<MatchingEngine>();
+    ReplicationPrimary journal(primary, 0, 5'000);
+    journal.start();
+
+    primary->processOrder(order("a1", Order::Type::LIMIT, Order::Side::SELL, 2.0, 101.0));
+    primary->processOrder(order("a2", Order::Type::LIMIT, Order::Side::SELL, 3.0, 102.0));
+    Order iceberg = order("a3", Order::Type::LIMIT, Order::Side::SELL, 6.0, 101.0);
+    iceberg.setDisplayQuantity(1.0);
+    primary->processOrder(iceberg);
+    primary->processOrder(order("b1", Order::Type::LIMIT, Order::Side::BUY, 4.0, 99.0));
+
+    // Joins late: replays the history, then follows the live stream
+    auto standby = std::make_shared<MatchingEngine>();
+    ReplicationBackup backup(standby, "127.0.0.1", journal.port(), 1'000'000);
+    backup.start();
+
+    primary->processOrder(order("c1", Order::Type::MARKET, Order::Side::BUY, 3.5, 0.0));
+    primary->cancelOrder("BTC-USDT", "b1", Order::Side::BUY, 99.0);
+    Order stop = order("d1", Order::Type::STOP, Order::Side::BUY, 1.0, 0.0);
+    stop.setStopPrice(102.0);
+    primary->processOrder(stop);
+    Quote quote;
+    quote.account = "m";
+    quote.entries.push_back({"ETH-USDT", 2999.0, 5.0, 3001.0, 5.0, "q1", "q2"});
+    std::vector<QuoteResult> results;
+    primary->processQuote(quote, results);
+    primary->processOrder(order("e1", Order::Type::LIMIT, Order::Side::SELL, 2.0, 2998.0, "ETH-USDT"));
+    primary->startAuction("BTC-USDT");
+    primary->processOrder(order("f1", Order::Type::LIMIT, Order::Side::BUY, 2.0, 103.0));
+    primary->uncross("BTC-USDT");
+    primary->cancelAllForAccount("m");
+
+    const uint64_t last = journal.lastSequence();
+    EXPECT_EQ(last, 13u);
+    ASSERT_TRUE(waitFor([&]() { return backup.appliedSequence() == last; }));
+    EXPECT_EQ(dump(*standby, "BTC-USDT"), dump(*primary, "BTC-USDT"));
+    EXPECT_EQ(dump(*standby, "ETH-USDT"), dump(*primary, "ETH-USDT"));
+    EXPECT_EQ(standby->getBook("BTC-USDT")->getTopOfBook().last_price,
+              primary->getBook("BTC-USDT")->getTopOfBook().last_price);
+    EXPECT_EQ(journal.backupCount(), 1u);
+    EXPECT_FALSE(backup.failedOver());
+    backup.stop();
+    journal.stop();
+}
+
+TEST(ReplicationTest, LateBackupReplaysPastExpiries) {
+    auto primary = std::make_shared<MatchingEngine>();
+    ReplicationPrimary journal(primary, 0, 5'000);
+    journal.start();
+
+    Order gtt = order("a1", Order::Type::LIMIT, Order::Side::SELL, 1.0, 101.0);
+    gtt.setTimeInForce(Order::TimeInForce::GTT, Utils::nowMicros() + 5'000);
+    primary->processOrder(gtt);
+    Order day = order("b1", Order::Type::LIMIT, Order::Side::BUY, 1.0, 99.0);
+    day.setTimeInForce(Order::TimeInForce::DAY);
+    primary->processOrder(day);
+    primary->processOrder(order("a2", Order::Type::LIMIT, Order::Side::SELL, 1.0, 102.0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(primary->expireOrders(Utils::nowMicros()), 1u);
+
+    // Its wheel starts after the GTT deadline, so only the journal can expire it
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto standby = std::make_shared<MatchingEngine>();
+    ReplicationBackup backup(standby, "127.0.0.1", journal.port(), 1'000'000);
+    backup.start();
+    ASSERT_TRUE(waitFor([&]() { return backup.appliedSequence() == journal.lastSequence(); }));
+    EXPECT_EQ(dump(*standby, "BTC-USDT"), dump(*primary, "BTC-USDT"));
+
+    // Its own expiry driver leaves the book to the primary
+    EXPECT_EQ(standby->endSession(), 0u);
+    EXPECT_EQ(primary->endSession(), 1u);
+    ASSERT_TRUE(waitFor([&]() { return backup.appliedSequence() == journal.lastSequence(); }));
+    EXPECT_EQ(dump(*standby, "BTC-USDT"), dump(*primary, "BTC-USDT"));
+    EXPECT_EQ(standby->getBook("BTC-USDT")->expiries_.size(), 0u);
+    backup.stop();
+    journal.stop();
+}
+
+TEST(ReplicationTest, BackupTakesOverWhenPrimaryGoesAway) {
+    auto primary = std::make_shared<MatchingEngine>();
+    auto journal = std::make_unique<ReplicationPrimary>(primary, 0, 5'000);
+    journal->start();
+    auto standby = std::make_shared<MatchingEngine>();
+    ReplicationBackup backup(standby, "127.0.0.1", journal->port(), 200'000);
+    std::atomic<bool> promoted{false};
+    backup.setOnFailover([&]() { promoted = true; });
+    backup.start();
+
+    primary->processOrder(order("a1", Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0));
+    ASSERT_TRUE(waitFor([&]() { return backup.appliedSequence() == 1; }));
+    // Heartbeats keep the idle backup from failing over
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_FALSE(promoted);
+
+    journal.reset();
+    ASSERT_TRUE(waitFor([&]() { return promoted.load(); }));
+    EXPECT_TRUE(backup.failedOver());
+    // The warm book trades straight away
+    auto trades = standby->processOrder(order("b1", Order::Type::LIMIT, Order::Side::BUY, 1.0, 100.0));
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].maker_order_id, "a1");
+}
+
+TEST(ReplicationTest, LateBackupRefusedOnceHistoryOutgrowsItsCap) {
+    auto primary = std::make_shared<MatchingEngine>();
+    ReplicationPrimary journal(primary, 0, 5'000, 256);
+    journal.start();
+    auto early = std::make_shared<MatchingEngine>();
+    ReplicationBackup follower(early, "127.0.0.1", journal.port(), 1'000'000);
+    follower.start();
+    ASSERT_TRUE(waitFor([&]() { return journal.backupCount() == 1; }));
+
+    for (int i = 0; i < 10; ++i) {
+        primary->processOrder(order("a" + std::to_string(i), Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0 + i));
+    }
+    const uint64_t last = journal.lastSequence();
+    ASSERT_TRUE(waitFor([&]() { return !journal.acceptsLateBackups(); }));
+
+    // Connected backups keep following; a new one is turned away
+    auto late = std::make_shared<MatchingEngine>();
+    ReplicationBackup refused(late, "127.0.0.1", journal.port(), 1'000'000);
+    std::atomic<bool> lost{false};
+    refused.setOnFailover([&]() { lost = true; });
+    refused.start();
+    ASSERT_TRUE(waitFor([&]() { return lost.load(); }));
+    EXPECT_EQ(refused.appliedSequence(), 0u);
+    ASSERT_TRUE(waitFor([&]() { return follower.appliedSequence() == last; }));
+    EXPECT_EQ(dump(*early, "BTC-USDT"), dump(*primary, "BTC-USDT"));
+    EXPECT_EQ(journal.backupCount(), 1u);
+    refused.stop();
+    follower.stop();
+    journal.stop();
+}
+
+TEST(ReplicationTest, StalledBackupIsDroppedWithoutHoldingUpOthers) {
+    auto primary = std::make_shared<MatchingEngine>();
+    ReplicationPrimary journal(primary, 0, 5'000, std::size_t(256) << 20, 200'000);
+    journal.start();
+    // Connects and never reads
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::socket stalled(io);
+    stalled.open(boost::asio::ip::tcp::v4());
+    stalled.set_option(boost::asio::socket_base::receive_buffer_size(4096));
+    stalled.connect({boost::asio::ip::address_v4::loopback(), static_cast<unsigned short>(journal.port())});
+    auto standby = std::make_shared<MatchingEngine>();
+    ReplicationBackup backup(standby, "127.0.0.1", journal.port(), 1'000'000);
+    backup.start();
+    ASSERT_TRUE(waitFor([&]() { return journal.backupCount() == 2; }));
+
+    // Far more than the stalled socket's buffers hold
+    for (int i = 0; i < 20'000; ++i) {
+        primary->processOrder(order("a" + std::to_string(i), Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0));
+        primary->processOrder(order("b" + std::to_string(i), Order::Type::LIMIT, Order::Side::BUY, 1.0, 100.0));
+    }
+    const uint64_t last = journal.lastSequence();
+    ASSERT_TRUE(waitFor([&]() { return journal.backupCount() == 1; }));
+    ASSERT_TRUE(waitFor([&]() { return backup.appliedSequence() == last; }));
+    EXPECT_EQ(dump(*standby, "BTC-USDT"), dump(*primary, "BTC-USDT"));
+    EXPECT_FALSE(backup.failedOver());
+
+    auto started = std::chrono::steady_clock::now();
+    journal.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(1));
+    backup.stop();
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <httplib.h>
+#include "../src/api/RestServer.h"
+#include "../src/core/MatchingEngine.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+    const char* kRestingAsk = R"({"symbol":"BTC-USDT","order_type":"limit","side":"sell","quantity":1,"price":100})";
+    const char* kCrossingBid = R"({"symbol":"BTC-USDT","order_type":"limit","side":"buy","quantity":1,"price":100})";
+
+    // An engine whose trade callback holds the REST worker that matched
+    struct SlowEngine {
+        std::shared_ptr<MatchingEngine> engine = std::make_shared<MatchingEngine>();
+        std::atomic<bool> matching{false};
+
+        explicit SlowEngine(std::chrono::milliseconds hold) {
+            engine->setOnTrade([this, hold](const Trade&) {
+                matching = true;
+                std::this_thread::sleep_for(hold);
+            });
+        }
+        void waitUntilMatching() {
+            for (int i = 0; i < 500 && !matching; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    };
+
+    int post(int port, const char* body) {
+        httplib::Client client("127.0.0.1", port);
+        auto res = client.Post("/orders", body, "application/json");
+        return res ? res->status : -1;
+    }
+}
+
+TEST(RestServerTest, ShedsOrdersBeyondTheInflightLimit) {
+    SlowEngine slow(std::chrono::milliseconds(300));
+    RestServerConfig config;
+    config.worker_threads = 2; // Default limit: one order in flight
+    RestServer server(slow.engine, 18431, config);
+    server.start();
+
+    ASSERT_EQ(post(18431, kRestingAsk), 200);
+    std::thread busy([&]() { EXPECT_EQ(post(18431, kCrossingBid), 200); });
+    slow.waitUntilMatching();
+    // The second worker is free, but the engine already has its one order
+    EXPECT_EQ(post(18431, kRestingAsk), 503);
+    busy.join();
+    server.stop();
+}
+
+TEST(RestServerTest, ShedsOrdersThatQueuedTooLongForAWorker) {
+    SlowEngine slow(std::chrono::milliseconds(300));
+    RestServerConfig config;
+    config.worker_threads = 1;
+    config.max_queue_wait_ms = 50;
+    RestServer server(slow.engine, 18432, config);
+    server.start();
+
+    ASSERT_EQ(post(18432, kRestingAsk), 200);
+    std::thread busy([&]() { EXPECT_EQ(post(18432, kCrossingBid), 200); });
+    slow.waitUntilMatching();
+    // Waits behind the only worker for longer than the bound
+    EXPECT_EQ(post(18432, kRestingAsk), 503);
+    busy.join();
+    server.stop();
+}
+
+TEST(RestServerTest, AdminSetsAccountRiskLimits) {
+    auto engine = std::make_shared<MatchingEngine>();
+    auto risk = std::make_shared<RiskManager>();
+    engine->setRiskManager(risk);
+    RestServerConfig config;
+    config.admin_token = "secret";
+    RestServer server(engine, 18433, config);
+    server.setRiskManager(risk);
+    server.start();
+
+    httplib::Client client("127.0.0.1", 18433);
+    const char* limits = R"({"max_order_quantity":2})";
+    auto res = client.Put("/admin/risk?account=acct", limits, "application/json");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 401);
+    httplib::Headers wrong = {{"Authorization", "Bearer wrong"}};
+    res = client.Put("/admin/risk?account=acct", wrong, limits, "application/json");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 401);
+
+    httplib::Headers admin = {{"Authorization", "Bearer secret"}};
+    res = client.Put("/admin/risk?account=acct", admin, limits, "application/json");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_DOUBLE_EQ(risk->getLimits("acct").max_order_quantity, 2.0);
+    res = client.Put("/admin/risk?account=acct", admin, R"({"max_position":-1})", "application/json");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 400);
+    res = client.Get("/admin/risk?account=acct", admin);
+    ASSERT_TRUE(res);
+    EXPECT_NE(res->body.find("\"max_order_quantity\":2"), std::string::npos);
+
+    // Enforced on the account's orders, not on others
+    const char* big = R"({"symbol":"BTC-USDT","order_type":"limit","side":"buy","quantity":3,"price":100,"account":"acct"})";
+    const char* other = R"({"symbol":"BTC-USDT","order_type":"limit","side":"buy","quantity":3,"price":100,"account":"other"})";
+    EXPECT_EQ(post(18433, big), 400);
+    EXPECT_EQ(post(18433, other), 200);
+    server.stop();
+}
+
+TEST(RestServerTest, AdminEndpointsOffWithoutAToken) {
+    auto engine = std::make_shared<MatchingEngine>();
+    auto risk = std::make_shared<RiskManager>();
+    engine->setRiskManager(risk);
+    RestServer server(engine, 18434);
+    server.setRiskManager(risk);
+    server.start();
+
+    httplib::Client client("127.0.0.1", 18434);
+    httplib::Headers empty = {{"Authorization", "Bearer "}};
+    auto res = client.Put("/admin/risk?account=acct", empty, R"({"max_position":1})", "application/json");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 404);
+    EXPECT_DOUBLE_EQ(risk->getLimits("acct").max_position, 0.0);
+    server.stop();
+}
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include "../src/core/MatchingEngine.h"
+#include "../src/core/RiskManager.h"
+
+namespace {
+    Order makeOrder(const std::string& id, const std::string& account, Order::Type type, Order::Side side,
+                    double qty, double price) {
+        Order o(id, "BTC-USDT", type, side, qty, price, "2025-06-14T10:00:00.000000Z");
+        o.setAccount(account);
+        return o;
+    }
+}
+
+TEST(RiskManagerTest, RejectsOrdersOverSizeAndNotional) {
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_order_quantity = 5.0;
+    limits.max_order_notional = 100000.0;
+    risk->setDefaultLimits(limits);
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+
+    RiskManager::Reject reject;
+    Order big = makeOrder("o1", "acct", Order::Type::LIMIT, Order::Side::BUY, 6.0, 100.0);
+    EXPECT_TRUE(engine.processOrder(big, &reject).empty());
+    EXPECT_EQ(reject, RiskManager::Reject::ORDER_QUANTITY);
+    EXPECT_EQ(big.getStatus(), Order::Status::REJECTED);
+
+    Order rich = makeOrder("o2", "acct", Order::Type::LIMIT, Order::Side::BUY, 3.0, 50000.0);
+    engine.processOrder(rich, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::ORDER_NOTIONAL);
+
+    Order ok = makeOrder("o3", "acct", Order::Type::LIMIT, Order::Side::BUY, 1.0, 50000.0);
+    engine.processOrder(ok, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+    EXPECT_EQ(risk->getOpenOrders("acct"), 1u);
+}
+
+TEST(RiskManagerTest, MarketOrdersUnderNotionalLimitNeedProtection) {
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_order_notional = 100000.0;
+    risk->setDefaultLimits(limits);
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+    engine.processOrder(makeOrder("a1", "maker", Order::Type::LIMIT, Order::Side::SELL, 1.0, 50000.0));
+    engine.processOrder(makeOrder("a2", "maker", Order::Type::LIMIT, Order::Side::SELL, 1.0, 90000.0));
+
+    // Valued at the touch it would pass, but the sweep would pay 140000
+    RiskManager::Reject reject;
+    Order bare = makeOrder("m1", "acct", Order::Type::MARKET, Order::Side::BUY, 2.0, 0.0);
+    EXPECT_TRUE(engine.processOrder(bare, &reject).empty());
+    EXPECT_EQ(reject, RiskManager::Reject::NO_PROTECTION_PRICE);
+
+    Order wide = makeOrder("m2", "acct", Order::Type::MARKET, Order::Side::BUY, 2.0, 60000.0);
+    engine.processOrder(wide, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::ORDER_NOTIONAL);
+
+    // Within the limit at its protection price, and never fills beyond it
+    Order bounded = makeOrder("m3", "acct", Order::Type::MARKET, Order::Side::BUY, 2.0, 50000.0);
+    auto trades = engine.processOrder(bounded, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_DOUBLE_EQ(trades[0].price, 50000.0);
+    EXPECT_EQ(bounded.getStatus(), Order::Status::PARTIALLY_FILLED);
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_price, 90000.0);
+}
+
+TEST(RiskManagerTest, OpenOrderCountReleasedByFillsAndCancels) {
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_open_orders = 2;
+    risk->setLimits("maker", limits);
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+
+    RiskManager::Reject reject;
+    Order a = makeOrder("a", "maker", Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0);
+    Order b = makeOrder("b", "maker", Order::Type::LIMIT, Order::Side::SELL, 1.0, 101.0);
+    Order c = makeOrder("c", "maker", Order::Type::LIMIT, Order::Side::SELL, 1.0, 102.0);
+    engine.processOrder(a);
+    engine.processOrder(b);
+    engine.processOrder(c, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::OPEN_ORDERS);
+
+    // A taker fill on "a" frees a slot
+    Order take = makeOrder("t", "taker", Order::Type::MARKET, Order::Side::BUY, 1.0, 0.0);
+    engine.processOrder(take);
+    EXPECT_EQ(risk->getOpenOrders("maker"), 1u);
+    EXPECT_DOUBLE_EQ(risk->getPosition("maker", "BTC-USDT"), -1.0);
+    EXPECT_DOUBLE_EQ(risk->getPosition("taker", "BTC-USDT"), 1.0);
+
+    ASSERT_TRUE(engine.cancelOrder("BTC-USDT", "b", Order::Side::SELL, 101.0));
+    EXPECT_EQ(risk->getOpenOrders("maker"), 0u);
+}
+
+TEST(RiskManagerTest, PositionLimitCountsOpenOrders) {
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_position = 3.0;
+    risk->setDefaultLimits(limits);
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+
+    RiskManager::Reject reject;
+    Order bid1 = makeOrder("b1", "acct", Order::Type::LIMIT, Order::Side::BUY, 2.0, 100.0);
+    Order bid2 = makeOrder("b2", "acct", Order::Type::LIMIT, Order::Side::BUY, 2.0, 99.0);
+    engine.processOrder(bid1, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+    engine.processOrder(bid2, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::POSITION);
+    // Selling is still allowed: it reduces the worst case long
+    Order ask = makeOrder("s1", "acct", Order::Type::LIMIT, Order::Side::SELL, 3.0, 105.0);
+    engine.processOrder(ask, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+}
+
+TEST(RiskManagerTest, UnfilledTakersReleaseTheirReservation) {
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_position = 10.0;
+    risk->setDefaultLimits(limits);
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+    Order ask = makeOrder("s1", "mm", Order::Type::LIMIT, Order::Side::SELL, 1.0, 100.0);
+    engine.processOrder(ask);
+
+    // Each one is within the limit on its own; none may leave exposure behind
+    RiskManager::Reject reject;
+    for (int i = 0; i < 4; ++i) {
+        Order market = makeOrder("m" + std::to_string(i), "acct", Order::Type::MARKET, Order::Side::BUY, 3.0, 0.0);
+        engine.processOrder(market, &reject);
+        EXPECT_EQ(reject, RiskManager::Reject::NONE);
+        Order ioc = makeOrder("i" + std::to_string(i), "acct", Order::Type::IOC, Order::Side::BUY, 3.0, 90.0);
+        engine.processOrder(ioc, &reject);
+        EXPECT_EQ(reject, RiskManager::Reject::NONE);
+    }
+    // Only the one lot that traded counts
+    EXPECT_DOUBLE_EQ(risk->getPosition("acct", "BTC-USDT"), 1.0);
+    Order last = makeOrder("m9", "acct", Order::Type::MARKET, Order::Side::BUY, 9.0, 0.0);
+    engine.processOrder(last, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+    Order over = makeOrder("m10", "acct", Order::Type::MARKET, Order::Side::BUY, 10.0, 0.0);
+    engine.processOrder(over, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::POSITION);
+}
+
+TEST(RiskManagerTest, DuplicateClientIdsKeepSeparateReservations) {
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.max_position = 3.0;
+    risk->setDefaultLimits(limits);
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+    RiskManager::Reject reject;
+    Order first = makeOrder("dup", "acct", Order::Type::LIMIT, Order::Side::SELL, 2.0, 100.0);
+    Order second = makeOrder("dup", "acct", Order::Type::LIMIT, Order::Side::SELL, 1.0, 101.0);
+    engine.processOrder(first);
+    engine.processOrder(second, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+    EXPECT_EQ(risk->getOpenOrders("acct"), 2u);
+
+    // Cancelling one frees its own 2, not the other's 1
+    ASSERT_TRUE(engine.cancelOrder("BTC-USDT", "dup", Order::Side::SELL, 100.0));
+    Order more = makeOrder("s2", "acct", Order::Type::LIMIT, Order::Side::SELL, 2.0, 102.0);
+    engine.processOrder(more, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+    Order over = makeOrder("s3", "acct", Order::Type::LIMIT, Order::Side::SELL, 0.5, 102.0);
+    engine.processOrder(over, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::POSITION);
+
+    ASSERT_TRUE(engine.cancelOrder("BTC-USDT", "dup", Order::Side::SELL, 101.0));
+    EXPECT_EQ(risk->getOpenOrders("acct"), 1u);
+}
+
+TEST(RiskManagerTest, DecrementIsReleasedOnceWhenStopsTrigger) {
+    auto risk = std::make_shared<RiskManager>();
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+    engine.processOrder(makeOrder("s0", "B", Order::Type::LIMIT, Order::Side::SELL, 1.0, 99.0));
+    engine.processOrder(makeOrder("s1", "A", Order::Type::LIMIT, Order::Side::SELL, 4.0, 100.0));
+    Order stop = makeOrder("d1", "C", Order::Type::STOP, Order::Side::BUY, 1.0, 0.0);
+    stop.setStopPrice(99.0);
+    engine.processOrder(stop);
+
+    // Trades at 99, decrements s1 by 1, then the stop fires and takes 1 more of s1
+    Order taker = makeOrder("b1", "A", Order::Type::LIMIT, Order::Side::BUY, 2.0, 100.0);
+    taker.setSelfTradePrevention(Order::SelfTradePrevention::DECREMENT);
+    EXPECT_EQ(engine.processOrder(taker).size(), 2u);
+    EXPECT_DOUBLE_EQ(engine.getBook("BTC-USDT")->getTopOfBook().ask_size, 2.0);
+    EXPECT_DOUBLE_EQ(risk->getPosition("A", "BTC-USDT"), 0.0);
+
+    // A is flat with 2 still offered: another 1.5 short breaches a limit of 3
+    RiskLimits limits;
+    limits.max_position = 3.0;
+    risk->setLimits("A", limits);
+    RiskManager::Reject reject;
+    Order over = makeOrder("s2", "A", Order::Type::LIMIT, Order::Side::SELL, 1.5, 101.0);
+    engine.processOrder(over, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::POSITION);
+    Order within = makeOrder("s3", "A", Order::Type::LIMIT, Order::Side::SELL, 1.0, 101.0);
+    engine.processOrder(within, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+}
+
+TEST(RiskManagerTest, PriceBandAroundLastTrade) {
+    auto risk = std::make_shared<RiskManager>();
+    RiskLimits limits;
+    limits.price_band = 0.05;
+    risk->setDefaultLimits(limits);
+    MatchingEngine engine;
+    engine.setRiskManager(risk);
+
+    Order maker = makeOrder("m", "a", Order::Type::LIMIT, Order::Side::SELL, 2.0, 100.0);
+    Order taker = makeOrder("t", "b", Order::Type::LIMIT, Order::Side::BUY, 1.0, 100.0);
+    engine.processOrder(maker);
+    engine.processOrder(taker);
+
+    RiskManager::Reject reject;
+    Order far = makeOrder("f", "b", Order::Type::LIMIT, Order::Side::BUY, 1.0, 90.0);
+    engine.processOrder(far, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::PRICE_BAND);
+    Order near = makeOrder("n", "b", Order::Type::LIMIT, Order::Side::BUY, 1.0, 96.0);
+    engine.processOrder(near, &reject);
+    EXPECT_EQ(reject, RiskManager::Reject::NONE);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "../src/core/StopBook.h"
+
+namespace {
+    std::shared_ptr<Order> stop(const std::string& id, Order::Side side, double stop_price) {
+        static uint64_t next_engine_id = 0;
+        auto order = std::make_shared<Order>(id, "BTC-USDT", Order::Type::STOP, side, 1.0, 0.0,
+                                             "2025-06-14T10:00:00.000000Z");
+        order->setStopPrice(stop_price);
+        order->setEngineId(++next_engine_id);
+        return order;
+    }
+
+    std::vector<std::string> ids(const std::vector<std::shared_ptr<Order>>& orders) {
+        std::vector<std::string> out;
+        for (const auto& o : orders) out.push_back(o->getOrderId());
+        return out;
+    }
+}
+
+TEST(StopBookTest, TriggersOnlyCrossedPrices) {
+    StopBook stops;
+    stops.add(stop("b1", Order::Side::BUY, 50100.0));
+    stops.add(stop("b2", Order::Side::BUY, 50300.0));
+    stops.add(stop("s1", Order::Side::SELL, 49900.0));
+    stops.add(stop("s2", Order::Side::SELL, 49700.0));
+
+    std::vector<std::shared_ptr<Order>> fired;
+    stops.collectTriggered(50000.0, 50000.0, fired);
+    EXPECT_TRUE(fired.empty());
+
+    stops.collectTriggered(49800.0, 50200.0, fired);
+    EXPECT_EQ(ids(fired), (std::vector<std::string>{"b1", "s1"}));
+    EXPECT_EQ(stops.size(), 2u);
+}
+
+TEST(StopBookTest, FiresInParkingOrderAcrossPrices) {
+    StopBook stops;
+    stops.add(stop("b1", Order::Side::BUY, 50200.0));
+    stops.add(stop("s1", Order::Side::SELL, 50500.0));
+    stops.add(stop("b2", Order::Side::BUY, 50100.0));
+    stops.add(stop("b3", Order::Side::BUY, 50200.0));
+
+    std::vector<std::shared_ptr<Order>> fired;
+    stops.collectTriggered(50200.0, 50200.0, fired);
+    EXPECT_EQ(ids(fired), (std::vector<std::string>{"b1", "s1", "b2", "b3"}));
+    EXPECT_EQ(stops.size(), 0u);
+}
+
+TEST(StopBookTest, RemoveByEngineId) {
+    StopBook stops;
+    auto b1 = stop("b1", Order::Side::BUY, 50100.0);
+    auto b2 = stop("b2", Order::Side::BUY, 50100.0);
+    stops.add(b1);
+    stops.add(b2);
+    ASSERT_EQ(stops.remove(b1->getEngineId()), b1);
+    EXPECT_EQ(stops.remove(b1->getEngineId()), nullptr);
+
+    std::vector<std::shared_ptr<Order>> fired;
+    stops.collectTriggered(50100.0, 50100.0, fired);
+    EXPECT_EQ(ids(fired), std::vector<std::string>{"b2"});
+    EXPECT_EQ(stops.remove(b2->getEngineId()), nullptr);
+}
+
+TEST(StopBookTest, DuplicateClientIdsStayDistinct) {
+    StopBook stops;
+    auto first = stop("dup", Order::Side::BUY, 50100.0);
+    auto second = stop("dup", Order::Side::BUY, 50200.0);
+    auto sell = stop("dup", Order::Side::SELL, 49900.0);
+    stops.add(first);
+    stops.add(second);
+    stops.add(sell);
+    EXPECT_EQ(stops.size(), 3u);
+
+    // By client id and side: the first in trigger order only
+    ASSERT_EQ(stops.remove("dup", Order::Side::BUY), first);
+    EXPECT_EQ(stops.size(), 2u);
+
+    // The other still fires
+    std::vector<std::shared_ptr<Order>> fired;
+    stops.collectTriggered(50200.0, 50200.0, fired);
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_EQ(fired[0], second);
+    EXPECT_EQ(stops.remove(sell->getEngineId()), sell);
+    EXPECT_EQ(stops.size(), 0u);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "../src/utils/TimerWheel.h"
+#include <algorithm>
+
+namespace {
+    constexpr int64_t kStart = 1'700'000'000'000'000; // Microseconds; arbitrary epoch offset
+    constexpr int64_t kMs = 1000;
+}
+
+TEST(TimerWheelTest, FiresAtDeadlineNotBefore) {
+    TimerWheel<int> wheel(kStart);
+    wheel.schedule(kStart + 5 * kMs, 1);
+    wheel.schedule(kStart + 70 * kMs, 2);     // Second level
+    wheel.schedule(kStart + 5000 * kMs, 3);   // Third level
+    std::vector<int> fired;
+    wheel.advance(kStart + 4 * kMs, fired);
+    EXPECT_TRUE(fired.empty());
+    wheel.advance(kStart + 5 * kMs, fired);
+    EXPECT_EQ(fired, std::vector<int>{1});
+    wheel.advance(kStart + 69 * kMs, fired);
+    EXPECT_EQ(fired.size(), 1u);
+    wheel.advance(kStart + 70 * kMs, fired);
+    EXPECT_EQ(fired, (std::vector<int>{1, 2}));
+    wheel.advance(kStart + 4999 * kMs, fired);
+    EXPECT_EQ(fired.size(), 2u);
+    wheel.advance(kStart + 5000 * kMs, fired);
+    EXPECT_EQ(fired, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(wheel.size(), 0u);
+
+    // Off a tick boundary: held until the tick after the deadline
+    wheel.schedule(kStart + 5007 * kMs + 400, 4);
+    wheel.advance(kStart + 5007 * kMs + 399, fired);
+    EXPECT_EQ(fired.size(), 3u);
+    wheel.advance(kStart + 5007 * kMs + 999, fired);
+    EXPECT_EQ(fired.size(), 3u);
+    wheel.advance(kStart + 5008 * kMs, fired);
+    EXPECT_EQ(fired, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(TimerWheelTest, CancelIsImmediateAndHandlesAreReused) {
+    TimerWheel<int> wheel(kStart);
+    auto a = wheel.schedule(kStart + 10 * kMs, 1);
+    wheel.schedule(kStart + 10 * kMs, 2);
+    EXPECT_TRUE(wheel.cancel(a));
+    EXPECT_FALSE(wheel.cancel(a));
+    auto c = wheel.schedule(kStart + 20 * kMs, 3);
+    EXPECT_EQ(c, a);
+    std::vector<int> fired;
+    wheel.advance(kStart + 20 * kMs, fired);
+    EXPECT_EQ(fired, (std::vector<int>{2, 3}));
+}
+
+TEST(TimerWheelTest, PastDeadlineFiresOnNextAdvance) {
+    TimerWheel<int> wheel(kStart);
+    wheel.schedule(kStart - 1000 * kMs, 1);
+    std::vector<int> fired;
+    wheel.advance(kStart + kMs, fired);
+    EXPECT_EQ(fired, std::vector<int>{1});
+}
+
+TEST(TimerWheelTest, OverflowBeyondWheelRange) {
+    TimerWheel<int> wheel(kStart);
+    const int64_t far = kStart + (int64_t{1} << 24) * kMs + 123 * kMs; // Past four levels
+    wheel.schedule(far, 1);
+    std::vector<int> fired;
+    wheel.advance(far - kMs, fired);
+    EXPECT_TRUE(fired.empty());
+    wheel.advance(far, fired);
+    EXPECT_EQ(fired, std::vector<int>{1});
+}
+
+TEST(TimerWheelTest, SessionEntriesOnlyReleasedBySessionEnd) {
+    TimerWheel<int> wheel(kStart);
+    wheel.schedule(TimerWheel<int>::kSessionEnd, 1);
+    wheel.schedule(kStart + kMs, 2);
+    std::vector<int> fired;
+    wheel.advance(kStart + 1000000 * kMs, fired);
+    EXPECT_EQ(fired, std::vector<int>{2});
+    wheel.expireSession(fired);
+    EXPECT_EQ(fired, (std::vector<int>{2, 1}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
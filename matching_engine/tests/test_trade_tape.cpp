@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "../src/core/TradeTape.h"
+#include "../src/core/MatchingEngine.h"
+#include "../src/utils/Utils.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+    Trade makeTrade(int i) {
+        Trade t;
+        t.trade_id = "t" + std::to_string(i);
+        t.timestamp = "2025-06-14T10:00:00.000123Z";
+        t.symbol = "BTC-USDT";
+        t.price = 50000.0 + i;
+        t.quantity = 1.0;
+        t.aggressor_side = i % 2 ? "sell" : "buy";
+        return t;
+    }
+}
+
+TEST(TradeTapeTest, AssignsSequencesAndReturnsNewerEntries) {
+    TradeTape tape;
+    for (int i = 1; i <= 5; ++i) {
+        Trade t = makeTrade(i);
+        tape.append(t);
+        EXPECT_EQ(t.sequence, static_cast<uint64_t>(i));
+    }
+    auto entries = tape.since(3);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].sequence, 4u);
+    EXPECT_STREQ(entries[0].trade_id, "t4");
+    EXPECT_DOUBLE_EQ(entries[1].price, 50005.0);
+    EXPECT_EQ(entries[1].aggressor_buy, 0);
+    EXPECT_TRUE(tape.since(5).empty());
+    // Truncation keeps the newest
+    entries = tape.since(0, 2);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].sequence, 4u);
+}
+
+TEST(TradeTapeTest, WrapsAndDropsOldest) {
+    TradeTape tape;
+    const int total = static_cast<int>(TradeTape::kCapacity) + 10;
+    for (int i = 1; i <= total; ++i) {
+        Trade t = makeTrade(i);
+        tape.append(t);
+    }
+    auto entries = tape.since(0);
+    ASSERT_EQ(entries.size(), TradeTape::kCapacity);
+    EXPECT_EQ(entries.front().sequence, 11u);
+    EXPECT_EQ(entries.back().sequence, static_cast<uint64_t>(total));
+}
+
+TEST(TradeTapeTest, ConcurrentReadersSeeContiguousEntries) {
+    TradeTape tape;
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    std::thread reader([&]() {
+        while (!done) {
+            auto entries = tape.since(0, 64);
+            for (std::size_t i = 1; i < entries.size(); ++i) {
+                if (entries[i].sequence <= entries[i - 1].sequence) ++bad;
+            }
+            for (const auto& e : entries) {
+                if (e.price != 50000.0 + static_cast<double>(e.sequence)) ++bad;
+            }
+        }
+    });
+    for (int i = 1; i <= 20000; ++i) {
+        Trade t = makeTrade(i);
+        tape.append(t);
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(bad.load(), 0);
+}
+
+TEST(TradeTapeTest, TimestampsRoundTrip) {
+    int64_t us = 0;
+    ASSERT_TRUE(Utils::parseTimestamp("2025-06-14T10:00:00.000123Z", us));
+    EXPECT_EQ(us, 1749895200000123LL);
+    EXPECT_EQ(Utils::formatTimestamp(us), "2025-06-14T10:00:00.000123Z");
+    EXPECT_FALSE(Utils::parseTimestamp("not a timestamp", us));
+}
+
+TEST(TradeTapeTest, EngineRecordsTradesOnTheSymbolTape) {
+    MatchingEngine engine;
+    Order sell("s1", "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 2.0, 50000.0, "2025-06-14T10:00:00.000000Z");
+    engine.processOrder(sell);
+    Order buy1("b1", "BTC-USDT", Order::Type::MARKET, Order::Side::BUY, 1.0, 0.0, "2025-06-14T10:00:01.000000Z");
+    Order buy2("b2", "BTC-USDT", Order::Type::MARKET, Order::Side::BUY, 1.0, 0.0, "2025-06-14T10:00:02.000000Z");
+    const int64_t before = Utils::nowMicros();
+    auto first = engine.processOrder(buy1);
+    auto second = engine.processOrder(buy2);
+    ASSERT_EQ(first.size(), 1u);
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(first[0].sequence, 1u);
+    EXPECT_EQ(second[0].sequence, 2u);
+    auto tape = engine.getBook("BTC-USDT")->getTradeTape().since(1);
+    ASSERT_EQ(tape.size(), 1u);
+    // Stamped by the matching clock, not the orders' own timestamps
+    EXPECT_GE(tape[0].timestamp_us, before);
+    EXPECT_EQ(Utils::formatTimestamp(tape[0].timestamp_us), second[0].timestamp);
+}
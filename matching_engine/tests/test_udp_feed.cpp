@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "../src/api/MarketDataBus.h"
+#include "../src/api/UdpFeed.h"
+#include "../src/core/MatchingEngine.h"
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    // A port nothing is bound to right now
+    int freeUdpPort() {
+        boost::asio::io_context io;
+        boost::asio::ip::udp::socket socket(io, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+        return socket.local_endpoint().port();
+    }
+
+    MarketDataMessage level(double price, double quantity) {
+        MarketDataMessage m;
+        std::memset(static_cast<void*>(&m), 0, sizeof(m));
+        m.type = MarketDataMessage::Type::LEVEL;
+        std::strcpy(m.symbol, "BTC-USDT");
+        m.level.price = price;
+        m.level.quantity = quantity;
+        return m;
+    }
+
+    struct Collected {
+        std::mutex mtx;
+        std::vector<uint64_t> sequences;
+        std::vector<double> prices;
+
+        void add(uint64_t sequence, const MarketDataMessage& message) {
+            std::lock_guard<std::mutex> lock(mtx);
+            sequences.push_back(sequence);
+            prices.push_back(message.type == MarketDataMessage::Type::LEVEL ? message.level.price : 0.0);
+        }
+        std::size_t size() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return sequences.size();
+        }
+    };
+
+    template <typename Predicate>
+    bool waitFor(Predicate done) {
+        for (int i = 0; i < 500 && !done(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return done();
+    }
+}
+
+TEST(UdpFeedTest, SubscriberArbitratesBothLinesFromTheBus) {
+    std::vector<FeedLine> lines = {{"127.0.0.1", freeUdpPort()}, {"127.0.0.1", freeUdpPort()}};
+    UdpFeedPublisher publisher(lines, 0);
+    publisher.start();
+    UdpFeedSubscriber subscriber(lines, "127.0.0.1", publisher.retransmitPort());
+    Collected got;
+    subscriber.setOnMessage([&](uint64_t sequence, const MarketDataMessage& m) { got.add(sequence, m); });
+    subscriber.start();
+
+    auto engine = std::make_shared<MatchingEngine>();
+    MarketDataBus bus(engine, "");
+    bus.addSink([&](uint64_t sequence, const MarketDataMessage& m) { publisher.publish(sequence, m); });
+    engine->setOnTrade([&](const Trade& trade) { bus.onTrade(trade); });
+    engine->setOnBookUpdate([&](const std::string& symbol) { bus.onBookUpdate(symbol); });
+    for (int i = 0; i < 5; ++i) {
+        engine->processOrder(Order("a" + std::to_string(i), "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, 1.0,
+                                   100.0 + i, "2025-06-14T10:00:00.000000Z"));
+    }
+    engine->processOrder(Order("b1", "BTC-USDT", Order::Type::MARKET, Order::Side::BUY, 2.0, 0.0,
+                               "2025-06-14T10:00:00.000000Z"));
+
+    const uint64_t last = bus.published();
+    ASSERT_GT(last, 5u);
+    EXPECT_EQ(publisher.lastSequence(), last);
+    ASSERT_TRUE(waitFor([&]() { return got.size() == last && subscriber.duplicates() == last; }));
+    for (uint64_t i = 0; i < last; ++i) EXPECT_EQ(got.sequences[i], i + 1);
+    EXPECT_EQ(subscriber.lost(), 0u);
+    subscriber.stop();
+    publisher.stop();
+}
+
+TEST(UdpFeedTest, GapsAreFilledFromHistoryOrCountedAsLost) {
+    // The publisher's lines lead nowhere; the test plays the network instead
+    UdpFeedPublisher publisher({{"127.0.0.1", freeUdpPort()}}, 0, 8);
+    publisher.start();
+    for (uint64_t s = 1; s <= 12; ++s) publisher.publish(s, level(100.0 + s, 1.0));
+
+    std::vector<FeedLine> lines = {{"127.0.0.1", freeUdpPort()}};
+    UdpFeedSubscriber subscriber(lines, "127.0.0.1", publisher.retransmitPort(), 1'000);
+    Collected got;
+    subscriber.setOnMessage([&](uint64_t sequence, const MarketDataMessage& m) { got.add(sequence, m); });
+    subscriber.start();
+
+    boost::asio::io_context io;
+    boost::asio::ip::udp::socket network(io, boost::asio::ip::udp::v4());
+    boost::asio::ip::udp::endpoint to(boost::asio::ip::make_address("127.0.0.1"), static_cast<unsigned short>(lines[0].port));
+    auto send = [&](uint64_t sequence) {
+        FeedPacket packet{sequence, level(100.0 + sequence, 1.0)};
+        network.send_to(boost::asio::buffer(&packet, sizeof(packet)), to);
+    };
+
+    // Joins at 1; 2 to 4 have already left the 8-deep history, 5 and 6 are resent
+    send(1);
+    ASSERT_TRUE(waitFor([&]() { return got.size() == 1; }));
+    send(7);
+    send(7);
+    ASSERT_TRUE(waitFor([&]() { return got.size() == 4; }));
+    EXPECT_EQ(got.sequences, (std::vector<uint64_t>{1, 5, 6, 7}));
+    EXPECT_DOUBLE_EQ(got.prices[1], 105.0);
+    EXPECT_EQ(subscriber.lost(), 3u);
+    EXPECT_EQ(subscriber.recovered(), 2u);
+    EXPECT_EQ(subscriber.duplicates(), 1u);
+
+    // A heartbeat announces a tail the subscriber never saw
+    FeedPacket heartbeat;
+    std::memset(static_cast<void*>(&heartbeat), 0, sizeof(heartbeat));
+    heartbeat.sequence = 12;
+    heartbeat.message.type = MarketDataMessage::Type::HEARTBEAT;
+    network.send_to(boost::asio::buffer(&heartbeat, sizeof(heartbeat)), to);
+    ASSERT_TRUE(waitFor([&]() { return got.size() == 9; }));
+    EXPECT_EQ(got.sequences.back(), 12u);
+    EXPECT_EQ(subscriber.recovered(), 7u);
+    subscriber.stop();
+    publisher.stop();
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+#include <nlohmann/json.hpp>
+#include "../src/api/WebSocketServer.h"
+#include "../src/core/MatchingEngine.h"
+#include "../src/core/ReadReplica.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+    using Client = websocketpp::client<websocketpp::config::asio_client>;
+
+    // One order entry connection that collects every message it receives
+    class TestSession {
+    public:
+        explicit TestSession(int port) {
+            client_.clear_access_channels(websocketpp::log::alevel::all);
+            client_.clear_error_channels(websocketpp::log::elevel::all);
+            client_.init_asio();
+            client_.set_open_handler([this](websocketpp::connection_hdl hdl) {
+                std::lock_guard<std::mutex> lock(mtx_);
+                hdl_ = hdl;
+                open_ = true;
+                cv_.notify_all();
+            });
+            client_.set_message_handler([this](websocketpp::connection_hdl, Client::message_ptr msg) {
+                std::lock_guard<std::mutex> lock(mtx_);
+                messages_.push_back(json::parse(msg->get_payload()));
+                cv_.notify_all();
+            });
+            websocketpp::lib::error_code ec;
+            auto con = client_.get_connection("ws://127.0.0.1:" + std::to_string(port), ec);
+            client_.connect(con);
+            thread_ = std::thread([this]() { client_.run(); });
+        }
+        ~TestSession() {
+            websocketpp::lib::error_code ec;
+            client_.close(hdl_, websocketpp::close::status::normal, "", ec);
+            thread_.join();
+        }
+
+        bool waitOpen() {
+            std::unique_lock<std::mutex> lock(mtx_);
+            return cv_.wait_for(lock, std::chrono::seconds(2), [this]() { return open_; });
+        }
+        void send(const json& msg) {
+            websocketpp::lib::error_code ec;
+            client_.send(hdl_, msg.dump(), websocketpp::frame::opcode::text, ec);
+        }
+        // The first `count` messages, or fewer after a timeout
+        std::vector<json> receive(std::size_t count) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait_for(lock, std::chrono::seconds(2), [&]() { return messages_.size() >= count; });
+            return messages_;
+        }
+
+    private:
+        Client client_;
+        std::thread thread_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        websocketpp::connection_hdl hdl_;
+        bool open_ = false;
+        std::vector<json> messages_;
+    };
+
+    json limitBuy(const std::string& client_order_id, double quantity, double price) {
+        return {{"type", "order"}, {"symbol", "BTC-USDT"}, {"order_type", "limit"}, {"side", "buy"},
+                {"quantity", quantity}, {"price", price}, {"client_order_id", client_order_id}};
+    }
+
+    void restAsk(MatchingEngine& engine, const std::string& id, double quantity, double price) {
+        engine.processOrder(Order(id, "BTC-USDT", Order::Type::LIMIT, Order::Side::SELL, quantity, price,
+                                  "2025-06-14T10:00:00.000000Z"));
+    }
+}
+
+TEST(WebSocketServerTest, MarketableOrderGetsItsFillsAndTrueLeaves) {
+    auto engine = std::make_shared<MatchingEngine>();
+    WebSocketServer server(engine, 18441, 1);
+    // Wired as in main: sessions hear of fills before processOrder returns
+    engine->setOnTrade([&server](const Trade& trade) { server.routeFills(trade); });
+    engine->setOnOrderReduced([&server](const Order& order) { server.onOrderReduced(order); });
+    server.start();
+    restAsk(*engine, "a1", 1.0, 100.0);
+
+    {
+        TestSession session(18441);
+        ASSERT_TRUE(session.waitOpen());
+        // Partially fills against a1, then rests the remainder
+        session.send(limitBuy("c1", 3.0, 100.0));
+        auto messages = session.receive(2);
+        ASSERT_EQ(messages.size(), 2u);
+        EXPECT_EQ(messages[0]["type"], "ack");
+        EXPECT_EQ(messages[0]["status"], "partially_filled");
+        EXPECT_DOUBLE_EQ(messages[0]["leaves_quantity"].get<double>(), 2.0);
+        EXPECT_EQ(messages[1]["type"], "fill");
+        EXPECT_EQ(messages[1]["client_order_id"], "c1");
+        EXPECT_EQ(messages[1]["liquidity"], "taker");
+        EXPECT_DOUBLE_EQ(messages[1]["quantity"].get<double>(), 1.0);
+    }
+
+    {
+        TestSession session(18441);
+        ASSERT_TRUE(session.waitOpen());
+        // Pull the first session's resting bid, then offer below it
+        engine->cancelAllForSession(1);
+        restAsk(*engine, "a2", 1.0, 99.0);
+        // Fills completely on entry
+        session.send(limitBuy("c2", 1.0, 99.0));
+        auto messages = session.receive(2);
+        ASSERT_EQ(messages.size(), 2u);
+        EXPECT_EQ(messages[0]["type"], "ack");
+        EXPECT_EQ(messages[0]["status"], "filled");
+        EXPECT_DOUBLE_EQ(messages[0]["leaves_quantity"].get<double>(), 0.0);
+        EXPECT_EQ(messages[1]["type"], "fill");
+        EXPECT_EQ(messages[1]["client_order_id"], "c2");
+        EXPECT_DOUBLE_EQ(messages[1]["quantity"].get<double>(), 1.0);
+    }
+    server.stop();
+}
+
+TEST(WebSocketServerTest, DepthImageComesFromTheReadReplica) {
+    auto engine = std::make_shared<MatchingEngine>();
+    restAsk(*engine, "a1", 1.0, 100.0);
+    // The replica alone knows of a 2.0 ask at 101
+    auto replica = std::make_shared<ReadReplica>();
+    replica->start();
+    replica->onBookEvent("BTC-USDT", BookEvent{BookEvent::Type::ADD, Order::Side::SELL, 1, 1, 101.0, 2.0, "r1", 7});
+    replica->sync();
+    WebSocketServer server(engine, 18442, 1);
+    server.setReadReplica(replica);
+    server.start();
+
+    {
+        TestSession session(18442);
+        ASSERT_TRUE(session.waitOpen());
+        session.send({{"type", "subscribe"}, {"symbol", "BTC-USDT"}, {"channels", json::array({"depth"})}});
+        auto messages = session.receive(2);
+        ASSERT_EQ(messages.size(), 2u);
+        EXPECT_EQ(messages[0]["type"], "subscribed");
+        EXPECT_EQ(messages[1]["type"], "l2update");
+        ASSERT_EQ(messages[1]["asks"].size(), 1u);
+        EXPECT_DOUBLE_EQ(messages[1]["asks"][0][0][0].get<double>(), 101.0);
+    }
+    server.stop();
+    replica->stop();
+}
@@ -0,0 +1,90 @@
+#include "ClientEvents.h"
+#include <nlohmann/json.hpp>
+
+namespace {
+    double toDouble(const nlohmann::json& v) {
+        if (v.is_number()) return v.get<double>();
+        if (v.is_string()) return std::stod(v.get<std::string>());
+        return 0.0;
+    }
+
+    // Depth entries are [price, qty]; the engine's depth snapshots wrap each
+    // entry in an extra array, so accept both shapes.
+    void readLevels(const nlohmann::json& levels, std::vector<std::pair<double, double>>& out) {
+        if (!levels.is_array()) return;
+        out.reserve(levels.size());
+        for (const auto& entry : levels) {
+            const auto& level = (entry.is_array() && !entry.empty() && entry[0].is_array()) ? entry[0] : entry;
+            if (level.is_array() && level.size() >= 2) {
+                out.emplace_back(toDouble(level[0]), toDouble(level[1]));
+            }
+        }
+    }
+}
+
+bool dispatchEvent(const std::string& payload, ClientEventHandler& handler) {
+    nlohmann::json j = nlohmann::json::parse(payload, nullptr, false);
+    if (j.is_discarded() || !j.contains("type") || !j["type"].is_string()) {
+        return false;
+    }
+    const std::string& type = j["type"].get_ref<const std::string&>();
+
+    if (type == "ack") {
+        AckEvent ev;
+        ev.client_order_id = j.value("client_order_id", "");
+        ev.order_id = j.value("order_id", "");
+        ev.status = j.value("status", "");
+        handler.onAck(ev);
+    } else if (type == "fill") {
+        FillEvent ev;
+        ev.client_order_id = j.value("client_order_id", "");
+        ev.order_id = j.value("order_id", "");
+        ev.trade_id = j.value("trade_id", "");
+        ev.symbol = j.value("symbol", "");
+        ev.side = j.value("side", "");
+        ev.liquidity = j.value("liquidity", "");
+        ev.timestamp = j.value("timestamp", "");
+        if (j.contains("price")) ev.price = toDouble(j["price"]);
+        if (j.contains("quantity")) ev.quantity = toDouble(j["quantity"]);
+        handler.onFill(ev);
+    } else if (type == "cancel_ack") {
+        CancelAckEvent ev;
+        ev.client_order_id = j.value("client_order_id", "");
+        ev.status = j.value("status", "");
+        handler.onCancelAck(ev);
+    } else if (type == "reject" || type == "error") {
+        RejectEvent ev;
+        ev.client_order_id = j.value("client_order_id", "");
+        ev.reason = j.value("reason", j.value("message", ""));
+        handler.onReject(ev);
+    } else if (type == "trade") {
+        TradeEvent ev;
+        ev.sequence = j.value("sequence", uint64_t{0});
+        ev.trade_id = j.value("trade_id", "");
+        ev.symbol = j.value("symbol", "");
+        ev.aggressor_side = j.value("aggressor_side", "");
+        ev.timestamp = j.value("timestamp", "");
+        if (j.contains("price")) ev.price = toDouble(j["price"]);
+        if (j.contains("quantity")) ev.quantity = toDouble(j["quantity"]);
+        handler.onTrade(ev);
+    } else if (type == "l2update" || type == "snapshot") {
+        BookUpdateEvent ev;
+        ev.symbol = j.value("symbol", "");
+        ev.timestamp = j.value("timestamp", "");
+        if (j.contains("bids")) readLevels(j["bids"], ev.bids);
+        if (j.contains("asks")) readLevels(j["asks"], ev.asks);
+        handler.onBookUpdate(ev);
+    } else if (type == "bbo") {
+        BboEvent ev;
+        ev.symbol = j.value("symbol", "");
+        ev.sequence = j.value("sequence", uint64_t{0});
+        if (j.contains("bid_price")) ev.bid_price = toDouble(j["bid_price"]);
+        if (j.contains("bid_size")) ev.bid_size = toDouble(j["bid_size"]);
+        if (j.contains("ask_price")) ev.ask_price = toDouble(j["ask_price"]);
+        if (j.contains("ask_size")) ev.ask_size = toDouble(j["ask_size"]);
+        handler.onBbo(ev);
+    } else {
+        handler.onUnknown(payload);
+    }
+    return true;
+}
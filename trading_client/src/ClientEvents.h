@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Typed views of the engine's WebSocket messages. TradingClient decodes each
+// payload once and hands these to a ClientEventHandler, so strategies never
+// touch JSON.
+
+struct AckEvent {
+    std::string client_order_id;
+    std::string order_id;
+    std::string status;           // new, partially_filled, filled, cancelled
+};
+
+struct FillEvent {
+    std::string client_order_id;
+    std::string order_id;
+    std::string trade_id;
+    std::string symbol;
+    std::string side;
+    std::string liquidity;        // maker or taker
+    std::string timestamp;
+    double price = 0.0;
+    double quantity = 0.0;
+};
+
+struct CancelAckEvent {
+    std::string client_order_id;
+    std::string status;           // cancelled or not_found
+};
+
+struct RejectEvent {
+    std::string client_order_id;
+    std::string reason;
+};
+
+struct TradeEvent {
+    uint64_t sequence = 0;        // Per-symbol tape position; replays may repeat one
+    std::string trade_id;
+    std::string symbol;
+    std::string aggressor_side;
+    std::string timestamp;
+    double price = 0.0;
+    double quantity = 0.0;
+};
+
+struct BookUpdateEvent {
+    std::string symbol;
+    std::string timestamp;
+    std::vector<std::pair<double, double>> bids; // (price, quantity), best first
+    std::vector<std::pair<double, double>> asks;
+};
+
+struct BboEvent {
+    std::string symbol;
+    uint64_t sequence = 0;        // Increases whenever the top of book changes
+    double bid_price = 0.0;
+    double bid_size = 0.0;
+    double ask_price = 0.0;
+    double ask_size = 0.0;
+};
+
+class ClientEventHandler {
+public:
+    virtual ~ClientEventHandler() = default;
+
+    virtual void onAck(const AckEvent&) {}
+    virtual void onFill(const FillEvent&) {}
+    virtual void onCancelAck(const CancelAckEvent&) {}
+    virtual void onReject(const RejectEvent&) {}
+    virtual void onTrade(const TradeEvent&) {}
+    virtual void onBookUpdate(const BookUpdateEvent&) {}
+    virtual void onBbo(const BboEvent&) {}
+    virtual void onUnknown(const std::string& /*payload*/) {}
+};
+
+// Decodes one payload and invokes the matching callback. Returns false if the
+// payload is not valid JSON or carries no "type".
+bool dispatchEvent(const std::string& payload, ClientEventHandler& handler);
@@ -0,0 +1,89 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+std::size_t LatencyHistogram::indexOf(uint64_t value) {
+    const uint64_t limit = (uint64_t(1) << kMaxBits) - 1;
+    value = std::min(value, limit);
+    if (value < (uint64_t(1) << kLinearBits)) {
+        return static_cast<std::size_t>(value);
+    }
+    int msb = 63;
+    while (!(value >> msb)) --msb;
+    int shift = msb - kSubBucketBits;
+    std::size_t sub = static_cast<std::size_t>(value >> shift) - (std::size_t(1) << kSubBucketBits);
+    return (std::size_t(1) << kLinearBits) + (msb - kLinearBits) * (std::size_t(1) << kSubBucketBits) + sub;
+}
+
+uint64_t LatencyHistogram::valueAt(std::size_t index) {
+    if (index < (std::size_t(1) << kLinearBits)) {
+        return index;
+    }
+    std::size_t rel = index - (std::size_t(1) << kLinearBits);
+    int msb = static_cast<int>(rel >> kSubBucketBits) + kLinearBits;
+    uint64_t sub = (rel & ((std::size_t(1) << kSubBucketBits) - 1)) + (uint64_t(1) << kSubBucketBits);
+    int shift = msb - kSubBucketBits;
+    // Report the upper edge of the bucket so percentiles never understate
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value_ns) {
+    ++counts_[indexOf(value_ns)];
+    ++total_;
+    sum_ += value_ns;
+    min_ = std::min(min_, value_ns);
+    max_ = std::max(max_, value_ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t i = 0; i < kBuckets; ++i) counts_[i] += other.counts_[i];
+    total_ += other.total_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::reset() {
+    counts_.fill(0);
+    total_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+uint64_t LatencyHistogram::count() const { return total_; }
+uint64_t LatencyHistogram::min() const { return total_ ? min_ : 0; }
+uint64_t LatencyHistogram::max() const { return max_; }
+double LatencyHistogram::mean() const { return total_ ? static_cast<double>(sum_ / total_) : 0.0; }
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total_ == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total_) + 0.5);
+    target = std::max<uint64_t>(1, std::min(target, total_));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += counts_[i];
+        if (seen >= target) return std::min(valueAt(i), max_);
+    }
+    return max_;
+}
+
+std::string LatencyHistogram::summary(const std::string& name) const {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << std::left << std::setw(18) << name
+        << " n=" << std::setw(9) << total_
+        << " p50=" << std::setw(9) << us(percentile(50))
+        << " p90=" << std::setw(9) << us(percentile(90))
+        << " p99=" << std::setw(9) << us(percentile(99))
+        << " p99.9=" << std::setw(9) << us(percentile(99.9))
+        << " max=" << us(max()) << " us";
+    return oss.str();
+}
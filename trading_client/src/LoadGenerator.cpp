@@ -0,0 +1,274 @@
+#include "LoadGenerator.h"
+#include <cctype>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+    // Parses the engine's "YYYY-MM-DDTHH:MM:SS.ffffffZ" timestamps
+    bool parseTimestamp(const std::string& ts, std::chrono::system_clock::time_point& out) {
+        std::tm tm = {};
+        std::istringstream iss(ts);
+        iss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+        if (iss.fail()) return false;
+        long micros = 0;
+        if (iss.peek() == '.') {
+            iss.get();
+            std::string frac;
+            while (std::isdigit(iss.peek())) frac.push_back(static_cast<char>(iss.get()));
+            frac.resize(6, '0');
+            micros = std::stol(frac);
+        }
+#ifdef _WIN32
+        std::time_t secs = _mkgmtime(&tm);
+#else
+        std::time_t secs = timegm(&tm);
+#endif
+        out = std::chrono::system_clock::from_time_t(secs) + std::chrono::microseconds(micros);
+        return true;
+    }
+
+    uint64_t nanosBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+        return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    }
+}
+
+LoadGenerator::LoadGenerator(const Config& config)
+    : config_(config), rng_(config.seed),
+      interval_ns_(static_cast<uint64_t>(1e9 / config.rate)) {}
+
+LoadGenerator::~LoadGenerator() {
+    for (auto& session : sessions_) {
+        session->client->disconnect();
+    }
+}
+
+bool LoadGenerator::connectAll() {
+    for (int i = 0; i < config_.connections; ++i) {
+        auto session = std::make_unique<Session>();
+        session->owner = this;
+        session->index = i;
+        // Handlers only update histograms, so run them on the network thread,
+        // and keep per-frame access logging off that thread
+        session->client = std::make_unique<TradingClient>(config_.uri, TradingClient::DispatchMode::INLINE,
+                                                          TradingClient::LogMode::ERRORS);
+        session->client->setEventHandler(session.get());
+        if (!session->client->connect()) {
+            std::cerr << "Load generator: connection " << i << " failed" << std::endl;
+            return false;
+        }
+        session->client->subscribeToMarketData(config_.symbol);
+        sessions_.push_back(std::move(session));
+    }
+    return true;
+}
+
+bool LoadGenerator::run() {
+    if (!connectAll()) return false;
+
+    const auto interval = std::chrono::nanoseconds(interval_ns_);
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::seconds(config_.duration_seconds);
+
+    for (uint64_t i = 0;; ++i) {
+        auto intended = start + interval * i;
+        if (intended >= end) break;
+        std::this_thread::sleep_until(intended);
+
+        Session& session = *sessions_[i % sessions_.size()];
+        // Closed loop: wait for the window to open but keep the original
+        // schedule so the delay is charged to the requests that suffered it
+        if (session.outstanding.load() >= config_.max_outstanding) {
+            ++stalled_;
+            while (session.outstanding.load() >= config_.max_outstanding && Clock::now() < end) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        sendNext(session, intended);
+    }
+
+    // Drain responses still in flight
+    auto drain_deadline = Clock::now() + std::chrono::seconds(5);
+    for (auto& session : sessions_) {
+        while (session->outstanding.load() > 0 && Clock::now() < drain_deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    elapsed_seconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+
+    double throughput = elapsed_seconds_ > 0 ? totalAcks() / elapsed_seconds_ : 0.0;
+    double p99_ack_us = merged(&Session::ack).percentile(99) / 1000.0;
+    passed_ = (config_.min_throughput <= 0 || throughput >= config_.min_throughput) &&
+              (config_.max_p99_ack_us <= 0 || p99_ack_us <= config_.max_p99_ack_us);
+    return passed_;
+}
+
+void LoadGenerator::sendNext(Session& session, Clock::time_point intended) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::string cancel_id;
+    std::string order_id;
+    {
+        std::lock_guard<std::mutex> lock(session.mtx);
+        if (!session.resting.empty() && uniform(rng_) < config_.cancel_ratio) {
+            std::size_t idx = static_cast<std::size_t>(uniform(rng_) * session.resting.size()) % session.resting.size();
+            cancel_id = session.resting[idx];
+            session.resting[idx] = session.resting.back();
+            session.resting.pop_back();
+            session.cancels[cancel_id] = {intended, Clock::now()};
+        } else {
+            std::ostringstream oss;
+            oss << "L" << session.index << "-" << session.next_seq++;
+            order_id = oss.str();
+            session.orders[order_id] = {intended, Clock::now()};
+        }
+    }
+    session.outstanding.fetch_add(1);
+    ++sent_;
+
+    if (!cancel_id.empty()) {
+        session.client->cancelOrder(config_.symbol, cancel_id);
+        return;
+    }
+
+    bool buy = uniform(rng_) < 0.5;
+    bool market = uniform(rng_) < config_.market_ratio;
+    std::uniform_int_distribution<int> ticks(-config_.price_range_ticks, config_.price_range_ticks);
+    double price = market ? 0.0 : config_.mid_price + ticks(rng_) * config_.tick_size;
+    session.client->placeOrder(config_.symbol, market ? "market" : "limit", buy ? "buy" : "sell",
+                               config_.quantity, price, order_id);
+}
+
+void LoadGenerator::onAck(Session& session, const AckEvent& ev) {
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(session.mtx);
+    auto it = session.orders.find(ev.client_order_id);
+    if (it == session.orders.end() || it->second.acked) return;
+    session.ack.record(nanosBetween(it->second.intended, now));
+    session.ack_uncorrected.record(nanosBetween(it->second.sent, now));
+    ++session.acks;
+    session.outstanding.fetch_sub(1);
+
+    // Taker fills follow the ack on the same connection; keep the entry
+    // for them and make resting remainders eligible for cancellation
+    if (ev.status == "new" || ev.status == "partially_filled") {
+        session.resting.push_back(ev.client_order_id);
+    }
+    if (ev.status == "filled" || ev.status == "partially_filled") {
+        it->second.acked = true;
+    } else {
+        session.orders.erase(it);
+    }
+}
+
+void LoadGenerator::onFill(Session& session, const FillEvent& ev) {
+    if (ev.liquidity != "taker") return;
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(session.mtx);
+    auto it = session.orders.find(ev.client_order_id);
+    if (it == session.orders.end()) return;
+    session.fill.record(nanosBetween(it->second.intended, now));
+    session.orders.erase(it);
+}
+
+void LoadGenerator::onCancelAck(Session& session, const CancelAckEvent& ev) {
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(session.mtx);
+    auto it = session.cancels.find(ev.client_order_id);
+    if (it == session.cancels.end()) return;
+    session.cancel.record(nanosBetween(it->second.intended, now));
+    session.cancels.erase(it);
+    session.outstanding.fetch_sub(1);
+}
+
+void LoadGenerator::onReject(Session& session, const RejectEvent& ev) {
+    std::lock_guard<std::mutex> lock(session.mtx);
+    ++session.rejects;
+    if (session.orders.erase(ev.client_order_id) || session.cancels.erase(ev.client_order_id)) {
+        session.outstanding.fetch_sub(1);
+    }
+}
+
+void LoadGenerator::onTrade(Session& session, const TradeEvent& ev) {
+    std::chrono::system_clock::time_point ts;
+    if (!parseTimestamp(ev.timestamp, ts)) return;
+    auto delay = std::chrono::system_clock::now() - ts;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+    std::lock_guard<std::mutex> lock(session.mtx);
+    session.market_data.record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+}
+
+LatencyHistogram LoadGenerator::merged(LatencyHistogram Session::*member) const {
+    LatencyHistogram result;
+    for (const auto& session : sessions_) {
+        std::lock_guard<std::mutex> lock(session->mtx);
+        result.merge((*session).*member);
+    }
+    return result;
+}
+
+uint64_t LoadGenerator::totalAcks() const {
+    uint64_t total = 0;
+    for (const auto& session : sessions_) {
+        std::lock_guard<std::mutex> lock(session->mtx);
+        total += session->acks;
+    }
+    return total;
+}
+
+void LoadGenerator::printReport(std::ostream& out) const {
+    uint64_t rejects = 0;
+    for (const auto& session : sessions_) rejects += session->rejects;
+    double throughput = elapsed_seconds_ > 0 ? totalAcks() / elapsed_seconds_ : 0.0;
+
+    out << "Load test: " << config_.connections << " connections, target "
+        << config_.rate << " req/s for " << config_.duration_seconds << "s" << std::endl;
+    out << "  sent=" << sent_ << " acks=" << totalAcks() << " rejects=" << rejects
+        << " window_stalls=" << stalled_ << std::endl;
+    out << "  throughput=" << std::fixed << std::setprecision(1) << throughput << " acks/s" << std::endl;
+    out << "  " << merged(&Session::ack).summary("ack") << std::endl;
+    out << "  " << merged(&Session::ack_uncorrected).summary("ack (uncorrected)") << std::endl;
+    out << "  " << merged(&Session::fill).summary("taker fill") << std::endl;
+    out << "  " << merged(&Session::cancel).summary("cancel ack") << std::endl;
+    out << "  " << merged(&Session::market_data).summary("market data") << std::endl;
+    out << "  result: " << (passed_ ? "PASS" : "FAIL") << std::endl;
+}
+
+std::string LoadGenerator::reportJSON() const {
+    auto histogram = [](const LatencyHistogram& h) {
+        return nlohmann::json{
+            {"count", h.count()},
+            {"mean_us", h.mean() / 1000.0},
+            {"p50_us", h.percentile(50) / 1000.0},
+            {"p90_us", h.percentile(90) / 1000.0},
+            {"p99_us", h.percentile(99) / 1000.0},
+            {"p999_us", h.percentile(99.9) / 1000.0},
+            {"max_us", h.max() / 1000.0}
+        };
+    };
+    uint64_t rejects = 0;
+    for (const auto& session : sessions_) rejects += session->rejects;
+
+    nlohmann::json j = {
+        {"connections", config_.connections},
+        {"target_rate", config_.rate},
+        {"duration_seconds", config_.duration_seconds},
+        {"elapsed_seconds", elapsed_seconds_},
+        {"sent", sent_},
+        {"acks", totalAcks()},
+        {"rejects", rejects},
+        {"window_stalls", stalled_},
+        {"throughput", elapsed_seconds_ > 0 ? totalAcks() / elapsed_seconds_ : 0.0},
+        {"passed", passed_},
+        {"latency", {
+            {"ack", histogram(merged(&Session::ack))},
+            {"ack_uncorrected", histogram(merged(&Session::ack_uncorrected))},
+            {"taker_fill", histogram(merged(&Session::fill))},
+            {"cancel_ack", histogram(merged(&Session::cancel))},
+            {"market_data", histogram(merged(&Session::market_data))}
+        }}
+    };
+    return j.dump(2);
+}
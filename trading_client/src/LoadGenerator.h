@@ -0,0 +1,105 @@
+#pragma once
+
+#include "TradingClient.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Headless load generator. Drives a fixed-rate schedule of orders and
+// cancels over several WebSocket sessions, bounded by a per-session window
+// of outstanding requests, and measures ack, fill and market-data latency.
+// Latencies are taken from each request's scheduled send time, so stalls in
+// the client or server show up in the percentiles instead of silently
+// thinning the sample (coordinated omission).
+class LoadGenerator {
+public:
+    struct Config {
+        std::string uri = "ws://localhost:9002";
+        std::string symbol = "BTC-USDT";
+        int connections = 4;
+        double rate = 1000.0;           // requests per second across all sessions
+        int duration_seconds = 10;
+        int max_outstanding = 64;       // per session; a full window stalls the schedule
+        double cancel_ratio = 0.2;
+        double market_ratio = 0.05;
+        double mid_price = 50000.0;
+        double tick_size = 0.5;
+        int price_range_ticks = 20;     // limit prices within +/- this many ticks of mid
+        double quantity = 0.1;
+        uint64_t seed = 1;
+
+        // Qualification thresholds; zero disables a check
+        double min_throughput = 0.0;    // acks per second
+        double max_p99_ack_us = 0.0;
+    };
+
+    explicit LoadGenerator(const Config& config);
+    ~LoadGenerator();
+
+    // Runs the schedule to completion. Returns true if all thresholds were met.
+    bool run();
+
+    void printReport(std::ostream& out) const;
+    std::string reportJSON() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        Clock::time_point intended;
+        Clock::time_point sent;
+        bool acked = false;
+    };
+
+    struct Session : public ClientEventHandler {
+        LoadGenerator* owner = nullptr;
+        int index = 0;
+        std::unique_ptr<TradingClient> client;
+        std::mutex mtx;
+        std::unordered_map<std::string, Pending> orders;   // awaiting ack or first taker fill
+        std::unordered_map<std::string, Pending> cancels;  // keyed by the cancelled order's id
+        std::vector<std::string> resting;                  // acked and eligible for cancel
+        std::atomic<int> outstanding{0};
+        uint64_t next_seq = 0;
+
+        LatencyHistogram ack;
+        LatencyHistogram ack_uncorrected;
+        LatencyHistogram fill;
+        LatencyHistogram cancel;
+        LatencyHistogram market_data;
+        uint64_t acks = 0;
+        uint64_t rejects = 0;
+
+        void onAck(const AckEvent& ev) override { owner->onAck(*this, ev); }
+        void onFill(const FillEvent& ev) override { owner->onFill(*this, ev); }
+        void onCancelAck(const CancelAckEvent& ev) override { owner->onCancelAck(*this, ev); }
+        void onReject(const RejectEvent& ev) override { owner->onReject(*this, ev); }
+        void onTrade(const TradeEvent& ev) override { owner->onTrade(*this, ev); }
+    };
+
+    Config config_;
+    std::vector<std::unique_ptr<Session>> sessions_;
+    std::mt19937_64 rng_;
+    uint64_t interval_ns_;
+    uint64_t sent_ = 0;
+    uint64_t stalled_ = 0;
+    double elapsed_seconds_ = 0.0;
+    bool passed_ = false;
+
+    bool connectAll();
+    void sendNext(Session& session, Clock::time_point intended);
+    void onAck(Session& session, const AckEvent& ev);
+    void onFill(Session& session, const FillEvent& ev);
+    void onCancelAck(Session& session, const CancelAckEvent& ev);
+    void onReject(Session& session, const RejectEvent& ev);
+    void onTrade(Session& session, const TradeEvent& ev);
+    LatencyHistogram merged(LatencyHistogram Session::*member) const;
+    uint64_t totalAcks() const;
+};
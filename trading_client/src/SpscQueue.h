@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Bounded single-producer/single-consumer ring. push/pop are wait free; the
+// consumer can block in waitPop() and is only woken through the condition
+// variable when it has actually gone to sleep, so the fast path never
+// touches the mutex.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool tryPush(T&& value) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == Capacity) return false;
+        }
+        slots_[tail & (Capacity - 1)] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in waitPop
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            cv_.notify_one();
+        }
+        return true;
+    }
+
+    // Spins while the ring is full; the producer is the network thread, so
+    // this pushes back on the socket rather than growing without bound.
+    void push(T value) {
+        while (!tryPush(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    bool tryPop(T& out) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return false;
+        }
+        out = std::move(slots_[head & (Capacity - 1)]);
+        slots_[head & (Capacity - 1)] = T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Spins briefly, then sleeps until an element arrives or the timeout expires
+    bool waitPop(T& out, std::chrono::milliseconds timeout) {
+        for (int i = 0; i < kSpinIterations; ++i) {
+            if (tryPop(out)) return true;
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool got = tryPop(out);
+        if (!got) {
+            cv_.wait_for(lock, timeout, [&]() { return (got = tryPop(out)); });
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+        return got;
+    }
+
+    void wakeAll() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        cv_.notify_all();
+    }
+
+private:
+    static constexpr int kSpinIterations = 256;
+
+    std::array<T, Capacity> slots_{};
+    alignas(64) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_ = 0;  // consumer's view of tail_
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_ = 0;  // producer's view of head_
+    alignas(64) std::atomic<bool> sleeping_{false};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+};
@@ -2,21 +2,27 @@
 #include <iostream>
 #include <sstream>
 
-TradingClient::TradingClient(const std::string& uri)
-    : uri_(uri), connected_(false), running_(false) {
-    setupClient();
+TradingClient::TradingClient(const std::string& uri, DispatchMode mode, LogMode log_mode)
+    : uri_(uri), connected_(false), dispatch_mode_(mode), running_(false) {
+    setupClient(log_mode);
 }
 
 TradingClient::~TradingClient() {
     disconnect();
 }
 
-void TradingClient::setupClient() {
+void TradingClient::setupClient(LogMode log_mode) {
     try {
-        // Set logging to be pretty verbose (everything except message payloads)
-        client_.set_access_channels(websocketpp::log::alevel::all);
-        client_.clear_access_channels(websocketpp::log::alevel::frame_payload);
-        client_.set_error_channels(websocketpp::log::elevel::all);
+        if (log_mode == LogMode::VERBOSE) {
+            // Set logging to be pretty verbose (everything except message payloads)
+            client_.set_access_channels(websocketpp::log::alevel::all);
+            client_.clear_access_channels(websocketpp::log::alevel::frame_payload);
+            client_.set_error_channels(websocketpp::log::elevel::all);
+        } else {
+            client_.clear_access_channels(websocketpp::log::alevel::all);
+            client_.clear_error_channels(websocketpp::log::elevel::all);
+            client_.set_error_channels(websocketpp::log::elevel::rerror | websocketpp::log::elevel::fatal);
+        }
 
         // Initialize ASIO
         client_.init_asio();
@@ -64,7 +70,9 @@ bool TradingClient::connect() {
         client_thread.detach();
 
         // Start message processing thread
-        message_thread_ = std::thread([this]() { processMessageQueue(); });
+        if (dispatch_mode_ == DispatchMode::QUEUED) {
+            message_thread_ = std::thread([this]() { processMessageQueue(); });
+        }
 
         // Wait for connection
         std::unique_lock<std::mutex> lock(mutex_);
@@ -85,6 +93,7 @@ void TradingClient::disconnect() {
 
     try {
         running_ = false;
+        message_queue_.wakeAll();
         if (message_thread_.joinable()) {
             message_thread_.join();
         }
@@ -116,6 +125,10 @@ void TradingClient::setConnectionStatusHandler(ConnectionStatusHandler handler)
     connection_status_handler_ = std::move(handler);
 }
 
+void TradingClient::setEventHandler(ClientEventHandler* handler) {
+    event_handler_ = handler;
+}
+
 void TradingClient::onOpen(ConnectionHandle hdl) {
     connection_ = hdl;
     connected_ = true;
@@ -133,9 +146,11 @@ void TradingClient::onClose(ConnectionHandle hdl) {
 }
 
 void TradingClient::onMessage(ConnectionHandle hdl, MessagePtr msg) {
-    if (message_handler_) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        message_queue_.push(msg->get_payload());
+    if (!message_handler_ && !event_handler_) return;
+    if (dispatch_mode_ == DispatchMode::INLINE) {
+        dispatch(msg);
+    } else {
+        message_queue_.push(std::move(msg));
     }
 }
 
@@ -147,21 +162,26 @@ void TradingClient::onError(ConnectionHandle hdl) {
 }
 
 void TradingClient::processMessageQueue() {
+    MessagePtr msg;
     while (running_) {
-        std::string message;
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (!message_queue_.empty()) {
-                message = message_queue_.front();
-                message_queue_.pop();
-            }
+        if (message_queue_.waitPop(msg, std::chrono::milliseconds(100))) {
+            dispatch(msg);
+            msg.reset();
         }
+    }
+}
 
-        if (!message.empty() && message_handler_) {
-            message_handler_(message);
+void TradingClient::dispatch(const MessagePtr& msg) {
+    const std::string& payload = msg->get_payload();
+    try {
+        if (message_handler_) {
+            message_handler_(payload);
         }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (event_handler_) {
+            dispatchEvent(payload, *event_handler_);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Message handler error: " << e.what() << std::endl;
     }
 }
 
@@ -186,7 +206,8 @@ bool TradingClient::placeOrder(const std::string& symbol,
                              const std::string& orderType,
                              const std::string& side,
                              double quantity,
-                             double price) {
+                             double price,
+                             const std::string& clientOrderId) {
     try {
         nlohmann::json order = {
             {"type", "order"},
@@ -199,6 +220,9 @@ bool TradingClient::placeOrder(const std::string& symbol,
         if (price > 0) {
             order["price"] = price;
         }
+        if (!clientOrderId.empty()) {
+            order["client_order_id"] = clientOrderId;
+        }
 
         sendMessage(order.dump());
         return true;
@@ -208,6 +232,21 @@ bool TradingClient::placeOrder(const std::string& symbol,
     }
 }
 
+bool TradingClient::cancelOrder(const std::string& symbol, const std::string& clientOrderId) {
+    try {
+        nlohmann::json cancel = {
+            {"type", "cancel"},
+            {"symbol", symbol},
+            {"client_order_id", clientOrderId}
+        };
+        sendMessage(cancel.dump());
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error cancelling order: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 bool TradingClient::subscribeToMarketData(const std::string& symbol) {
     try {
         nlohmann::json sub = {
@@ -11,10 +11,11 @@
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <atomic>
 #include <condition_variable>
+#include "ClientEvents.h"
+#include "SpscQueue.h"
 
 class TradingClient {
 public:
@@ -24,7 +25,16 @@ public:
     using ConnectionStatusHandler = std::function<void(bool)>;
     using MessagePtr = WsClient::message_ptr;
 
-    TradingClient(const std::string& uri = "ws://localhost:9002");
+    // INLINE runs handlers on the network thread (lowest latency, handlers
+    // must not block); QUEUED hands messages to a dedicated dispatch thread.
+    enum class DispatchMode { INLINE, QUEUED };
+    // VERBOSE logs every frame header to stdout; ERRORS keeps only transport
+    // errors, for headless runs where logging would sit on the measured path
+    enum class LogMode { VERBOSE, ERRORS };
+
+    TradingClient(const std::string& uri = "ws://localhost:9002",
+                  DispatchMode mode = DispatchMode::QUEUED,
+                  LogMode log_mode = LogMode::VERBOSE);
     ~TradingClient();
 
     // Connection management
@@ -35,13 +45,17 @@ public:
     // Message handlers
     void setMessageHandler(MessageHandler handler);
     void setConnectionStatusHandler(ConnectionStatusHandler handler);
+    // Decoded, typed events; the handler must outlive the connection
+    void setEventHandler(ClientEventHandler* handler);
 
     // Trading operations
     bool placeOrder(const std::string& symbol, 
                    const std::string& orderType,
                    const std::string& side,
                    double quantity,
-                   double price = 0.0);
+                   double price = 0.0,
+                   const std::string& clientOrderId = "");
+    bool cancelOrder(const std::string& symbol, const std::string& clientOrderId);
 
     bool subscribeToMarketData(const std::string& symbol);
     bool unsubscribeFromMarketData(const std::string& symbol);
@@ -58,16 +72,20 @@ private:
     // Message handling
     MessageHandler message_handler_;
     ConnectionStatusHandler connection_status_handler_;
-    std::queue<std::string> message_queue_;
+    ClientEventHandler* event_handler_ = nullptr;
+    DispatchMode dispatch_mode_;
+    // Payloads are handed over as websocketpp message pointers, never copied
+    SpscQueue<MessagePtr, 4096> message_queue_;
     std::thread message_thread_;
     std::atomic<bool> running_;
 
     // Internal methods
-    void setupClient();
+    void setupClient(LogMode log_mode);
     void onOpen(ConnectionHandle hdl);
     void onClose(ConnectionHandle hdl);
     void onMessage(ConnectionHandle hdl, WsClient::message_ptr msg);
     void onError(ConnectionHandle hdl);
     void processMessageQueue();
+    void dispatch(const MessagePtr& msg);
     void sendMessage(const std::string& message);
 }; 
\ No newline at end of file
@@ -1,10 +1,13 @@
 #include "TradingClient.h"
+#include "LoadGenerator.h"
 #include <iostream>
 #include <string>
 #include <thread>
 #include <chrono>
 #include <csignal>
 #include <atomic>
+#include <fstream>
+#include <sstream>
 
 std::atomic<bool> running(true);
 
@@ -34,7 +37,71 @@ void handleConnectionStatus(bool connected) {
     std::cout << "\nConnection status: " << (connected ? "Connected" : "Disconnected") << std::endl;
 }
 
-int main() {
+void printLoadUsage() {
+    std::cout << "Usage: TradingClient --load [options]" << std::endl;
+    std::cout << "  --uri <ws://host:port>     Engine WebSocket endpoint (default ws://localhost:9002)" << std::endl;
+    std::cout << "  --symbol <symbol>          Symbol to trade (default BTC-USDT)" << std::endl;
+    std::cout << "  --connections <n>          Concurrent sessions (default 4)" << std::endl;
+    std::cout << "  --rate <req/s>             Target request rate across sessions (default 1000)" << std::endl;
+    std::cout << "  --duration <seconds>       Run time (default 10)" << std::endl;
+    std::cout << "  --window <n>               Max outstanding requests per session (default 64)" << std::endl;
+    std::cout << "  --cancel-ratio <0..1>      Share of requests that cancel a resting order (default 0.2)" << std::endl;
+    std::cout << "  --market-ratio <0..1>      Share of new orders sent as market orders (default 0.05)" << std::endl;
+    std::cout << "  --seed <n>                 Random seed (default 1)" << std::endl;
+    std::cout << "  --min-throughput <acks/s>  Fail if achieved throughput is below this" << std::endl;
+    std::cout << "  --max-p99-ack-us <us>      Fail if p99 ack latency is above this" << std::endl;
+    std::cout << "  --report <file>            Write the report as JSON" << std::endl;
+}
+
+int runLoad(int argc, char* argv[]) {
+    LoadGenerator::Config config;
+    std::string report_file;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            printLoadUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            printLoadUsage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--uri") config.uri = value;
+        else if (arg == "--symbol") config.symbol = value;
+        else if (arg == "--connections") config.connections = std::stoi(value);
+        else if (arg == "--rate") config.rate = std::stod(value);
+        else if (arg == "--duration") config.duration_seconds = std::stoi(value);
+        else if (arg == "--window") config.max_outstanding = std::stoi(value);
+        else if (arg == "--cancel-ratio") config.cancel_ratio = std::stod(value);
+        else if (arg == "--market-ratio") config.market_ratio = std::stod(value);
+        else if (arg == "--seed") config.seed = std::stoull(value);
+        else if (arg == "--min-throughput") config.min_throughput = std::stod(value);
+        else if (arg == "--max-p99-ack-us") config.max_p99_ack_us = std::stod(value);
+        else if (arg == "--report") report_file = value;
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            printLoadUsage();
+            return 2;
+        }
+    }
+
+    LoadGenerator generator(config);
+    bool passed = generator.run();
+    generator.printReport(std::cout);
+    if (!report_file.empty()) {
+        std::ofstream out(report_file);
+        out << generator.reportJSON() << std::endl;
+    }
+    return passed ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--load") {
+        return runLoad(argc, argv);
+    }
+
     // Set up signal handling
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);